@@ -39,6 +39,7 @@ namespace nyx
         StorageBuffer = 0x00000020,
         Index         = 0x00000040,
         Vertex        = 0x00000080,
+        Indirect      = 0x00000100,
       };
       
       /** Default constructor.
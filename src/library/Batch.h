@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * File:   Batch.h
+ * Author: Jordan Hendl
+ *
+ * Created on October 16, 2026
+ */
+
+#pragma once
+
+#include "Chain.h"
+
+namespace nyx
+{
+  /** Template class for submitting the work of several chains to the device at once.
+   * @note Submitting many chains through a batch costs a single queue submission, instead of one per chain.
+   */
+  template<typename Framework>
+  class Batch
+  {
+    public:
+      /** Default constructor.
+       */
+      Batch() = default ;
+      
+      /** Default deconstructor.
+       */
+      ~Batch() = default ;
+      
+      /** Method to add a chain to this object's next submission.
+       * @param chain The chain to submit with this object. Must outlive the next call to @submit.
+       */
+      inline void add( nyx::Chain<Framework>& chain ) ;
+      
+      /** Method to retrieve the amount of chains in this object's next submission.
+       * @return The amount of chains in this object's next submission.
+       */
+      inline unsigned size() const ;
+      
+      /** Method to submit every added chain's work to the device, then clear this object's chains.
+       */
+      inline void submit() ;
+      
+      /** Method to remove every added chain without submitting them.
+       */
+      inline void clear() ;
+      
+      /** Method to wait on every submission made by this object and release it's data.
+       * @note Chains submitted with this object must be synchronized or reset first.
+       */
+      inline void reset() ;
+      
+    private:
+      typename Framework::Batch impl ;
+  };
+  
+  template<typename Framework>
+  void Batch<Framework>::add( nyx::Chain<Framework>& chain )
+  {
+    this->impl.add( static_cast<typename Framework::Chain&>( chain ) ) ;
+  }
+  
+  template<typename Framework>
+  unsigned Batch<Framework>::size() const
+  {
+    return this->impl.size() ;
+  }
+  
+  template<typename Framework>
+  void Batch<Framework>::submit()
+  {
+    this->impl.submit() ;
+  }
+  
+  template<typename Framework>
+  void Batch<Framework>::clear()
+  {
+    this->impl.clear() ;
+  }
+  
+  template<typename Framework>
+  void Batch<Framework>::reset()
+  {
+    this->impl.reset() ;
+  }
+}
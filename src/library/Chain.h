@@ -27,6 +27,7 @@
 #include "Image.h"
 #include "RenderPass.h"
 #include "Renderer.h"
+#include "Computer.h"
 
 namespace nyx
 {
@@ -67,7 +68,29 @@ namespace nyx
   enum class ChainMode : unsigned 
   {
     Sequential, ///< Chain operates all commands sequentially to all internal command records.
-    All         ///< Chain operates all commands to all internal command buffers at once.
+    All,        ///< Chain operates all commands to all internal command buffers at once.
+    Once        ///< Chain records all commands once into a bundle, which every internal command record executes. Can be submitted repeatedly without re-recording.
+  };
+  
+  /** The parameters of a single draw read by Chain::drawIndirect.
+   */
+  struct DrawIndirectArguments
+  {
+    unsigned vertex_count   ; ///< The amount of vertices to draw.
+    unsigned instance_count ; ///< The amount of instances to draw.
+    unsigned first_vertex   ; ///< The index of the first vertex to draw.
+    unsigned first_instance ; ///< The index of the first instance to draw.
+  };
+  
+  /** The parameters of a single draw read by Chain::drawIndexedIndirect.
+   */
+  struct DrawIndexedIndirectArguments
+  {
+    unsigned index_count    ; ///< The amount of indices to draw.
+    unsigned instance_count ; ///< The amount of instances to draw.
+    unsigned first_index    ; ///< The index of the first index to draw.
+    int      vertex_offset  ; ///< The value added to each index before indexing into the vertex array.
+    unsigned first_instance ; ///< The index of the first instance to draw.
   };
   
   enum class PipelineStage : unsigned ;
@@ -84,6 +107,9 @@ namespace nyx
   template<typename Framework>
   class Renderer ;
 
+  template<typename Framework>
+  class Computer ;
+
   /** Template class for performing and managing GPU operations.
    */
   template<typename Framework>
@@ -149,6 +175,7 @@ namespace nyx
       inline void copy( const nyx::Image<Framework>& src, nyx::Array<Framework, Type>& dst, unsigned amt = 0, unsigned src_offset = 0, unsigned dst_offset = 0 ) ;
       
       /** Method to record a copy from a library array to a host data pointer.
+       * @note The host pointer is written once this chain's submission completes, at the latest by the next synchronize.
        * @param src The array to copy from.
        * @param dst The host data pointer to copy data to.
        * @param amt The amount of data to copy. Defaults to the entire array size.
@@ -177,6 +204,26 @@ namespace nyx
        */
       inline void copy( const nyx::Image<Framework>& src, nyx::Image<Framework>& dst, unsigned amt = 0, unsigned src_offset = 0, unsigned dst_offset = 0 ) ;
       
+      /** Method to record an asynchronous copy from a library array to a host data pointer.
+       * @note The host pointer is written once this chain's submission completes, which the returned object can poll or wait on.
+       * @param src The array to copy from.
+       * @param dst The host data pointer to copy data to. Must stay valid until the readback completes.
+       * @param amt The amount of data to copy. Defaults to the entire array size.
+       * @param src_offset The offset of the source to copy from.
+       * @param dst_offset The offset of the destination to copy to.
+       * @return The implementation-specific object tracking the readback.
+       */
+      template<typename Type>
+      inline typename Framework::Readback readback( const nyx::Array<Framework, Type>& src, Type* dst, unsigned amt = 0, unsigned src_offset = 0, unsigned dst_offset = 0 ) ;
+      
+      /** Method to record an asynchronous copy from a library image to a host data pointer.
+       * @note The host pointer is written once this chain's submission completes, which the returned object can poll or wait on.
+       * @param src The image to copy from.
+       * @param dst The host data pointer to copy data to. Must stay valid until the readback completes.
+       * @return The implementation-specific object tracking the readback.
+       */
+      inline typename Framework::Readback readback( const nyx::Image<Framework>& src, void* dst ) ;
+
       /** Method to retrieve the device used by this object.
        * @return The device id used by this object.
        */
@@ -188,6 +235,12 @@ namespace nyx
        */
       inline void combine( const nyx::Chain<Framework>& child ) ;
       
+      /** Method to execute the child chain's finished recording in this object's current subpass.
+       * Each child can be recorded on its own thread, and children are executed in the order this is called.
+       * @param child The child chain to execute.
+       */
+      inline void execute( const nyx::Chain<Framework>& child ) ;
+      
       /** Method to append a draw command to this renderer.
        * @param array The array of vertices to draw.
        * @param offset The offset into the vertex array to start drawing at.
@@ -216,6 +269,73 @@ namespace nyx
       template<typename Type>
       inline void drawInstanced( unsigned instance_count, const nyx::Renderer<Framework>& renderer, const Array<Framework, Type>& vertices ) ;
 
+      /** Method to append draw commands whose parameters are read from a GPU array to this object.
+       * A single call issues every draw of the arguments array, which can be written on the GPU.
+       * @param renderer The renderer to draw with.
+       * @param vertices The array of vertices used for drawing.
+       * @param arguments The array of draw parameters. Must be created with ArrayFlags::Indirect.
+       * @param draw_count The amount of draws to perform. Defaults to one per element of the arguments array.
+       * @param offset The offset, in elements, of the first draw's parameters in the arguments array.
+       */
+      template<typename Type, typename Arguments = nyx::DrawIndirectArguments>
+      inline void drawIndirect( const nyx::Renderer<Framework>& renderer, const Array<Framework, Type>& vertices, const Array<Framework, Arguments>& arguments, unsigned draw_count = 0, unsigned offset = 0 ) ;
+      
+      /** Method to append indexed draw commands whose parameters are read from a GPU array to this object.
+       * @param renderer The renderer to draw with.
+       * @param indices The index array describing the render order of the vertex array.
+       * @param vertices The array of vertices used for drawing.
+       * @param arguments The array of draw parameters. Must be created with ArrayFlags::Indirect.
+       * @param draw_count The amount of draws to perform. Defaults to one per element of the arguments array.
+       * @param offset The offset, in elements, of the first draw's parameters in the arguments array.
+       */
+      template<typename Type, typename Type2, typename Arguments = nyx::DrawIndexedIndirectArguments>
+      inline void drawIndexedIndirect( const nyx::Renderer<Framework>& renderer, const Array<Framework, Type2>& indices, const Array<Framework, Type>& vertices, const Array<Framework, Arguments>& arguments, unsigned draw_count = 0, unsigned offset = 0 ) ;
+      
+      /** Method to append draw commands whose parameters & amount are read from GPU arrays to this object.
+       * @param renderer The renderer to draw with.
+       * @param vertices The array of vertices used for drawing.
+       * @param arguments The array of draw parameters. Must be created with ArrayFlags::Indirect.
+       * @param count The array whose first element is the amount of draws to perform. Must be created with ArrayFlags::Indirect.
+       * @param max_draws The maximum amount of draws to perform. Defaults to the size of the arguments array.
+       */
+      template<typename Type, typename Arguments = nyx::DrawIndirectArguments>
+      inline void drawIndirectCount( const nyx::Renderer<Framework>& renderer, const Array<Framework, Type>& vertices, const Array<Framework, Arguments>& arguments, const Array<Framework, unsigned>& count, unsigned max_draws = 0 ) ;
+      
+      /** Method to append indexed draw commands whose parameters & amount are read from GPU arrays to this object.
+       * @param renderer The renderer to draw with.
+       * @param indices The index array describing the render order of the vertex array.
+       * @param vertices The array of vertices used for drawing.
+       * @param arguments The array of draw parameters. Must be created with ArrayFlags::Indirect.
+       * @param count The array whose first element is the amount of draws to perform. Must be created with ArrayFlags::Indirect.
+       * @param max_draws The maximum amount of draws to perform. Defaults to the size of the arguments array.
+       */
+      template<typename Type, typename Type2, typename Arguments = nyx::DrawIndexedIndirectArguments>
+      inline void drawIndexedIndirectCount( const nyx::Renderer<Framework>& renderer, const Array<Framework, Type2>& indices, const Array<Framework, Type>& vertices, const Array<Framework, Arguments>& arguments, const Array<Framework, unsigned>& count, unsigned max_draws = 0 ) ;
+      
+      /** Method to append a compute dispatch to this object.
+       * @note Counts are in invocations, and are rounded up to whole workgroups of the computer's shader.
+       * @param computer The computer whose pipeline & bound resources to dispatch.
+       * @param x The amount of invocations along the x axis.
+       * @param y The amount of invocations along the y axis.
+       * @param z The amount of invocations along the z axis.
+       */
+      inline void dispatch( const nyx::Computer<Framework>& computer, unsigned x, unsigned y = 1, unsigned z = 1 ) ;
+      
+      /** Method to append a compute dispatch over every element of an array to this object.
+       * @param computer The computer whose pipeline & bound resources to dispatch.
+       * @param array The array whose size is the amount of invocations to dispatch.
+       */
+      template<typename Type>
+      inline void dispatch( const nyx::Computer<Framework>& computer, const Array<Framework, Type>& array ) ;
+      
+      /** Method to append a compute dispatch whose workgroup counts are read from a GPU array to this object.
+       * @param computer The computer whose pipeline & bound resources to dispatch.
+       * @param arguments The array containing the x, y & z workgroup counts.
+       * @param offset The offset, in elements, of the counts in the array.
+       */
+      template<typename Type>
+      inline void dispatchIndirect( const nyx::Computer<Framework>& computer, const Array<Framework, Type>& arguments, unsigned offset = 0 ) ;
+
       /** Method to explicitly end recording of this object.
        * @note The submit method implicitly ends this chain's record as well.
        */
@@ -234,6 +354,7 @@ namespace nyx
       inline void initialize( const nyx::Chain<Framework>& parent, unsigned subpass_id = 0 ) ;
 
       /** Method to initialize this object with the given parameters.
+       * @note Transfer chains hand ownership of the arrays & images they write to the graphics queue, which is acquired on that queue's next submit.
        * @param gpu The ID of gpu to use.
        * @param type The type of queue to use for this chain.
        */
@@ -270,15 +391,93 @@ namespace nyx
       template<typename Type>
       inline void push( const nyx::Renderer<Framework>& pipeline, const Type& data, unsigned offset = 0 ) ;
       
+      /** Method to push a variable onto the input compute pipeline.
+       * @param computer The computer to push the data to.
+       * @param data The data to push.
+       * @param offset The offset, in bytes, to update the data in the pipeline. Defaults to 0.
+       */
+      template<typename Type>
+      inline void push( const nyx::Computer<Framework>& computer, const Type& data, unsigned offset = 0 ) ;
+      
+      /** Method to set the viewport all following draws of this chain render to.
+       * @note Viewports are dynamic state, so changing them never rebuilds a pipeline. Lasts until this chain is reset.
+       * @param viewport The viewport to render to.
+       */
+      inline void setViewport( const nyx::Viewport& viewport ) ;
+      
+      /** Method to set the scissor all following draws of this chain render with.
+       * @note Defaults to the area of the viewport set by setViewport(). Lasts until this chain is reset.
+       * @param x The x offset of the scissor, in pixels.
+       * @param y The y offset of the scissor, in pixels.
+       * @param width The width of the scissor, in pixels.
+       * @param height The height of the scissor, in pixels.
+       */
+      inline void setScissor( int x, int y, unsigned width, unsigned height ) ;
+      
+      /** Method to make this object's next submission wait on the GPU for another chain's submission to complete.
+       * Lets dependent work on different queues overlap without synchronizing on the host.
+       * @param chain The chain to wait on. Must have been submitted.
+       * @param value The signal value of the other chain's submission to wait on. Defaults to it's latest submission.
+       */
+      inline void waitOn( const nyx::Chain<Framework>& chain, unsigned long long value = 0 ) ;
+      
+      /** Method to retrieve the value this object's timeline is signaled with once it's latest submission completes.
+       * @return The signal value of this object's latest submission, or 0 if it was never submitted.
+       */
+      inline unsigned long long signalValue() const ;
+      
       /** Method to set the mode of this chain.
        * @param mode The mode of this chain to operate on.
        */
       inline void setMode( nyx::ChainMode mode ) ;
+      
+      /** Method to set how many frames of this chain's work may be in flight at once.
+       * @note Takes effect the next time this object is initialized.
+       * @param count The number of frames this object may have in flight.
+       */
+      inline void setFramesInFlight( unsigned count ) ;
+      
+      /** Method to set which type of chain uses what this chain transfers next, so ownership of it is handed to that chain's queue.
+       * @note Only affects transfer chains, and takes effect the next time this object is initialized.
+       * @param type The type of chain that uses this chain's transfers next.
+       */
+      inline void setTarget( nyx::ChainType type ) ;
+      
+      /** Method to retrieve how many frames of this chain's work may be in flight at once.
+       * @return The number of frames this object may have in flight.
+       */
+      inline unsigned framesInFlight() const ;
+      
+      /** Method to retrieve how long the host has blocked waiting to reuse this object's frames.
+       * @return The accumulated wait time, in milliseconds.
+       */
+      inline float waitTime() const ;
 
-      /** Method to synchronize this object's operations with the device.
+      /** Method to wait on the host for this object's submitted operations to complete.
+       * @note Only this object's own submissions are waited on, so chains sharing a queue don't block each other.
        */
       inline void synchronize() ;
       
+      /** Method to poll whether this object's submitted operations have completed, without blocking.
+       * @return Whether or not every operation this object submitted has completed.
+       */
+      inline bool isComplete() const ;
+      
+      /** Method to start timing this object's subsequent GPU work.
+       * @param name The name to retrieve the timer's result by.
+       */
+      inline void beginTimer( const char* name ) ;
+      
+      /** Method to stop the most recently started timer.
+       */
+      inline void endTimer() ;
+      
+      /** Method to retrieve how long a timer last took on the GPU.
+       * @param name The name of the timer.
+       * @return The duration of the timer's latest resolved measurement in milliseconds, or 0 if none is resolved yet.
+       */
+      inline float timer( const char* name ) const ;
+      
       /** Method to submit this object's work to the device.
        */
       inline void submit() ;
@@ -383,12 +582,32 @@ namespace nyx
     this->impl.copy( src, dst, amt, src_offset, dst_offset ) ;
   }
 
+  template<typename Framework>
+  template<typename Type>
+  typename Framework::Readback Chain<Framework>::readback( const nyx::Array<Framework, Type>& src, Type* dst, unsigned amt, unsigned src_offset, unsigned dst_offset )
+  {
+    if( amt == 0 ) amt = src.size() ;
+    return this->impl.readback( src, dst, amt, src_offset, dst_offset ) ;
+  }
+  
+  template<typename Framework>
+  typename Framework::Readback Chain<Framework>::readback( const nyx::Image<Framework>& src, void* dst )
+  {
+    return this->impl.readback( src, dst ) ;
+  }
+
   template<typename Framework>
   void Chain<Framework>::combine( const nyx::Chain<Framework>& child )
   {
     this->impl.combine( child ) ;
   }
   
+  template<typename Framework>
+  void Chain<Framework>::execute( const nyx::Chain<Framework>& child )
+  {
+    this->impl.execute( child ) ;
+  }
+  
   template<typename Framework>
   template<typename Type, typename Type2>
   void Chain<Framework>::drawIndexed( const nyx::Renderer<Framework>& renderer, const Array<Framework, Type2>& indices, const Array<Framework, Type>& vertices )
@@ -417,6 +636,54 @@ namespace nyx
     this->impl.draw( renderer, array, offset ) ;
   }
   
+  template<typename Framework>
+  template<typename Type, typename Arguments>
+  void Chain<Framework>::drawIndirect( const nyx::Renderer<Framework>& renderer, const Array<Framework, Type>& vertices, const Array<Framework, Arguments>& arguments, unsigned draw_count, unsigned offset )
+  {
+    this->impl.drawIndirect( renderer, vertices, arguments, draw_count, offset ) ;
+  }
+  
+  template<typename Framework>
+  template<typename Type, typename Type2, typename Arguments>
+  void Chain<Framework>::drawIndexedIndirect( const nyx::Renderer<Framework>& renderer, const Array<Framework, Type2>& indices, const Array<Framework, Type>& vertices, const Array<Framework, Arguments>& arguments, unsigned draw_count, unsigned offset )
+  {
+    this->impl.drawIndexedIndirect( renderer, indices, vertices, arguments, draw_count, offset ) ;
+  }
+  
+  template<typename Framework>
+  template<typename Type, typename Arguments>
+  void Chain<Framework>::drawIndirectCount( const nyx::Renderer<Framework>& renderer, const Array<Framework, Type>& vertices, const Array<Framework, Arguments>& arguments, const Array<Framework, unsigned>& count, unsigned max_draws )
+  {
+    this->impl.drawIndirectCount( renderer, vertices, arguments, count, max_draws ) ;
+  }
+  
+  template<typename Framework>
+  template<typename Type, typename Type2, typename Arguments>
+  void Chain<Framework>::drawIndexedIndirectCount( const nyx::Renderer<Framework>& renderer, const Array<Framework, Type2>& indices, const Array<Framework, Type>& vertices, const Array<Framework, Arguments>& arguments, const Array<Framework, unsigned>& count, unsigned max_draws )
+  {
+    this->impl.drawIndexedIndirectCount( renderer, indices, vertices, arguments, count, max_draws ) ;
+  }
+  
+  template<typename Framework>
+  void Chain<Framework>::dispatch( const nyx::Computer<Framework>& computer, unsigned x, unsigned y, unsigned z )
+  {
+    this->impl.dispatch( computer, x, y, z ) ;
+  }
+  
+  template<typename Framework>
+  template<typename Type>
+  void Chain<Framework>::dispatch( const nyx::Computer<Framework>& computer, const Array<Framework, Type>& array )
+  {
+    this->impl.dispatch( computer, array ) ;
+  }
+  
+  template<typename Framework>
+  template<typename Type>
+  void Chain<Framework>::dispatchIndirect( const nyx::Computer<Framework>& computer, const Array<Framework, Type>& arguments, unsigned offset )
+  {
+    this->impl.dispatchIndirect( computer, arguments, offset ) ;
+  }
+  
   template<typename Framework>
   void Chain<Framework>::end()
   {
@@ -447,6 +714,30 @@ namespace nyx
     this->impl.setMode( mode ) ;
   }
 
+  template<typename Framework>
+  void Chain<Framework>::setFramesInFlight( unsigned count )
+  {
+    this->impl.setFramesInFlight( count ) ;
+  }
+
+  template<typename Framework>
+  void Chain<Framework>::setTarget( nyx::ChainType type )
+  {
+    this->impl.setTarget( type ) ;
+  }
+
+  template<typename Framework>
+  unsigned Chain<Framework>::framesInFlight() const
+  {
+    return this->impl.framesInFlight() ;
+  }
+
+  template<typename Framework>
+  float Chain<Framework>::waitTime() const
+  {
+    return this->impl.waitTime() ;
+  }
+
   template<typename Framework>
   bool Chain<Framework>::initialized() const
   {
@@ -509,7 +800,62 @@ namespace nyx
   {
     this->impl.push( pipeline, data, offset ) ;
   }
+  
+  template<typename Framework>
+  template<typename Type>
+  void Chain<Framework>::push( const nyx::Computer<Framework>& computer, const Type& data, unsigned offset )
+  {
+    this->impl.push( computer, data, offset ) ;
+  }
+
+  template<typename Framework>
+  void Chain<Framework>::setViewport( const nyx::Viewport& viewport )
+  {
+    this->impl.setViewport( viewport ) ;
+  }
+
+  template<typename Framework>
+  void Chain<Framework>::setScissor( int x, int y, unsigned width, unsigned height )
+  {
+    this->impl.setScissor( x, y, width, height ) ;
+  }
+
+  template<typename Framework>
+  void Chain<Framework>::waitOn( const nyx::Chain<Framework>& chain, unsigned long long value )
+  {
+    this->impl.waitOn( chain, value ) ;
+  }
+  
+  template<typename Framework>
+  bool Chain<Framework>::isComplete() const
+  {
+    return this->impl.isComplete() ;
+  }
 
+  template<typename Framework>
+  void Chain<Framework>::beginTimer( const char* name )
+  {
+    this->impl.beginTimer( name ) ;
+  }
+
+  template<typename Framework>
+  void Chain<Framework>::endTimer()
+  {
+    this->impl.endTimer() ;
+  }
+
+  template<typename Framework>
+  float Chain<Framework>::timer( const char* name ) const
+  {
+    return this->impl.timer( name ) ;
+  }
+  
+  template<typename Framework>
+  unsigned long long Chain<Framework>::signalValue() const
+  {
+    return this->impl.signalValue() ;
+  }
+  
   template<typename Framework>
   void Chain<Framework>::reset()
   {
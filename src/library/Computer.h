@@ -28,22 +28,119 @@
 namespace nyx
 {
   template<typename Framework>
+  class Image ;
+
+  /** Template class for managing a compute pipeline & the resources bound to it.
+   * @note Dispatched by recording it into a nyx::Chain.
+   */
+  template<typename Framework>
   class Computer
   {
     public:
-      Computer() ;
-      void initialize( const char* nyx_file_path ) ;
-      void initialize( const unsigned char* nyx_file_bytes ) ;
-      void dispatch() ;
+      /** Default constructor.
+       */
+      Computer() = default ;
+      
+      /** Default deconstructor.
+       */
+      ~Computer() = default ;
+      
+      /** Method to convert this object to the underlying implementation-specific version.
+       * @return The implementation-specific version of this object.
+       */
       operator const typename Framework::Computer&() const ;
+
+      /** Method to initialize this object.
+       * @param device The device to use for all GPU operations.
+       * @param nyx_file_path The path to the .nyx file on the filesystem to use.
+       */
+      void initialize( unsigned device, const char* nyx_file_path ) ;
+      
+      /** Method to initialize this object.
+       * @param device The device to use for all GPU operations.
+       * @param nyx_file_bytes The bytes of the .nyx file to use for this object.
+       * @param size The size of the bytes array.
+       */
+      void initialize( unsigned device, const unsigned char* nyx_file_bytes, unsigned size ) ;
+      
+      /** Method to check whether this object is initialized or not.
+       * @return Whether or not this object is initialized.
+       */
+      bool initialized() const ;
+      
+      /** Method to bind an array to one of this object's values on the GPU.
+       * @param name The name associated with the value in the inputted pipeline.
+       * @param array The GPU array to bind to the pipeline variable.
+       */
       template<typename Type>
       void bind( const char* name, const nyx::Array<Framework, Type>& array ) ;
-      template<typename Type>
-      void push( const Type& value ) ;
-
+      
+      /** Method to bind an image to one of this object's values on the GPU.
+       * @param name The name associated with the value in the inputted pipeline.
+       * @param image The GPU image to bind to the pipeline variable.
+       */
+      void bind( const char* name, const nyx::Image<Framework>& image ) ;
+      
+      /** Method to retrieve the device used by this computer.
+       * @return The device used for this computer.
+       */
+      unsigned device() const ;
+      
+      /** Method to reset this object and deallocate all allocated data.
+       */
       void reset() ;
+      
     private:
       typename Framework::Computer impl ;
   };
+  
+  template<typename Framework>
+  Computer<Framework>::operator const typename Framework::Computer&() const
+  {
+    return this->impl ;
+  }
+  
+  template<typename Framework>
+  void Computer<Framework>::initialize( unsigned device, const char* nyx_file_path )
+  {
+    this->impl.initialize( device, nyx_file_path ) ;
+  }
+  
+  template<typename Framework>
+  void Computer<Framework>::initialize( unsigned device, const unsigned char* nyx_file_bytes, unsigned size )
+  {
+    this->impl.initialize( device, nyx_file_bytes, size ) ;
+  }
+  
+  template<typename Framework>
+  bool Computer<Framework>::initialized() const
+  {
+    return this->impl.initialized() ;
+  }
+  
+  template<typename Framework>
+  template<typename Type>
+  void Computer<Framework>::bind( const char* name, const nyx::Array<Framework, Type>& array )
+  {
+    this->impl.bind( name, array ) ;
+  }
+  
+  template<typename Framework>
+  void Computer<Framework>::bind( const char* name, const nyx::Image<Framework>& image )
+  {
+    this->impl.bind( name, image ) ;
+  }
+  
+  template<typename Framework>
+  unsigned Computer<Framework>::device() const
+  {
+    return this->impl.device() ;
+  }
+  
+  template<typename Framework>
+  void Computer<Framework>::reset()
+  {
+    this->impl.reset() ;
+  }
 }
 
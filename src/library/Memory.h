@@ -174,6 +174,26 @@ namespace nyx
        * @param host_alloc Flag whether or not to allocate a copy of the date on the host ( CPU-side ).
        */      
       void initialize( unsigned gpu, unsigned sz, unsigned filter, bool host_alloc = true ) ;
+      
+      /** Method to initialize this memory object with the input parameters.
+       * @param sz The size in bytes to store in this object.
+       * @param gpu The implementation-specific GPU to use for all gpu operations.
+       * @param filter The implementation-specific filter of memory types allowed.
+       * @param alignment The alignment in bytes the memory must start at.
+       * @param mem_flags The implementation-specific memory flags. OR'd together to get the flags to use.
+       * @param host_alloc Flag whether or not to allocate a copy of the date on the host ( CPU-side ).
+       */
+      template<typename ... MEMORY_FLAGS>
+      void initialize( unsigned gpu, unsigned sz, unsigned filter, unsigned alignment, bool host_alloc, MEMORY_FLAGS... mem_flags ) ;
+      
+      /** Method to initialize this memory object with the input parameters.
+       * @param sz The size in bytes to store in this object.
+       * @param gpu The implementation-specific GPU to use for all gpu operations.
+       * @param filter The implementation-specific filter of memory types allowed.
+       * @param alignment The alignment in bytes the memory must start at.
+       * @param host_alloc Flag whether or not to allocate a copy of the date on the host ( CPU-side ).
+       */
+      void initialize( unsigned gpu, unsigned sz, unsigned filter, unsigned alignment, bool host_alloc ) ;
         
       /** Method to retrieve the host buffer of this object's data.
        * @return The host-buffer containing this object's data.
@@ -399,7 +419,7 @@ namespace nyx
     this->byte_size  = sz  ;
     this->gpu        = gpu ;
     
-    this->memory_ptr = impl.createMemory( gpu, sz, ::nyx::combine( mem_flags... ), filter ) ;
+    this->memory_ptr = impl.createMemory( gpu, sz, static_cast<nyx::MemoryFlags>( ::nyx::combine( mem_flags... ) ), filter ) ;
     
     if( host_alloc )
     {
@@ -421,6 +441,35 @@ namespace nyx
     }
   }
 
+  template<typename Framework>
+  template< typename ... MEMORY_FLAGS>
+  void Memory<Framework>::initialize( unsigned gpu, unsigned sz, unsigned filter, unsigned alignment, bool host_alloc, MEMORY_FLAGS... mem_flags ) 
+  {
+    this->byte_size  = sz  ;
+    this->gpu        = gpu ;
+    
+    this->memory_ptr = impl.createMemory( gpu, sz, static_cast<nyx::MemoryFlags>( ::nyx::combine( mem_flags... ) ), filter, alignment ) ;
+    
+    if( host_alloc )
+    {
+      this->data = new unsigned char[ sz ] ;
+    }
+  }
+
+  template<typename Framework>
+  void Memory<Framework>::initialize( unsigned gpu, unsigned sz, unsigned filter, unsigned alignment, bool host_alloc ) 
+  {
+    this->byte_size  = sz  ;
+    this->gpu        = gpu ;
+    
+    this->memory_ptr = impl.createMemory( gpu, sz, filter, alignment ) ;
+    
+    if( host_alloc )
+    {
+      this->data = new unsigned char[ sz ] ;
+    }
+  }
+
   template<typename Framework>
   void Memory<Framework>::copy( const Memory<Framework>& src, unsigned amt_to_copy, unsigned srcoffset, unsigned dstoffset )
   {
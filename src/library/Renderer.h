@@ -162,6 +162,17 @@ namespace nyx
        */
       void addViewport( const Viewport& viewport ) ;
       
+      /** Method to set whether this renderer's pipeline is compiled on a worker pool instead of the calling thread.
+       * Initializing then returns immediately, and the first draw blocks if the pipeline is not done yet.
+       * @param value Whether or not to compile this renderer's pipeline asynchronously.
+       */
+      void setAsync( bool value ) ;
+      
+      /** Method to check whether this renderer's pipeline is done compiling.
+       * @return Whether or not this renderer can be drawn with without blocking.
+       */
+      bool ready() const ;
+      
       /** Method to bind an array to one of this object's values on the GPU.
        * @param name The name associated with the value in the inputted pipeline.
        * @param array The GPU array to bind to the pipeline variable.
@@ -236,6 +247,18 @@ namespace nyx
     this->impl.addViewport( viewport ) ;
   }
 
+  template<typename Framework>
+  void Renderer<Framework>::setAsync( bool value )
+  {
+    this->impl.setAsync( value ) ;
+  }
+
+  template<typename Framework>
+  bool Renderer<Framework>::ready() const
+  {
+    return this->impl.ready() ;
+  }
+
   template<typename Framework>
   template<typename Type>
   void Renderer<Framework>::bind( const char* name, const Array<Framework, Type>& array )
@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * File:   Trace.cpp
+ * Author: Jordan Hendl
+ * 
+ * Created on October 16, 2026
+ */
+
+#include "Trace.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace nyx
+{
+  /** The most spans each thread keeps. Spans past this are dropped until the trace is cleared.
+   */
+  static constexpr unsigned SPANS_PER_THREAD = 65536 ;
+  
+  /** Structure describing a recorded span.
+   */
+  struct TraceSpan
+  {
+    const char*        name  ; ///< The name of the span.
+    unsigned long long start ; ///< The time the span started, in nanoseconds.
+    unsigned long long end   ; ///< The time the span ended, in nanoseconds.
+  };
+  
+  /** Structure to hold the spans of a single thread.
+   * @note Only it's thread writes to it, publishing each span through the count, so dumps never block recording.
+   * @note Clearing only advances the global epoch. The owning thread resets the count once it sees the new epoch, so spans are never rewritten while they may be dumped.
+   */
+  struct TraceBuffer
+  {
+    std::vector<TraceSpan> spans  ;
+    std::atomic<unsigned>  count  ;
+    std::atomic<unsigned>  epoch  ; ///< The epoch the recorded spans belong to.
+    unsigned               thread ;
+    
+    /** Constructor.
+     * @param thread The id to write this buffer's spans with.
+     */
+    TraceBuffer( unsigned thread ) ;
+  };
+  
+  using TraceBuffers = std::vector<std::shared_ptr<TraceBuffer>> ;
+  
+  static std::atomic<bool>     trace_enabled( false ) ;
+  static std::atomic<unsigned> trace_epoch  ( 0     ) ;
+  static unsigned              trace_threads = 0      ;
+  static TraceBuffers          trace_buffers          ;
+  static std::mutex            trace_mutex            ;
+  
+  /** Function to retrieve the amount of spans of a buffer in the current epoch.
+   * @note Must be called with the trace mutex locked, so the epoch can't advance.
+   * @param buffer The buffer to count the spans of.
+   * @return The amount of spans that are safe to read.
+   */
+  static unsigned currentCount( const TraceBuffer& buffer )
+  {
+    // The count is reset before the epoch is published, so a matching epoch means the count is current.
+    if( buffer.epoch.load( std::memory_order_acquire ) != trace_epoch.load( std::memory_order_relaxed ) ) return 0 ;
+    
+    return buffer.count.load( std::memory_order_acquire ) ;
+  }
+  
+  /** Function to release the buffers of threads that have exited & have no spans left to dump.
+   * @note Must be called with the trace mutex locked.
+   */
+  static void releaseExited()
+  {
+    auto iter = trace_buffers.begin() ;
+    
+    while( iter != trace_buffers.end() )
+    {
+      // Only the registry holds the buffer once it's thread_local is destroyed.
+      if( iter->use_count() == 1 && currentCount( **iter ) == 0 ) iter = trace_buffers.erase( iter ) ;
+      else                                                        ++iter                            ;
+    }
+  }
+  
+  /** Function to retrieve the calling thread's buffer, registering it on first use.
+   * @return Reference to the calling thread's buffer.
+   */
+  static TraceBuffer& localBuffer()
+  {
+    // Shared with the registry, so the spans outlive the thread for dumps.
+    static thread_local std::shared_ptr<TraceBuffer> buffer ;
+    
+    if( !buffer )
+    {
+      std::lock_guard<std::mutex> lock( trace_mutex ) ;
+      
+      releaseExited() ;
+      buffer = std::make_shared<TraceBuffer>( trace_threads++ ) ;
+      trace_buffers.push_back( buffer ) ;
+    }
+    
+    return *buffer ;
+  }
+  
+  TraceBuffer::TraceBuffer( unsigned thread )
+  {
+    this->spans.resize( SPANS_PER_THREAD ) ;
+    this->count  = 0                                            ;
+    this->epoch  = trace_epoch.load( std::memory_order_relaxed ) ;
+    this->thread = thread                                       ;
+  }
+  
+  void Trace::setEnabled( bool value )
+  {
+    trace_enabled.store( value, std::memory_order_relaxed ) ;
+  }
+  
+  bool Trace::enabled()
+  {
+    return trace_enabled.load( std::memory_order_relaxed ) ;
+  }
+  
+  unsigned long long Trace::now()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count() ;
+  }
+  
+  void Trace::record( const char* name, unsigned long long start, unsigned long long end )
+  {
+    TraceBuffer&   buffer = localBuffer()                                  ;
+    const unsigned epoch  = trace_epoch.load( std::memory_order_acquire ) ;
+    unsigned       index  ;
+    
+    if( buffer.epoch.load( std::memory_order_relaxed ) != epoch )
+    {
+      buffer.count.store( 0    , std::memory_order_relaxed ) ;
+      buffer.epoch.store( epoch, std::memory_order_release ) ;
+    }
+    
+    index = buffer.count.load( std::memory_order_relaxed ) ;
+    if( index >= buffer.spans.size() ) return ;
+    
+    buffer.spans[ index ] = { name, start, end } ;
+    buffer.count.store( index + 1, std::memory_order_release ) ;
+  }
+  
+  bool Trace::dump( const char* path )
+  {
+    std::ofstream stream( path ) ;
+    bool          first          ;
+    
+    if( !stream ) return false ;
+    
+    std::lock_guard<std::mutex> lock( trace_mutex ) ;
+    
+    first = true ;
+    stream << std::fixed << std::setprecision( 3 ) << "{\"traceEvents\":[" ;
+    for( const auto& buffer : trace_buffers )
+    {
+      const unsigned count = currentCount( *buffer ) ;
+      
+      for( unsigned index = 0; index < count; index++ )
+      {
+        const TraceSpan& span = buffer->spans[ index ] ;
+        
+        if( !first ) stream << "," ;
+        first = false ;
+        
+        // Chrome expects microseconds.
+        stream << "\n{\"name\":\""  << span.name 
+               << "\",\"cat\":\"nyx\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->thread 
+               << ",\"ts\":"  << static_cast<double>( span.start              ) / 1000.0 
+               << ",\"dur\":" << static_cast<double>( span.end - span.start ) / 1000.0 << "}" ;
+      }
+    }
+    stream << "\n]}\n" ;
+    
+    return static_cast<bool>( stream ) ;
+  }
+  
+  void Trace::clear()
+  {
+    std::lock_guard<std::mutex> lock( trace_mutex ) ;
+    
+    // Only the owning threads write their counts, so they reset them on their next span.
+    trace_epoch.fetch_add( 1, std::memory_order_release ) ;
+    releaseExited() ;
+  }
+  
+  unsigned Trace::size()
+  {
+    unsigned count = 0 ;
+    
+    std::lock_guard<std::mutex> lock( trace_mutex ) ;
+    
+    for( const auto& buffer : trace_buffers ) count += currentCount( *buffer ) ;
+    
+    return count ;
+  }
+  
+  TraceScope::TraceScope( const char* name )
+  {
+    this->name  = Trace::enabled() ? name : nullptr ;
+    this->start = this->name != nullptr ? Trace::now() : 0 ;
+  }
+  
+  TraceScope::~TraceScope()
+  {
+    if( this->name != nullptr ) Trace::record( this->name, this->start, Trace::now() ) ;
+  }
+}
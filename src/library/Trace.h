@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * File:   Trace.h
+ * Author: Jordan Hendl
+ *
+ * Created on October 16, 2026
+ */
+
+#pragma once
+
+namespace nyx
+{
+  /** Static class to record the CPU time spent in the library's expensive operations.
+   * @note Spans are recorded into per-thread buffers without locking, and dumped in the Chrome trace event format.
+   */
+  class Trace
+  {
+    public:
+      
+      /** Method to set whether or not spans are recorded. Disabled by default.
+       * @param value Whether or not spans should be recorded.
+       */
+      static void setEnabled( bool value ) ;
+      
+      /** Method to retrieve whether or not spans are recorded.
+       * @return Whether or not spans are recorded.
+       */
+      static bool enabled() ;
+      
+      /** Method to retrieve the current time on the clock spans are recorded with.
+       * @return The current time in nanoseconds.
+       */
+      static unsigned long long now() ;
+      
+      /** Method to record a span on the calling thread.
+       * @param name The name of the span. Must outlive every dump, so string literals are expected.
+       * @param start The time the span started, from @now.
+       * @param end The time the span ended, from @now.
+       */
+      static void record( const char* name, unsigned long long start, unsigned long long end ) ;
+      
+      /** Method to write every recorded span to a Chrome trace JSON file.
+       * @note Safe to call while other threads record spans. Spans recorded during the dump may be left out.
+       * @param path The path of the file to write.
+       * @return Whether or not the file was written.
+       */
+      static bool dump( const char* path ) ;
+      
+      /** Method to discard every recorded span, and release the buffers of threads that have exited.
+       * @note Safe to call while other threads record spans. Spans recorded during the clear may be discarded too.
+       */
+      static void clear() ;
+      
+      /** Method to retrieve the amount of spans recorded so far, across all threads.
+       * @return The amount of recorded spans.
+       */
+      static unsigned size() ;
+  };
+  
+  /** Class to record a span for the lifetime of a scope.
+   */
+  class TraceScope
+  {
+    public:
+      
+      /** Constructor. Starts the span if tracing is enabled.
+       * @param name The name of the span. Must outlive every dump, so string literals are expected.
+       */
+      explicit TraceScope( const char* name ) ;
+      
+      /** Deconstructor. Records the span.
+       */
+      ~TraceScope() ;
+      
+    private:
+      const char*        name  ;
+      unsigned long long start ;
+  };
+}
@@ -16,6 +16,7 @@
  */
 
 #include "NggFile.h"
+#include <library/Trace.h>
 #include <string>
 #include <sstream>
 #include <fstream>
@@ -204,6 +205,8 @@ namespace nyx
 
   bool NggFile::load( const unsigned char* bytes, unsigned size )
   {
+    nyx::TraceScope trace( "NggFile::load" ) ;
+    
     std::stringstream  stream    ;
     unsigned long long magic     ;
     
@@ -16,6 +16,7 @@
  */
 
 #include "NgtFile.h"
+#include <library/Trace.h>
 #include <string>
 #include <sstream>
 #include <fstream>
@@ -115,6 +116,8 @@ namespace nyx
 
   bool NgtFile::load( const unsigned char* bytes, unsigned size )
   {
+    nyx::TraceScope trace( "NgtFile::load" ) ;
+    
     std::stringstream  stream    ;
     unsigned long long magic     ;
     unsigned char*     img_bytes ;
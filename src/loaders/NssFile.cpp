@@ -16,6 +16,7 @@
  */
 
 #include "NssFile.h"
+#include <library/Trace.h>
 #include <string>
 #include <sstream>
 #include <fstream>
@@ -458,6 +459,8 @@ namespace nyx
 
   bool NssFile::load( const unsigned char* bytes, unsigned size )
   {
+    nyx::TraceScope trace( "NssFile::load" ) ;
+    
     std::stringstream  stream    ;
     unsigned long long magic     ;
     
@@ -16,6 +16,7 @@
  */
 
 #include "NttFile.h"
+#include <library/Trace.h>
 #include <string>
 #include <sstream>
 #include <fstream>
@@ -176,6 +177,8 @@ namespace nyx
 
   bool NttFile::load( const unsigned char* bytes, unsigned size )
   {
+    nyx::TraceScope trace( "NttFile::load" ) ;
+    
     std::stringstream  stream    ;
     unsigned long long magic     ;
     
@@ -17,6 +17,7 @@
 
 
 #include "NyxFile.h"
+#include <library/Trace.h>
 #include <string>
 #include <sstream>
 #include <fstream>
@@ -319,6 +320,8 @@ namespace nyx
   
   void NyxFile::load( const unsigned char* bytes, unsigned size )
   {
+    nyx::TraceScope trace( "NyxFile::load" ) ;
+    
     std::stringstream          stream      ;
     unsigned                   num_shaders ;
     unsigned                   num_inputs  ;
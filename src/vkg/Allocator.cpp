@@ -0,0 +1,608 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * File:   Allocator.cpp
+ * Author: Jordan Hendl
+ * 
+ * Created on April 3, 2021, 11:02 AM
+ */
+
+#define VULKAN_HPP_NO_EXCEPTIONS
+#define VULKAN_HPP_ASSERT_ON_RESULT
+#define VULKAN_HPP_NOEXCEPT
+#define VULKAN_HPP_NOEXCEPT_WHEN_NO_EXCEPTIONS
+#define VULKAN_HPP_DISPATCH_LOADER_DYNAMIC 1
+
+#include "Allocator.h"
+#include "Vulkan.h"
+#include "Device.h"
+#include <vulkan/vulkan.hpp>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <mutex>
+#include <map>
+#include <set>
+
+namespace nyx
+{
+  namespace vkg
+  {
+    /** The default size in bytes of each block allocated from the device.
+     */
+    static constexpr unsigned long long DEFAULT_BLOCK_SIZE = 64ull * 1024ull * 1024ull ;
+    
+    /** The smallest size in bytes handed out by a heap block.
+     */
+    static constexpr unsigned long long MIN_LEAF_SIZE = 256 ;
+    
+    /** The fraction of a memory heap a single block is allowed to take up.
+     */
+    static constexpr unsigned long long HEAP_BLOCK_DIVISOR = 8 ;
+
+    /** Static function to round a value up to the next power of two.
+     * @param value The value to round.
+     * @return The smallest power of two greater than or equal to the input.
+     */
+    static unsigned long long powerOfTwo( unsigned long long value ) ;
+
+    /** Structure to describe a single block of device memory, split up using a buddy system.
+     */
+    struct HeapBlock
+    {
+      typedef std::set<unsigned long long>           FreeList    ;
+      typedef std::map<unsigned long long, unsigned> Allocations ;
+
+      vk::DeviceMemory      memory      ; ///< The device memory of this block.
+      unsigned char*        mapped      ; ///< The persistent host mapping of this block, if host visible.
+      bool                  coherent    ; ///< Whether this block's memory is host coherent.
+      unsigned              type        ; ///< The memory type index this block was allocated from.
+      unsigned long long    size        ; ///< The size in bytes of this block.
+      unsigned long long    leaf        ; ///< The size in bytes of the smallest range this block hands out.
+      unsigned long long    used        ; ///< The amount of bytes handed out by this block.
+      std::vector<FreeList> free_lists  ; ///< The offsets of free ranges, per order.
+      Allocations           allocations ; ///< The order of each live allocation, by offset.
+      
+      /** Method to initialize this block's free lists.
+       * @param size The size in bytes of this block. Must be a power-of-two multiple of the leaf size.
+       * @param leaf The size in bytes of the smallest range this block hands out.
+       */
+      void initialize( unsigned long long size, unsigned long long leaf ) ;
+
+      /** Method to retrieve the order of range needed for the input size.
+       * @param size The size in bytes to find the order of.
+       * @return The order of range needed to fit the input size.
+       */
+      unsigned order( unsigned long long size ) const ;
+
+      /** Method to carve a range out of this block.
+       * @param order The order of range to carve out.
+       * @param offset Reference to the offset to write the range's offset to.
+       * @return Whether or not a range was available.
+       */
+      bool allocate( unsigned order, unsigned long long& offset ) ;
+
+      /** Method to return a range to this block, merging it with its buddies.
+       * @param offset The offset of the range to return.
+       */
+      void release( unsigned long long offset ) ;
+      
+      /** Method to retrieve the largest free range of this block.
+       * @return The size in bytes of the largest free range of this block.
+       */
+      unsigned long long largestFree() const ;
+    };
+
+    /** Structure to encompass an allocator's internal data.
+     */
+    struct AllocatorData
+    {
+      typedef std::map<unsigned, std::vector<HeapBlock*>> BlockMap     ;
+      typedef std::set<vk::DeviceMemory>                  DedicatedSet ;
+
+      vk::Device                         device           ; ///< The device to allocate from.
+      vk::PhysicalDeviceMemoryProperties properties       ; ///< The memory properties of the device.
+      unsigned long long                 atom             ; ///< The alignment of flush & invalidate ranges for non-coherent memory.
+      unsigned long long                 leaf             ; ///< The smallest range handed out by any block.
+      unsigned long long                 block_size       ; ///< The requested size in bytes of each block.
+      unsigned long long                 dedicated        ; ///< The amount of bytes in live dedicated allocations.
+      unsigned                           dedicated_count  ; ///< The amount of live dedicated allocations.
+      BlockMap                           blocks           ; ///< The blocks allocated from the device, per memory type.
+      DedicatedSet                       dedicated_memory ; ///< The live dedicated allocations.
+      mutable std::mutex                 mutex            ; ///< Guards the block lists.
+
+      /** Default constructor.
+       */
+      AllocatorData() ;
+      
+      /** Method to allocate memory directly from the device.
+       * @param size The size in bytes to allocate.
+       * @param type The memory type index to allocate from.
+       * @return The allocated device memory.
+       */
+      vk::DeviceMemory allocateDevice( unsigned long long size, unsigned type ) ;
+      
+      /** Method to persistently map device memory, if the memory type is host visible.
+       * @param memory The device memory to map.
+       * @param type The memory type index the memory was allocated from.
+       * @return The host mapping of the memory, or nullptr if it can not be mapped.
+       */
+      unsigned char* map( vk::DeviceMemory memory, unsigned type ) ;
+
+      /** Method to check whether a memory type is host coherent.
+       * @param type The memory type index to check.
+       * @return Whether or not the memory type is host coherent.
+       */
+      bool coherent( unsigned type ) const ;
+
+      /** Method to build a mapped memory range for a non-coherent flush or invalidate.
+       * @param memory The memory to build a range of.
+       * @param offset The offset in bytes into the memory of the range.
+       * @param amount The amount of bytes of the range.
+       * @return The range, expanded to the device's non-coherent atom size.
+       */
+      vk::MappedMemoryRange range( const vkg::Memory& memory, unsigned long long offset, unsigned long long amount ) const ;
+      
+      /** Method to compute the size of the blocks created for a memory type.
+       * @param type The memory type index to compute the block size of.
+       * @return The requested block size, shrunk so a single block doesn't take up too much of a small heap.
+       */
+      unsigned long long blockSize( unsigned type ) const ;
+      
+      /** Method to create a new block for the input memory type.
+       * @param type The memory type index to create a block for.
+       * @return The created block, or nullptr if the device is out of memory.
+       */
+      HeapBlock* createBlock( unsigned type ) ;
+    };
+
+    unsigned long long powerOfTwo( unsigned long long value )
+    {
+      unsigned long long result = 1 ;
+      
+      while( result < value ) result <<= 1 ;
+      return result ;
+    }
+
+    MemoryStats::MemoryStats()
+    {
+      this->reserved        = 0    ;
+      this->used            = 0    ;
+      this->largest_free    = 0    ;
+      this->dedicated       = 0    ;
+      this->blocks          = 0    ;
+      this->allocations     = 0    ;
+      this->dedicated_count = 0    ;
+      this->fragmentation   = 0.0f ;
+    }
+
+    void HeapBlock::initialize( unsigned long long size, unsigned long long leaf )
+    {
+      this->size = size ;
+      this->leaf = leaf ;
+      this->used = 0    ;
+      
+      this->free_lists.clear() ;
+      this->free_lists.resize( this->order( size ) + 1 ) ;
+      this->free_lists.back().insert( 0 ) ;
+    }
+
+    unsigned HeapBlock::order( unsigned long long size ) const
+    {
+      unsigned order = 0 ;
+      
+      while( ( this->leaf << order ) < size ) order++ ;
+      return order ;
+    }
+
+    bool HeapBlock::allocate( unsigned order, unsigned long long& offset )
+    {
+      for( unsigned current = order; current < this->free_lists.size(); current++ )
+      {
+        if( !this->free_lists[ current ].empty() )
+        {
+          offset = *this->free_lists[ current ].begin() ;
+          this->free_lists[ current ].erase( this->free_lists[ current ].begin() ) ;
+          
+          // Split the range until it is the requested order, keeping the upper halves free.
+          while( current > order )
+          {
+            current-- ;
+            this->free_lists[ current ].insert( offset + ( this->leaf << current ) ) ;
+          }
+          
+          this->allocations[ offset ] = order ;
+          this->used += this->leaf << order ;
+          return true ;
+        }
+      }
+      
+      return false ;
+    }
+
+    void HeapBlock::release( unsigned long long offset )
+    {
+      auto     iter  = this->allocations.find( offset ) ;
+      unsigned order ;
+
+      if( iter == this->allocations.end() ) return ;
+
+      order = iter->second ;
+      this->allocations.erase( iter ) ;
+      this->used -= this->leaf << order ;
+      
+      // Merge with the buddy range for as long as it is also free.
+      while( order + 1 < this->free_lists.size() )
+      {
+        const unsigned long long buddy = offset ^ ( this->leaf << order ) ;
+        auto                     found = this->free_lists[ order ].find( buddy ) ;
+        
+        if( found == this->free_lists[ order ].end() ) break ;
+        
+        this->free_lists[ order ].erase( found ) ;
+        offset = std::min( offset, buddy ) ;
+        order++ ;
+      }
+      
+      this->free_lists[ order ].insert( offset ) ;
+    }
+    
+    unsigned long long HeapBlock::largestFree() const
+    {
+      for( unsigned order = this->free_lists.size(); order > 0; order-- )
+      {
+        if( !this->free_lists[ order - 1 ].empty() ) return this->leaf << ( order - 1 ) ;
+      }
+      
+      return 0 ;
+    }
+
+    AllocatorData::AllocatorData()
+    {
+      this->atom            = 1                  ;
+      this->leaf            = MIN_LEAF_SIZE      ;
+      this->block_size      = DEFAULT_BLOCK_SIZE ;
+      this->dedicated       = 0                  ;
+      this->dedicated_count = 0                  ;
+    }
+    
+    vk::DeviceMemory AllocatorData::allocateDevice( unsigned long long size, unsigned type )
+    {
+      vk::MemoryAllocateInfo      info      ;
+      vk::MemoryAllocateFlagsInfo flag_info ;
+      
+      flag_info.setFlags( vk::MemoryAllocateFlagBits::eDeviceAddress ) ;
+      
+      info.setAllocationSize ( size       ) ;
+      info.setMemoryTypeIndex( type       ) ;
+      info.setPNext          ( &flag_info ) ;
+      
+      auto result = this->device.allocateMemory( info, nullptr ) ;
+      
+      vkg::Vulkan::add( result.result ) ;
+      
+      return result.value ;
+    }
+
+    unsigned char* AllocatorData::map( vk::DeviceMemory memory, unsigned type )
+    {
+      const auto         flags = this->properties.memoryTypes[ type ].propertyFlags ;
+      vk::MemoryMapFlags flag                                                     ;
+      void*              mem   = nullptr                                          ;
+      
+      if( !( flags & vk::MemoryPropertyFlagBits::eHostVisible ) ) return nullptr ;
+
+      vkg::Vulkan::add( this->device.mapMemory( memory, 0, VK_WHOLE_SIZE, flag, &mem ) ) ;
+      
+      return static_cast<unsigned char*>( mem ) ;
+    }
+    
+    bool AllocatorData::coherent( unsigned type ) const
+    {
+      return static_cast<bool>( this->properties.memoryTypes[ type ].propertyFlags & vk::MemoryPropertyFlagBits::eHostCoherent ) ;
+    }
+
+    vk::MappedMemoryRange AllocatorData::range( const vkg::Memory& memory, unsigned long long offset, unsigned long long amount ) const
+    {
+      const unsigned long long start = memory.offset() + offset                    ;
+      const unsigned long long begin = start - ( start % this->atom )                ;
+      const unsigned long long end   = ( ( start + amount + this->atom - 1 ) / this->atom ) * this->atom ;
+      vk::MappedMemoryRange    range ;
+      
+      range.setMemory( memory        ) ;
+      range.setOffset( begin         ) ;
+      range.setSize  ( end - begin   ) ;
+      
+      // A range rounded past the end of the device memory must use the whole size instead.
+      if( !memory.block || end > static_cast<HeapBlock*>( memory.block )->size ) range.setSize( VK_WHOLE_SIZE ) ;
+      
+      return range ;
+    }
+
+    unsigned long long AllocatorData::blockSize( unsigned type ) const
+    {
+      const unsigned long long heap = this->properties.memoryHeaps[ this->properties.memoryTypes[ type ].heapIndex ].size ;
+      unsigned long long       size = this->block_size ;
+      
+      while( size > this->leaf && size > heap / HEAP_BLOCK_DIVISOR ) size >>= 1 ;
+      
+      return size ;
+    }
+    
+    HeapBlock* AllocatorData::createBlock( unsigned type )
+    {
+      const unsigned long long size = this->blockSize( type ) ;
+      HeapBlock*               block  ;
+      vk::DeviceMemory         memory ;
+      
+      memory = this->allocateDevice( size, type ) ;
+      if( !memory ) return nullptr ;
+      
+      block           = new HeapBlock()                ;
+      block->memory   = memory                         ;
+      block->mapped   = this->map( memory, type )      ;
+      block->coherent = this->coherent( type )         ;
+      block->type     = type                           ;
+      block->initialize( size, this->leaf ) ;
+
+      this->blocks[ type ].push_back( block ) ;
+      
+      return block ;
+    }
+
+    Allocator::Allocator()
+    {
+      this->alloc_data = new AllocatorData() ;
+    }
+
+    Allocator::~Allocator()
+    {
+      delete this->alloc_data ;
+    }
+
+    void Allocator::initialize( const vkg::Device& device )
+    {
+      const auto granularity = device.physicalDevice().getProperties().limits.bufferImageGranularity ;
+
+      data().device     = device.device()                                                            ;
+      data().properties = device.physicalDevice().getMemoryProperties()                              ;
+      data().atom       = device.physicalDevice().getProperties().limits.nonCoherentAtomSize         ;
+      data().leaf       = powerOfTwo( std::max( MIN_LEAF_SIZE, static_cast<unsigned long long>( granularity ) ) ) ;
+    }
+
+    bool Allocator::initialized() const
+    {
+      return static_cast<bool>( data().device ) ;
+    }
+
+    void Allocator::setBlockSize( unsigned long long size )
+    {
+      std::lock_guard<std::mutex> lock( data().mutex ) ;
+      
+      data().block_size = powerOfTwo( size ) ;
+    }
+
+    vkg::Memory Allocator::allocate( unsigned long long size, unsigned type, unsigned long long alignment )
+    {
+      std::lock_guard<std::mutex> lock( data().mutex ) ;
+      vkg::Memory        memory ;
+      unsigned long long offset ;
+      HeapBlock*         block  ;
+      unsigned           order  ;
+      
+      // A buddy range's offset is a multiple of its own size, so a range at least as large as the alignment is aligned.
+      const unsigned long long span = std::max( size, powerOfTwo( std::max( alignment, 1ull ) ) ) ;
+      
+      memory.mem_size      = size                    ;
+      memory.host_coherent = data().coherent( type ) ;
+      
+      // Large allocations would waste most of a block, so give them their own memory.
+      if( span > data().blockSize( type ) / 2 )
+      {
+        const vk::DeviceMemory device_memory = data().allocateDevice( size, type ) ;
+        
+        memory.val = reinterpret_cast<void*>( static_cast<VkDeviceMemory>( device_memory ) ) ;
+        
+        if( memory )
+        {
+          memory.host_ptr   = data().map( memory, type ) ;
+          data().dedicated += size                       ;
+          data().dedicated_count++ ;
+          data().dedicated_memory.insert( device_memory ) ;
+        }
+        
+        return memory ;
+      }
+      
+      for( auto* current : data().blocks[ type ] )
+      {
+        order = current->order( span ) ;
+        if( order < current->free_lists.size() && current->allocate( order, offset ) )
+        {
+          memory.val        = reinterpret_cast<void*>( static_cast<VkDeviceMemory>( current->memory ) ) ;
+          memory.block      = static_cast<void*>( current )                                             ;
+          memory.host_ptr   = current->mapped ? current->mapped + offset : nullptr                      ;
+          memory.mem_offset = offset                                                                    ;
+          return memory ;
+        }
+      }
+
+      // Failure to create a block is already reported by the device allocation.
+      block = data().createBlock( type ) ;
+      if( !block ) return memory ;
+
+      order = block->order( span ) ;
+      if( order < block->free_lists.size() && block->allocate( order, offset ) )
+      {
+        memory.val        = reinterpret_cast<void*>( static_cast<VkDeviceMemory>( block->memory ) ) ;
+        memory.block      = static_cast<void*>( block )                                             ;
+        memory.host_ptr   = block->mapped ? block->mapped + offset : nullptr                        ;
+        memory.mem_offset = offset                                                                  ;
+        return memory ;
+      }
+
+      // The block was made for this allocation alone, so don't keep it around empty.
+      data().blocks[ type ].pop_back() ;
+      if( block->mapped ) data().device.unmapMemory( block->memory ) ;
+      data().device.free( block->memory ) ;
+      delete block ;
+      
+      vkg::Vulkan::add( vkg::Vulkan::Error::OutOfDeviceMemory ) ;
+      return memory ;
+    }
+
+    void Allocator::free( vkg::Memory& memory )
+    {
+      std::lock_guard<std::mutex> lock( data().mutex ) ;
+      HeapBlock* block = static_cast<HeapBlock*>( memory.block ) ;
+      
+      if( !memory ) return ;
+      
+      if( block )
+      {
+        auto& list = data().blocks[ block->type ] ;
+
+        block->release( memory.mem_offset ) ;
+        
+        // Keep one empty block around per type so allocation patterns don't thrash the device.
+        if( block->used == 0 && list.size() > 1 )
+        {
+          list.erase( std::find( list.begin(), list.end(), block ) ) ;
+          if( block->mapped ) data().device.unmapMemory( block->memory ) ;
+          data().device.free( block->memory ) ;
+          delete block ;
+        }
+      }
+      else
+      {
+        if( memory.host_ptr ) data().device.unmapMemory( memory ) ;
+        data().device.free( static_cast<vk::DeviceMemory>( memory ) ) ;
+        data().dedicated -= memory.mem_size ;
+        data().dedicated_count-- ;
+        data().dedicated_memory.erase( static_cast<vk::DeviceMemory>( memory ) ) ;
+      }
+      
+      memory = nullptr ;
+    }
+    
+    void Allocator::write( const vkg::Memory& dst, const void* src, unsigned long long offset, unsigned long long amount )
+    {
+      if( !dst.host_ptr )
+      {
+        vkg::Vulkan::add( vkg::Vulkan::Error::MemoryMapFailed ) ;
+        return ;
+      }
+
+      std::memcpy( static_cast<unsigned char*>( dst.host_ptr ) + offset, src, static_cast<size_t>( amount ) ) ;
+      
+      if( !dst.host_coherent ) this->flush( dst, offset, amount ) ;
+    }
+
+    void Allocator::read( const vkg::Memory& src, void* dst, unsigned long long offset, unsigned long long amount )
+    {
+      if( !src.host_ptr )
+      {
+        vkg::Vulkan::add( vkg::Vulkan::Error::MemoryMapFailed ) ;
+        return ;
+      }
+      
+      if( !src.host_coherent ) this->invalidate( src, offset, amount ) ;
+
+      std::memcpy( dst, static_cast<const unsigned char*>( src.host_ptr ) + offset, static_cast<size_t>( amount ) ) ;
+    }
+    
+    void Allocator::flush( const vkg::Memory& memory, unsigned long long offset, unsigned long long amount )
+    {
+      const auto range = data().range( memory, offset, amount ) ;
+      
+      if( memory.host_coherent ) return ;
+      vkg::Vulkan::add( data().device.flushMappedMemoryRanges( 1, &range ) ) ;
+    }
+
+    void Allocator::invalidate( const vkg::Memory& memory, unsigned long long offset, unsigned long long amount )
+    {
+      const auto range = data().range( memory, offset, amount ) ;
+      
+      if( memory.host_coherent ) return ;
+      vkg::Vulkan::add( data().device.invalidateMappedMemoryRanges( 1, &range ) ) ;
+    }
+
+    vkg::MemoryStats Allocator::stats() const
+    {
+      std::lock_guard<std::mutex> lock( data().mutex ) ;
+      vkg::MemoryStats   stats ;
+      unsigned long long free  ;
+
+      for( const auto& list : data().blocks )
+      {
+        for( const auto* block : list.second )
+        {
+          stats.reserved     += block->size                                     ;
+          stats.used         += block->used                                     ;
+          stats.allocations  += block->allocations.size()                       ;
+          stats.largest_free  = std::max( stats.largest_free, block->largestFree() ) ;
+          stats.blocks++ ;
+        }
+      }
+      
+      stats.dedicated       = data().dedicated       ;
+      stats.dedicated_count = data().dedicated_count ;
+
+      free = stats.reserved - stats.used ;
+      if( free != 0 )
+      {
+        stats.fragmentation = 1.0f - static_cast<float>( stats.largest_free ) / static_cast<float>( free ) ;
+      }
+
+      return stats ;
+    }
+
+    void Allocator::reset()
+    {
+      std::lock_guard<std::mutex> lock( data().mutex ) ;
+      
+      for( auto& list : data().blocks )
+      {
+        for( auto* block : list.second )
+        {
+          if( block->mapped ) data().device.unmapMemory( block->memory ) ;
+          data().device.free( block->memory ) ;
+          delete block ;
+        }
+      }
+      
+      // Freeing memory implicitly unmaps it.
+      for( const auto& memory : data().dedicated_memory ) data().device.free( memory ) ;
+      
+      data().blocks          .clear() ;
+      data().dedicated_memory.clear() ;
+      data().dedicated       = 0      ;
+      data().dedicated_count = 0      ;
+    }
+
+    AllocatorData& Allocator::data()
+    {
+      return *this->alloc_data ;
+    }
+
+    const AllocatorData& Allocator::data() const
+    {
+      return *this->alloc_data ;
+    }
+  }
+}
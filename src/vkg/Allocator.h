@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * File:   Allocator.h
+ * Author: Jordan Hendl
+ *
+ * Created on April 3, 2021, 11:02 AM
+ */
+
+#pragma once
+
+namespace nyx
+{
+  namespace vkg
+  {
+    class Memory ;
+    class Device ;
+
+    /** Structure describing the state of a device's memory heap.
+     */
+    struct MemoryStats
+    {
+      unsigned long long reserved         ; ///< The amount of bytes reserved from the device in heap blocks.
+      unsigned long long used             ; ///< The amount of bytes of the heap blocks handed out to allocations.
+      unsigned long long largest_free     ; ///< The largest contiguous free range, in bytes, of any heap block.
+      unsigned long long dedicated        ; ///< The amount of bytes allocated outside of the heap blocks.
+      unsigned           blocks           ; ///< The amount of heap blocks allocated from the device.
+      unsigned           allocations      ; ///< The amount of live allocations carved out of the heap blocks.
+      unsigned           dedicated_count  ; ///< The amount of live allocations made outside of the heap blocks.
+      float              fragmentation    ; ///< The ratio of free memory not part of the largest free range. 0 means no fragmentation.
+
+      /** Default constructor.
+       */
+      MemoryStats() ;
+    };
+
+    /** Class to manage sub-allocating device memory out of large blocks.
+     * Each memory type of a device gets a list of blocks which are split up using a buddy system.
+     * Allocations too large to fit in a block are allocated from the device directly.
+     * Host visible memory is mapped once on allocation and stays mapped for its lifetime.
+     */
+    class Allocator
+    {
+      public:
+        
+        /** Default constructor.
+         */
+        Allocator() ;
+        
+        /** Default deconstructor.
+         */
+        ~Allocator() ;
+        
+        /** Method to initialize this object with the device to allocate from.
+         * @param device The device to allocate memory from.
+         */
+        void initialize( const vkg::Device& device ) ;
+        
+        /** Method to check whether or not this object is initialized.
+         * @return Whether or not this object is initialized.
+         */
+        bool initialized() const ;
+        
+        /** Method to set the size of the blocks this object allocates from the device.
+         * @note Only affects blocks created after this call. Is rounded up to a power of two.
+         * @param size The size in bytes of each block.
+         */
+        void setBlockSize( unsigned long long size ) ;
+
+        /** Method to allocate memory from this object.
+         * @param size The size in bytes of memory to allocate.
+         * @param type The index of the device's memory type to allocate from.
+         * @param alignment The alignment in bytes the memory's offset must be a multiple of.
+         * @return The allocated memory. Is invalid if the allocation failed.
+         */
+        vkg::Memory allocate( unsigned long long size, unsigned type, unsigned long long alignment = 1 ) ;
+        
+        /** Method to release memory allocated by this object.
+         * @param memory The memory to release.
+         */
+        void free( vkg::Memory& memory ) ;
+        
+        /** Method to write host data into memory allocated by this object.
+         * @param dst The memory to write to.
+         * @param src The host data to copy from.
+         * @param offset The offset in bytes into the memory to write to.
+         * @param amount The amount of bytes to write.
+         */
+        void write( const vkg::Memory& dst, const void* src, unsigned long long offset, unsigned long long amount ) ;
+
+        /** Method to read memory allocated by this object into host data.
+         * @param src The memory to read from.
+         * @param dst The host data to write to.
+         * @param offset The offset in bytes into the memory to read from.
+         * @param amount The amount of bytes to read.
+         */
+        void read( const vkg::Memory& src, void* dst, unsigned long long offset, unsigned long long amount ) ;
+
+        /** Method to make host writes to a range of memory allocated by this object visible to the device.
+         * @note Does nothing for host coherent memory.
+         * @param memory The memory to flush.
+         * @param offset The offset in bytes into the memory to flush.
+         * @param amount The amount of bytes to flush.
+         */
+        void flush( const vkg::Memory& memory, unsigned long long offset, unsigned long long amount ) ;
+
+        /** Method to make device writes to a range of memory allocated by this object visible to the host.
+         * @note Does nothing for host coherent memory.
+         * @param memory The memory to invalidate.
+         * @param offset The offset in bytes into the memory to invalidate.
+         * @param amount The amount of bytes to invalidate.
+         */
+        void invalidate( const vkg::Memory& memory, unsigned long long offset, unsigned long long amount ) ;
+
+        /** Method to retrieve the current statistics of this object's heap.
+         * @return The statistics of this object's heap.
+         */
+        vkg::MemoryStats stats() const ;
+
+        /** Method to release all memory held by this object.
+         * @note All memory allocated by this object is invalid after this call.
+         */
+        void reset() ;
+
+      private:
+        
+        /** Deleted copy constructor. The heap blocks are owned by exactly one object.
+         */
+        Allocator( const Allocator& allocator ) = delete ;
+        
+        /** Deleted assignment operator. The heap blocks are owned by exactly one object.
+         */
+        Allocator& operator=( const Allocator& allocator ) = delete ;
+
+        /** The underlying data of this object.
+         */
+        struct AllocatorData* alloc_data ;
+        
+        /** Method to retrieve a reference to this object's underlying data.
+         * @return Reference to this object's underlying data.
+         */
+        AllocatorData& data() ;
+        
+        /** Method to retrieve a const-reference to this object's underlying data.
+         * @return Const-reference to this object's underlying data.
+         */
+        const AllocatorData& data() const ;
+    };
+  }
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * File:   Batch.cpp
+ * Author: Jordan Hendl
+ * 
+ * Created on October 16, 2026
+ */
+
+#define VULKAN_HPP_NO_EXCEPTIONS
+#define VULKAN_HPP_ASSERT_ON_RESULT
+#define VULKAN_HPP_NOEXCEPT
+#define VULKAN_HPP_NOEXCEPT_WHEN_NO_EXCEPTIONS
+#define VULKAN_HPP_DISPATCH_LOADER_DYNAMIC 1
+
+#include "Batch.h"
+#include "Chain.h"
+#include "Device.h"
+#include "Vulkan.h"
+#include <library/Trace.h>
+#include <vulkan/vulkan.hpp>
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace nyx
+{
+  namespace vkg
+  {
+    /** The amount of fences each batch cycles through. Matches the most frames a Chain may have in flight.
+     */
+    static constexpr unsigned FENCE_COUNT = 8 ;
+    
+    /** Structure to encompass a batch's internal data.
+     */
+    struct BatchData
+    {
+      std::vector<vkg::Chain*> chains  ;
+      std::vector<vk::Fence>   fences  ;
+      vk::Device               device  ;
+      unsigned                 current ;
+      mutable std::mutex       mutex   ;
+      
+      /** Default constructor.
+       */
+      BatchData() ;
+      
+      /** Method to retrieve the next fence to submit with, waiting on it's previous submission if needed.
+       * @note Chains may still refer to a reused fence, which only makes them wait on a later submission.
+       * @param device The device to create fences on.
+       * @return The fence to submit this batch with.
+       */
+      vk::Fence next( const vk::Device& device ) ;
+    };
+    
+    BatchData::BatchData()
+    {
+      this->current = 0 ;
+    }
+    
+    vk::Fence BatchData::next( const vk::Device& device )
+    {
+      vk::FenceCreateInfo info  ;
+      vk::Fence           fence ;
+      
+      if( !this->device ) this->device = device ;
+      
+      if( this->fences.size() < FENCE_COUNT )
+      {
+        auto result = this->device.createFence( info ) ;
+        vkg::Vulkan::add( result.result ) ;
+        this->fences.push_back( result.value ) ;
+        
+        return result.value ;
+      }
+      
+      fence         = this->fences[ this->current ] ;
+      this->current = ( this->current + 1 ) % FENCE_COUNT ;
+      
+      {
+        vkg::StallScope stall( "Batch::fence" ) ;
+        vkg::Vulkan::add( this->device.waitForFences( 1, &fence, true, UINT64_MAX ) ) ;
+      }
+      vkg::Vulkan::add( this->device.resetFences( 1, &fence ) ) ;
+      
+      return fence ;
+    }
+    
+    Batch::Batch()
+    {
+      this->batch_data = new BatchData() ;
+    }
+    
+    Batch::~Batch()
+    {
+      this->reset() ;
+      delete this->batch_data ;
+    }
+    
+    void Batch::add( vkg::Chain& chain )
+    {
+      std::lock_guard<std::mutex> lock( data().mutex ) ;
+      
+      if( std::find( data().chains.begin(), data().chains.end(), &chain ) == data().chains.end() )
+      {
+        data().chains.push_back( &chain ) ;
+      }
+    }
+    
+    unsigned Batch::size() const
+    {
+      std::lock_guard<std::mutex> lock( data().mutex ) ;
+      
+      return data().chains.size() ;
+    }
+    
+    void Batch::submit()
+    {
+      nyx::TraceScope trace( "Batch::submit" ) ;
+      
+      std::lock_guard<std::mutex> lock( data().mutex ) ;
+      
+      if( data().chains.empty() ) return ;
+      
+      const vk::Fence fence = data().next( Vulkan::device( data().chains[ 0 ]->device() ).device() ) ;
+      
+      vkg::Chain::submit( data().chains.data(), data().chains.size(), fence ) ;
+      data().chains.clear() ;
+    }
+    
+    void Batch::clear()
+    {
+      std::lock_guard<std::mutex> lock( data().mutex ) ;
+      
+      data().chains.clear() ;
+    }
+    
+    void Batch::reset()
+    {
+      std::lock_guard<std::mutex> lock( data().mutex ) ;
+      
+      if( !data().fences.empty() )
+      {
+        vkg::StallScope stall( "Batch::reset" ) ;
+        vkg::Vulkan::add( data().device.waitForFences( data().fences.size(), data().fences.data(), true, UINT64_MAX ) ) ;
+        for( auto fence : data().fences ) data().device.destroy( fence ) ;
+      }
+      
+      data().chains.clear() ;
+      data().fences.clear() ;
+      data().device  = vk::Device() ;
+      data().current = 0            ;
+    }
+    
+    BatchData& Batch::data()
+    {
+      return *this->batch_data ;
+    }
+    
+    const BatchData& Batch::data() const
+    {
+      return *this->batch_data ;
+    }
+  }
+}
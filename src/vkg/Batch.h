@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * File:   Batch.h
+ * Author: Jordan Hendl
+ *
+ * Created on October 16, 2026
+ */
+
+#pragma once
+
+namespace nyx
+{
+  namespace vkg
+  {
+    class Chain ;
+    
+    /** Class to collect several chains and submit their work to the device in a single queue submission.
+     * @note All chains in a batch are expected to share a device. Chains on a different queue than the first added are submitted on their own.
+     */
+    class Batch
+    {
+      public:
+        
+        /** Default constructor.
+         */
+        Batch() ;
+        
+        /** Deconstructor. Waits on & releases every fence this object has submitted.
+         * @note See @reset.
+         */
+        ~Batch() ;
+        
+        /** Method to add a chain to this object's next submission.
+         * @note Adding a chain that is already part of the next submission does nothing.
+         * @param chain The chain to submit with this object. Must outlive the next call to @submit.
+         */
+        void add( vkg::Chain& chain ) ;
+        
+        /** Method to retrieve the amount of chains in this object's next submission.
+         * @return The amount of chains in this object's next submission.
+         */
+        unsigned size() const ;
+        
+        /** Method to submit every added chain's work to the device, then clear this object's chains.
+         * @note Each chain's work is submitted the same as @Chain::submit, including it's timeline dependencies, but with a single call to the queue.
+         */
+        void submit() ;
+        
+        /** Method to remove every added chain without submitting them.
+         */
+        void clear() ;
+        
+        /** Method to wait on every submission made by this object and release it's data.
+         * @note Chains submitted with this object must be synchronized or reset first, as they may still refer to it's fences.
+         */
+        void reset() ;
+
+      private:
+        
+        /** The forward declared structure containing this object's data.
+         */
+        struct BatchData* batch_data ;
+        
+        /** Method to retrieve a reference to this object's internal data structure.
+         * @return Reference to this object's internal data structure.
+         */
+        BatchData& data() ;
+        
+        /** Method to retrieve a const-reference to this object's internal data structure.
+         * @return Const-reference to this object's internal data structure.
+         */
+        const BatchData& data() const ;
+    };
+  }
+}
@@ -197,8 +197,10 @@ namespace nyx
 
       if( !data().preallocated )
       {
-        if( host_local ) data().internal_memory.initialize( gpu, data().requirements.size, data().requirements.memoryTypeBits, true, nyx::MemoryFlags::HostCoherent ) ;
-        else             data().internal_memory.initialize( gpu, data().requirements.size, data().requirements.memoryTypeBits, false                                ) ;
+        const unsigned alignment = static_cast<unsigned>( data().requirements.alignment ) ;
+        
+        if( host_local ) data().internal_memory.initialize( gpu, data().requirements.size, data().requirements.memoryTypeBits, alignment, true, nyx::MemoryFlags::HostCoherent ) ;
+        else             data().internal_memory.initialize( gpu, data().requirements.size, data().requirements.memoryTypeBits, alignment, false                                ) ;
         
       }
 
@@ -206,7 +208,7 @@ namespace nyx
 
       if( data().requirements.size <= needed_size )
       {
-        vkg::Vulkan::add( data().device.device().bindBufferMemory( data().buffer, data().internal_memory.memory(), data().internal_memory.offset() ) ) ;
+        vkg::Vulkan::add( data().device.device().bindBufferMemory( data().buffer, data().internal_memory.memory(), data().internal_memory.memory().offset() + data().internal_memory.offset() ) ) ;
 
         data().makeDeviceAddress() ;
         data().initialized = true ;
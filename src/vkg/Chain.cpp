@@ -33,37 +33,159 @@
 #include "Queue.h"
 #include "Vulkan.h"
 #include "Renderer.h"
+#include "Computer.h"
 #include "library/Image.h"
 #include "library/Memory.h"
 #include <library/Array.h>
 #include <library/Chain.h>
+#include <library/Trace.h>
 #include <vulkan/vulkan.hpp>
 #include <mutex>
 #include <map>
+#include <unordered_map>
+#include <deque>
+#include <cstring>
+#include <vector>
 #include <algorithm>
 #include <limits>
+#include <string>
 
 namespace nyx
 {
   namespace vkg
   {
-    static constexpr unsigned COMMAND_BUFFER_COUNT = 4        ;
-    static constexpr unsigned MAX_STAGING_BUFFERS  = 4        ;
-    static constexpr unsigned STAGING_BUFFER_SIZE  = 10000000 ;
+    static constexpr unsigned           COMMAND_BUFFER_COUNT = 4                         ;
+    static constexpr unsigned           MAX_FRAMES_IN_FLIGHT = 8                         ;
+    static constexpr unsigned long long STAGING_BLOCK_SIZE   = 16ull  * 1024ull * 1024ull ;
+    static constexpr unsigned long long STAGING_MAX_BLOCK    = 256ull * 1024ull * 1024ull ;
+    static constexpr unsigned long long STAGING_CHUNK_SIZE   = 8ull   * 1024ull * 1024ull ;
+    static constexpr unsigned long long STAGING_ALIGNMENT    = 256                         ;
+    static constexpr unsigned           TIMESTAMP_COUNT      = 64                          ;
+    
+    using Stage = vk::PipelineStageFlagBits ;
+    
+    /** The pipeline stages barriers can use on each kind of queue.
+     */
+    static const vk::PipelineStageFlags TRANSFER_STAGES = Stage::eTopOfPipe | Stage::eBottomOfPipe | Stage::eTransfer | Stage::eHost | Stage::eAllCommands ;
+    static const vk::PipelineStageFlags COMPUTE_STAGES  = TRANSFER_STAGES | Stage::eDrawIndirect | Stage::eComputeShader ;
+    static const vk::PipelineStageFlags GRAPHICS_STAGES = COMPUTE_STAGES | Stage::eVertexInput | Stage::eVertexShader | Stage::eFragmentShader | Stage::eEarlyFragmentTests | 
+                                                          Stage::eLateFragmentTests | Stage::eColorAttachmentOutput | Stage::eAllGraphics ;
 
-    struct StagingBuffer
+    /** Structure to describe a single growable segment of a device's staging ring.
+     */
+    struct StagingSegment
     {
-      nyx::Array<Vulkan, unsigned char> buffer ;
-      std::mutex                        mutex  ;
+      /** A live range of this segment, in allocation order.
+       */
+      struct Range
+      {
+        unsigned long long offset ; ///< The offset in bytes of this range into the segment.
+        unsigned long long size   ; ///< The size in bytes of this range.
+        unsigned           refs   ; ///< The amount of command buffers still referencing this range.
+      };
+
+      vkg::Buffer        buffer   ; ///< The host-coherent buffer of this segment.
+      unsigned long long capacity ; ///< The size in bytes of this segment.
+      std::deque<Range>  ranges   ; ///< The live ranges of this segment, oldest first.
       
-      bool lock() ;
-      void unlock() ;
+      /** Method to carve a range out of the free space between the newest and oldest range.
+       * @param size The size in bytes of the range.
+       * @param refs The amount of command buffers that will reference the range.
+       * @param offset Reference to the offset to write the range's offset to.
+       * @return Whether or not the range fit in this segment.
+       */
+      bool allocate( unsigned long long size, unsigned refs, unsigned long long& offset ) ;
+      
+      /** Method to drop a reference to a range, reclaiming all released ranges at the tail of the ring.
+       * @param offset The offset of the range to release.
+       */
+      void release( unsigned long long offset ) ;
+    };
+    
+    struct StagingRing ;
+
+    /** Structure to describe a region of a staging ring handed out to a single copy.
+     */
+    struct StagingRegion
+    {
+      StagingRing*       ring    ; ///< The ring this region was carved out of.
+      StagingSegment*    segment ; ///< The segment this region was carved out of.
+      unsigned long long offset  ; ///< The offset in bytes of this region into the segment's buffer.
+      unsigned long long size    ; ///< The size in bytes of this region.
     };
     
+    /** Structure to manage a device's staging memory as a set of rings, shared by every recording thread.
+     * The lock is only held to bump a segment's head, or to grow and retire segments.
+     */
+    struct StagingRing
+    {
+      std::vector<StagingSegment*> segments ;
+      std::mutex                   mutex    ;
+      
+      /** Method to carve a region out of this ring, growing the ring if no segment has room.
+       * @param gpu The device this ring belongs to.
+       * @param size The size in bytes of the region.
+       * @param refs The amount of command buffers that will reference the region.
+       * @return The region carved out of the ring.
+       */
+      StagingRegion allocate( unsigned gpu, unsigned long long size, unsigned refs ) ;
+      
+      /** Method to release a command buffer's reference to a region, retiring it's segment once it is idle.
+       * @param region The region to release.
+       */
+      void release( const StagingRegion& region ) ;
+    };
+
+    /** Structure to describe the resources a transfer queue released in one submit, waiting to be acquired by another queue family.
+     */
+    struct OwnershipTransfer
+    {
+      std::vector<vk::BufferMemoryBarrier> buffers ; ///< The release barriers of each buffer.
+      std::vector<vk::ImageMemoryBarrier>  images  ; ///< The release barriers of each image.
+      vkg::Queue                           queue   ; ///< The queue the resources were released on.
+      vkg::Synchronization                 sync    ; ///< The timeline of the releasing chain.
+      unsigned long long                   value   ; ///< The timeline value signalled once the release completes, or 0 if it already has.
+      unsigned                             family  ; ///< The queue family the resources are released to.
+      const void*                          owner   ; ///< The chain that released the resources.
+    };
+
+    /** Structure to describe how a chain last accessed a resource, so its next use only waits on what it has to.
+     */
+    struct ResourceState
+    {
+      vk::PipelineStageFlags stages         ; ///< The stages that accessed the resource since its last barrier.
+      vk::AccessFlags        writes         ; ///< The writes to the resource since its last barrier.
+      vk::PipelineStageFlags visible_stages ; ///< The stages the last barrier made the resource visible to.
+      vk::AccessFlags        visible        ; ///< The accesses the last barrier made the resource visible to.
+    };
+
+    /** Structure to describe a GPU timer recorded into one of a chain's command buffers.
+     */
+    struct TimerScope
+    {
+      std::string name  ; ///< The name the timer was started with.
+      unsigned    begin ; ///< The query of the timestamp written when the timer started.
+      unsigned    end   ; ///< The query of the timestamp written when the timer ended, or UINT32_MAX while open.
+    };
+
     struct ChainData
     {
-      std::unordered_map<unsigned, vk::ImageMemoryBarrier > image_barriers  ;
-      std::unordered_map<unsigned, vk::BufferMemoryBarrier> buffer_barriers ;
+      using Regions        = std::vector<std::vector<StagingRegion>>     ;
+      using Timers         = std::vector<std::vector<TimerScope>>        ;
+      using Timings        = std::map<std::string, float>                ;
+      using BufferBarriers = std::vector<vk::BufferMemoryBarrier>        ;
+      using ImageBarriers  = std::vector<vk::ImageMemoryBarrier>         ;
+      using Readbacks      = std::vector<vkg::Readback>                  ;
+      using BufferStates   = std::unordered_map<VkBuffer, ResourceState> ;
+      using ImageStates    = std::unordered_map<VkImage , ResourceState> ;
+
+      BufferStates               buffer_states    ;
+      ImageStates                image_states     ;
+      BufferBarriers             pending_buffers  ;
+      ImageBarriers              pending_images   ;
+      vk::PipelineStageFlags     pending_src      ;
+      vk::PipelineStageFlags     pending_dst      ;
+      vk::PipelineStageFlags     supported        ;
       
       vkg::Queue                 queue      ;
       mutable vkg::CommandBuffer cmd        ;
@@ -75,32 +197,418 @@ namespace nyx
       unsigned                   num_cmd    ;
       mutable unsigned           current    ;
       bool                       dirty      ;
+      mutable Regions            staging    ;
+      mutable Readbacks          pending    ;
+      mutable std::vector<Readbacks> readbacks ;
+      mutable BufferBarriers     released_buffers ;
+      mutable ImageBarriers      released_images  ;
+      mutable vkg::CommandBuffer acquire_cmd      ;
+      vkg::Synchronization       acquire_sync     ;
+      bool                       acquire_made     ;
+      unsigned                   target_family    ;
+      nyx::ChainType             target_type      ;
+      mutable vkg::CommandBuffer bundle           ;
+      mutable std::vector<StagingRegion> bundle_staging ;
+      bool                       bundled          ;
+      mutable bool               bundle_pass      ;
+      bool                       multi_pass       ;
+      vkg::Synchronization       sync             ;
+      bool                       sync_made        ;
+      unsigned                   frames           ;
+      mutable Timers             timers           ;
+      std::vector<std::string>   open_timers      ;
+      mutable Timings            timings          ;
+      float                      timestamp_period ;
+      unsigned long long         timestamp_mask   ;
+      bool                       timers_made      ;
       
       ChainData() ;
       
+      /** Method to select this chain's queue from the type of chain.
+       * @param gpu The gpu to select the queue of.
+       * @param type The type of chain.
+       */
+      inline void select( unsigned gpu, nyx::ChainType type ) ;
+      
       inline void record( bool use_render_pass = false ) const ;
       
-      inline StagingBuffer* findStaging() const ;
+      /** Method to track an access to a buffer, queueing the narrowest barrier it needs against the buffer's last accesses.
+       * @note Must be called with the chain's mutex locked, while recording.
+       * @param buffer The buffer being accessed.
+       * @param stage The pipeline stages of the access.
+       * @param access The access flags of the access.
+       * @param write Whether or not the access writes to the buffer.
+       */
+      inline void access( const vkg::Buffer& buffer, vk::PipelineStageFlags stage, vk::AccessFlags access, bool write ) ;
+      
+      /** Method to track an access to an image in its current layout, queueing the narrowest barrier it needs against the image's last accesses.
+       * @note Must be called with the chain's mutex locked, while recording.
+       * @param image The image being accessed.
+       * @param stage The pipeline stages of the access.
+       * @param access The access flags of the access.
+       * @param write Whether or not the access writes to the image.
+       */
+      inline void access( const vkg::Image& image, vk::PipelineStageFlags stage, vk::AccessFlags access, bool write ) ;
+      
+      /** Method to track the accesses of a dispatch to every buffer & image bound to a computer.
+       * @note Must be called with the chain's mutex locked, while recording.
+       * @param computer The computer being dispatched.
+       */
+      inline void access( const vkg::Computer& computer ) ;
+      
+      /** Method to track a read of a buffer recorded where no barrier can be, like inside of a render pass.
+       * @param buffer The buffer being read.
+       * @param stage The pipeline stages of the read.
+       */
+      inline void touch( const vkg::Buffer& buffer, vk::PipelineStageFlags stage ) ;
+      
+      /** Method to queue a layout transition of an image, waiting only on the image's last accesses.
+       * @note Must be called with the chain's mutex locked, while recording.
+       * @param image The image to transition.
+       * @param layout The layout to transition the image to.
+       */
+      inline void transition( vkg::Image& image, vk::ImageLayout layout ) ;
+      
+      /** Method to queue a buffer barrier, to be merged with every other queued barrier.
+       * @param barrier The barrier to queue.
+       * @param src The stages the barrier waits on.
+       * @param dst The stages waiting on the barrier.
+       */
+      inline void queue( const vk::BufferMemoryBarrier& barrier, vk::PipelineStageFlags src, vk::PipelineStageFlags dst ) ;
+      
+      /** Method to queue an image barrier, to be merged with every other queued barrier.
+       * @param barrier The barrier to queue.
+       * @param src The stages the barrier waits on.
+       * @param dst The stages waiting on the barrier.
+       */
+      inline void queue( const vk::ImageMemoryBarrier& barrier, vk::PipelineStageFlags src, vk::PipelineStageFlags dst ) ;
+      
+      /** Method to queue an explicit barrier making every earlier write of a buffer visible to every later read.
+       * Used for accesses this chain can't see, like shader writes through descriptors.
+       * @param buffer The buffer to make visible.
+       */
+      inline void barrier( const vkg::Buffer& buffer ) ;
+      
+      /** Method to record every queued barrier as a single pipeline barrier.
+       * @note Must be called with the chain's mutex locked, while recording.
+       */
+      inline void flush() ;
+      
+      /** Method to narrow pipeline stages down to the ones this chain's queue supports.
+       * @param stages The stages to narrow.
+       * @return The stages this chain's queue supports, or all commands if none are.
+       */
+      inline vk::PipelineStageFlags stages( vk::PipelineStageFlags stages ) const ;
+
+      /** Method to retrieve the staging ring of this chain's device.
+       * @return The device's staging ring.
+       */
+      inline StagingRing& ring() const ;
+      
+      /** Method to retrieve the command buffer operations are recorded to.
+       * @return The bundle when recording once, otherwise the chain's primary command buffers.
+       */
+      inline vkg::CommandBuffer& target() const ;
+      
+      /** Method to finish recording the bundle, and record every primary command buffer to execute it.
+       */
+      inline void replay() ;
+      
+      /** Method to release the staging regions referenced by the bundle.
+       * @note Must only be called once no primary command buffer executing the bundle is in flight.
+       */
+      inline void releaseBundle() const ;
+      
+      /** Method to carve a staging region out of the device's ring for every command buffer this chain records to.
+       * @param size The size in bytes of the region.
+       * @return The region carved out of the ring.
+       */
+      inline StagingRegion stage( unsigned long long size ) ;
+      
+      /** Method to release the staging regions referenced by a command buffer, finishing any of it's readbacks first.
+       * @note Must only be called once the command buffer's fence has been waited on.
+       * @param index The index of command buffer to release the regions of.
+       */
+      inline void release( unsigned index ) const ;
+      
+      /** Method to resolve the GPU timers recorded into a command buffer, without waiting on the device.
+       * @param index The index of the command buffer to resolve the timers of.
+       * @return Whether or not the command buffer's timers were resolved.
+       */
+      inline bool resolve( unsigned index ) const ;
+      
+      /** Method to write a timestamp for a timer into every command buffer this chain records to.
+       * @note Must be called with the chain's mutex locked, while recording.
+       * @param name The name of the timer.
+       * @param end Whether the timer is ending instead of starting.
+       */
+      inline void timestamp( const std::string& name, bool end ) ;
+      
+      /** Method to mark a buffer as written by this chain, so that its ownership is handed off on submit.
+       * @param buffer The buffer written to.
+       */
+      inline void written( const vkg::Buffer& buffer ) ;
+      
+      /** Method to mark an image as written by this chain, so that its ownership is handed off on submit.
+       * @param image The image written to.
+       */
+      inline void written( const vkg::Image& image ) ;
+      
+      /** Method to record the release barriers of all resources written by this chain.
+       * @note Must be called with the chain's mutex locked.
+       */
+      inline void releaseOwnership() ;
+      
+      /** Method to make this chain's released resources visible for other queues to acquire.
+       */
+      inline void publishOwnership() ;
+      
+      /** Method to acquire every resource released to this chain's queue family before its next submit.
+       */
+      inline void acquireOwnership() ;
+      
+      /** Method to tie the readbacks recorded since the last submit to the command buffer about to be submitted.
+       * @note Must be called with the chain's mutex locked, before the command buffer is submitted.
+       */
+      inline void submitReadbacks( const vk::Fence& fence ) ;
+      
+      /** Method to retrieve the timeline this chain signals on every submit, creating it on first use.
+       * @return The synchronization object holding this chain's timeline semaphore.
+       */
+      inline vkg::Synchronization& timeline() ;
     };
     
-    using StagingBuffers = std::map<unsigned, StagingBuffer*> ;
+    using StagingRings       = std::map<unsigned, StagingRing>                    ;
+    using OwnershipTransfers = std::map<unsigned, std::vector<OwnershipTransfer>> ;
+    
+    static StagingRings       staging_rings       ;
+    static std::mutex         staging_mutex       ;
+    static OwnershipTransfers ownership_transfers ;
+    static std::mutex         ownership_mutex     ;
     
-    static StagingBuffers staging_buffers ;
+    bool StagingSegment::allocate( unsigned long long size, unsigned refs, unsigned long long& offset )
+    {
+      unsigned long long head ;
+      
+      if( this->ranges.empty() )
+      {
+        if( size > this->capacity ) return false ;
+        offset = 0 ;
+      }
+      else
+      {
+        const Range& oldest = this->ranges.front() ;
+        const Range& newest = this->ranges.back()  ;
+
+        head = ( ( newest.offset + newest.size + STAGING_ALIGNMENT - 1 ) / STAGING_ALIGNMENT ) * STAGING_ALIGNMENT ;
+        
+        if( newest.offset >= oldest.offset )
+        {
+          // Free space is after the newest range, and before the oldest range once wrapped around.
+          if     ( head + size <= this->capacity ) offset = head ;
+          else if( size <= oldest.offset         ) offset = 0    ;
+          else                                     return false  ;
+        }
+        else
+        {
+          // Already wrapped, so free space is only between the newest and oldest range.
+          if( head + size <= oldest.offset ) offset = head ;
+          else                               return false  ;
+        }
+      }
+      
+      this->ranges.push_back( { offset, size, refs } ) ;
+      return true ;
+    }
+
+    void StagingSegment::release( unsigned long long offset )
+    {
+      for( auto& range : this->ranges )
+      {
+        if( range.offset == offset && range.refs != 0 )
+        {
+          range.refs-- ;
+          break ;
+        }
+      }
+      
+      while( !this->ranges.empty() && this->ranges.front().refs == 0 )
+      {
+        this->ranges.pop_front() ;
+      }
+    }
+
+    StagingRegion StagingRing::allocate( unsigned gpu, unsigned long long size, unsigned refs )
+    {
+      std::lock_guard<std::mutex> lock( this->mutex ) ;
+      StagingRegion      region   ;
+      StagingSegment*    segment  ;
+      unsigned long long capacity ;
+      
+      region.ring = this ;
+      region.size = size ;
+
+      for( auto* current : this->segments )
+      {
+        if( current->allocate( size, refs, region.offset ) )
+        {
+          region.segment = current ;
+          return region ;
+        }
+      }
+      
+      // Every segment is in flight, so grow instead of waiting on the device.
+      capacity = this->segments.empty() ? STAGING_BLOCK_SIZE : std::min( this->segments.back()->capacity * 2, STAGING_MAX_BLOCK ) ;
+      capacity = std::max( capacity, size ) ;
+
+      segment           = new StagingSegment() ;
+      segment->capacity = capacity             ;
+      segment->buffer.initialize( gpu, capacity, true, nyx::ArrayFlags::TransferDst | nyx::ArrayFlags::TransferSrc ) ;
+      segment->allocate( size, refs, region.offset ) ;
+      
+      this->segments.push_back( segment ) ;
+      region.segment = segment ;
+      
+      return region ;
+    }
+
+    void StagingRing::release( const StagingRegion& region )
+    {
+      std::lock_guard<std::mutex> lock( this->mutex ) ;
+      StagingSegment* segment = region.segment ;
+      
+      segment->release( region.offset ) ;
+      
+      // Only the newest, largest segment is kept around once idle, so a burst of uploads doesn't pin it's memory forever.
+      if( segment->ranges.empty() && segment != this->segments.back() )
+      {
+        this->segments.erase( std::find( this->segments.begin(), this->segments.end(), segment ) ) ;
+        segment->buffer.reset() ;
+        delete segment ;
+      }
+    }
+
+    /** Method to retrieve the pipeline stages and accesses that use an image layout.
+     * @param layout The layout to look up.
+     * @param stage Reference to the stages to write to.
+     * @param access Reference to the accesses to write to.
+     */
+    static void layoutAccess( vk::ImageLayout layout, vk::PipelineStageFlags& stage, vk::AccessFlags& access )
+    {
+      using Access = vk::AccessFlagBits ;
+
+      switch( layout )
+      {
+        case vk::ImageLayout::eUndefined                     : stage = Stage::eTopOfPipe                                      ; access = vk::AccessFlags()                                                     ; break ;
+        case vk::ImageLayout::eTransferSrcOptimal            : stage = Stage::eTransfer                                       ; access = Access::eTransferRead                                                 ; break ;
+        case vk::ImageLayout::eTransferDstOptimal            : stage = Stage::eTransfer                                       ; access = Access::eTransferWrite                                                ; break ;
+        case vk::ImageLayout::eShaderReadOnlyOptimal         : stage = Stage::eVertexShader | Stage::eFragmentShader | Stage::eComputeShader ; access = Access::eShaderRead           ; break ;
+        case vk::ImageLayout::eColorAttachmentOptimal        : stage = Stage::eColorAttachmentOutput                          ; access = Access::eColorAttachmentRead | Access::eColorAttachmentWrite        ; break ;
+        case vk::ImageLayout::eDepthStencilAttachmentOptimal : stage = Stage::eEarlyFragmentTests | Stage::eLateFragmentTests ; access = Access::eDepthStencilAttachmentRead | Access::eDepthStencilAttachmentWrite ; break ;
+        case vk::ImageLayout::eDepthReadOnlyOptimalKHR       : stage = Stage::eEarlyFragmentTests | Stage::eFragmentShader    ; access = Access::eDepthStencilAttachmentRead | Access::eShaderRead            ; break ;
+        case vk::ImageLayout::ePresentSrcKHR                 : stage = Stage::eBottomOfPipe                                   ; access = vk::AccessFlags()                                                     ; break ;
+        default                                              : stage = Stage::eAllCommands                                    ; access = Access::eMemoryRead | Access::eMemoryWrite                            ; break ;
+      }
+    }
     
-    bool StagingBuffer::lock()
+    /** Method to check whether a resource's last barrier already made it visible to an access.
+     * @param state The state of the resource.
+     * @param stage The pipeline stages of the access.
+     * @param access The access flags of the access.
+     * @return Whether or not the access can use the resource without another barrier.
+     */
+    static bool visible( const ResourceState& state, vk::PipelineStageFlags stage, vk::AccessFlags access )
     {
-      return this->mutex.try_lock() ;
+      const auto all_access = vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite ;
+      const bool stages     = ( state.visible_stages & vk::PipelineStageFlagBits::eAllCommands ) || ( state.visible_stages & stage ) == stage ;
+      const bool accesses   = ( state.visible & all_access ) == all_access || ( state.visible & access ) == access ;
+      
+      return stages && accesses ;
     }
     
-    void StagingBuffer::unlock()
+    /** Method to compute the dependency an access of a resource has on its last accesses, and update the resource's state.
+     * @param state The state of the resource.
+     * @param stage The pipeline stages of the access.
+     * @param access The access flags of the access.
+     * @param write Whether or not the access writes to the resource.
+     * @param src Reference to the stages the access has to wait on.
+     * @param src_access Reference to the writes that have to be made available to the access.
+     * @return Whether or not the access needs a barrier.
+     */
+    static bool depend( ResourceState& state, vk::PipelineStageFlags stage, vk::AccessFlags access, bool write, vk::PipelineStageFlags& src, vk::AccessFlags& src_access )
     {
-      this->mutex.unlock() ;
+      bool needed = true ;
+      
+      src_access = vk::AccessFlags() ;
+      
+      if     ( state.writes                      ) { src = state.stages ; src_access = state.writes ; } // Read or write after write.
+      else if( write && state.stages             ) { src = state.stages ;                             } // Write after read, only needs execution.
+      else if( !visible( state, stage, access )  ) { src = state.visible_stages ;                     } // Chain onto the last barrier.
+      else                                           needed = false ;
+      
+      if( needed )
+      {
+        state.stages         = stage                                ;
+        state.writes         = write ? access : vk::AccessFlags()   ;
+        state.visible_stages = stage                                ;
+        state.visible        = access                               ;
+      }
+      else
+      {
+        state.stages |= stage ;
+        if( write ) state.writes |= access ;
+      }
+      
+      return needed ;
+    }
+
+    StagingRing& ChainData::ring() const
+    {
+      std::lock_guard<std::mutex> lock( staging_mutex ) ;
+      
+      // Map nodes never move, so the ring outlives the lock.
+      return staging_rings[ this->queue.device() ] ;
+    }
+
+    vkg::CommandBuffer& ChainData::target() const
+    {
+      return this->bundled ? this->bundle : this->cmd ;
     }
 
     void ChainData::record( bool use_render_pass ) const
     {
+      if( this->bundled )
+      {
+        if( !this->bundle.recording() )
+        {
+          // Every primary executes the bundle, so none of them may be in flight while it is re-recorded.
+          for( unsigned index = 0; index < this->cmd.size(); index++ )
+          {
+            this->cmd.wait() ;
+            this->release( this->cmd.current() ) ;
+            this->cmd.advance() ;
+          }
+          
+          this->cmd.setActive( this->current ) ;
+          this->releaseBundle() ;
+          this->released_buffers.clear() ;
+          this->released_images .clear() ;
+          
+          if( !this->bundle.initialized() ) this->bundle.initialize( this->queue, 1, vkg::CommandBuffer::Level::Secondary ) ;
+          
+          this->bundle_pass = this->pass != nullptr && this->pass->initialized() && use_render_pass ;
+          if( this->bundle_pass ) this->bundle.record( *this->pass, 0 ) ;
+          else                    this->bundle.record()                 ;
+        }
+        
+        return ;
+      }
+
       if( !this->cmd.recording() )
       {
+        this->released_buffers.clear() ;
+        this->released_images .clear() ;
+
         if( this->pass != nullptr && this->pass->initialized() && use_render_pass )
         {
           if( this->parent != nullptr )
@@ -116,6 +624,7 @@ namespace nyx
             for( unsigned index = 0; index < this->num_cmd; index++ )
             {
               this->cmd.record( *this->pass ) ;
+              this->release( this->cmd.current() ) ;
               this->cmd.advance() ;
             }
           }
@@ -125,6 +634,7 @@ namespace nyx
           for( unsigned index = 0; index < this->num_cmd; index++ )
           {
             this->cmd.record() ;
+            if( this->parent == nullptr ) this->release( this->cmd.current() ) ;
             this->cmd.advance() ;
           }
         }
@@ -133,225 +643,1062 @@ namespace nyx
       this->cmd.setActive( this->current ) ;
     }
     
-    StagingBuffer* ChainData::findStaging() const
+    StagingRegion ChainData::stage( unsigned long long size )
     {
-      static unsigned id = 0       ;
-      StagingBuffer* tmp = nullptr ;
-
-      StagingBuffers::iterator iter = staging_buffers.begin() ;
-      if( iter == staging_buffers.end() )
+      nyx::TraceScope trace( "ChainData::stage" ) ;
+      
+      StagingRegion region ;
+      
+      region = this->ring().allocate( this->queue.device(), size, this->num_cmd ) ;
+      
+      // Begin recording first, so the new region isn't released by the command buffer's reuse.
+      this->mutex.lock() ;
+      this->record() ;
+      if( this->bundled )
       {
-        staging_buffers.insert( { id++, new StagingBuffer() } ) ;
-        iter = staging_buffers.begin() ;
-        iter->second->buffer.initialize( this->queue.device(), sizeof( unsigned char ) * STAGING_BUFFER_SIZE, true, nyx::ArrayFlags::TransferDst | nyx::ArrayFlags::TransferSrc ) ;
+        // The bundle copies out of the region every time it's executed, so keep it until the bundle is re-recorded.
+        this->bundle_staging.push_back( region ) ;
       }
-      
-      while( iter != staging_buffers.end() )
+      else
       {
-        if( iter->second->lock() ) return iter->second ;
-        iter++ ;
-        
-        if( iter == staging_buffers.end() && staging_buffers.size() < MAX_STAGING_BUFFERS )
-        {
-          staging_buffers.insert( { id++, new StagingBuffer() } ) ;
-          iter = staging_buffers.find( id - 1 ) ;
-          iter->second->buffer.initialize( this->queue.device(), sizeof( unsigned char ) * STAGING_BUFFER_SIZE, true, nyx::ArrayFlags::TransferDst | nyx::ArrayFlags::TransferSrc ) ;
-        }
-        else if( iter == staging_buffers.end() )
+        if( this->staging.size() < this->cmd.size() ) this->staging.resize( this->cmd.size() ) ;
+        for( unsigned index = 0; index < this->num_cmd; index++ )
         {
-          iter = staging_buffers.begin() ;
+          this->staging[ ( this->current + index ) % this->staging.size() ].push_back( region ) ;
         }
       }
-      
-      return tmp ;
-    }
+      this->mutex.unlock() ;
 
-    ChainData::ChainData()
-    {
-      this->has_record = false      ;
-      this->subpass_id = UINT32_MAX ;
-      this->parent     = nullptr    ;
-      this->pass       = nullptr    ;
-      this->num_cmd    = 1          ;
-      this->current    = 0          ;
-      this->dirty      = false      ;
+      return region ;
     }
-
-    Chain::Chain()
+    
+    void ChainData::release( unsigned index ) const
     {
-      this->chain_data = new ChainData() ;
+      // The command buffer is about to reset it's queries, so read back what it's last submission measured.
+      if( index < this->timers.size() )
+      {
+        this->resolve( index ) ;
+        this->timers[ index ].clear() ;
+      }
+      
+      // The staging memory is about to be reused, so readbacks out of it must land in host memory first.
+      if( index < this->readbacks.size() )
+      {
+        for( const auto& readback : this->readbacks[ index ] ) readback.finish() ;
+        this->readbacks[ index ].clear() ;
+      }
+
+      if( index >= this->staging.size() || this->staging[ index ].empty() ) return ;
+      
+      // Each region remembers the ring it was carved out of, so release it through that.
+      for( const auto& region : this->staging[ index ] )
+      {
+        region.ring->release( region ) ;
+      }
+      
+      this->staging[ index ].clear() ;
     }
 
-    Chain::~Chain()
+    bool ChainData::resolve( unsigned index ) const
     {
-      delete this->chain_data ;
+      std::vector<unsigned long long> values ;
+      unsigned                        count  ;
+      
+      if( index >= this->timers.size() || this->timers[ index ].empty() ) return false ;
+      
+      count = 0 ;
+      for( const auto& timer : this->timers[ index ] )
+      {
+        if( timer.end != UINT32_MAX ) count = std::max( count, timer.end + 1 ) ;
+      }
+      
+      values.resize( count ) ;
+      if( count == 0 || !this->cmd.timestamps( index, count, values.data() ) ) return false ;
+      
+      for( const auto& timer : this->timers[ index ] )
+      {
+        if( timer.end == UINT32_MAX ) continue ;
+        
+        const unsigned long long ticks = ( values[ timer.end ] - values[ timer.begin ] ) & this->timestamp_mask ;
+        
+        this->timings[ timer.name ] = static_cast<float>( ticks ) * this->timestamp_period / 1000000.0f ;
+      }
+      
+      return true ;
     }
-
-    void Chain::advance()
+    
+    void ChainData::timestamp( const std::string& name, bool end )
     {
-      data().mutex.lock() ;
-      data().cmd.advance() ;
-      data().mutex.unlock() ;
+      if( this->timers.size() < this->cmd.size() ) this->timers.resize( this->cmd.size() ) ;
+      
+      for( unsigned index = 0; index < this->num_cmd; index++ )
+      {
+        auto&          scopes = this->timers[ this->cmd.current() ] ;
+        const unsigned query  = this->cmd.timestamp( end )          ;
+        
+        if( !end && query != UINT32_MAX )
+        {
+          scopes.push_back( { name, query, UINT32_MAX } ) ;
+        }
+        else if( end )
+        {
+          // Close the latest timer with this name still open, dropping it if there was no query left to end it with.
+          for( auto timer = scopes.rbegin(); timer != scopes.rend(); ++timer )
+          {
+            if( timer->name != name || timer->end != UINT32_MAX ) continue ;
+            
+            if( query != UINT32_MAX ) timer->end = query ;
+            else                      scopes.erase( std::next( timer ).base() ) ;
+            break ;
+          }
+        }
+        
+        this->cmd.advance() ;
+      }
+      
+      this->cmd.setActive( this->current ) ;
     }
     
-    void Chain::initialize( const Chain& parent, unsigned subpass_id )
+    void ChainData::releaseBundle() const
     {
-      data().pass       = parent.data().pass            ;
-      data().parent     = const_cast<Chain*>( &parent ) ;
-      data().subpass_id = subpass_id                    ;
-
-      data().cmd.initialize( parent.data().cmd ) ;
+      for( const auto& region : this->bundle_staging ) region.ring->release( region ) ;
+      this->bundle_staging.clear() ;
     }
     
-    void Chain::initialize( unsigned gpu, unsigned window_id )
+    void ChainData::replay()
     {
-      if( Vulkan::hasWindow( window_id ) )
+      if( !this->bundle.recording() ) return ;
+      
+      this->releaseOwnership() ;
+      this->bundle.stop() ;
+      
+      this->cmd.setMultiPass( this->bundle_pass || this->multi_pass ) ;
+      for( unsigned index = 0; index < this->cmd.size(); index++ )
       {
-        data().queue = Vulkan::presentQueue( window_id, gpu ) ;
-        data().cmd.initialize( data().queue, COMMAND_BUFFER_COUNT ) ;
+        if( this->bundle_pass ) this->cmd.record( *this->pass ) ;
+        else                    this->cmd.record()              ;
+        
+        this->cmd.buffer().executeCommands( 1, &this->bundle.buffer() ) ;
+        this->cmd.stop   () ;
+        this->cmd.advance() ;
       }
+      
+      this->cmd.setMultiPass( this->multi_pass ) ;
+      this->cmd.setActive   ( this->current    ) ;
+      this->has_record = true ;
     }
 
-    void Chain::initialize( unsigned gpu, ChainType type )
+    void ChainData::select( unsigned gpu, nyx::ChainType type )
     {
-      this->reset() ;
       switch( type )
       {
-        case nyx::ChainType::Graphics : data().queue = Vulkan::graphicsQueue( gpu ) ; break ;
-        case nyx::ChainType::Compute  : data().queue = Vulkan::computeQueue ( gpu ) ; break ;
-//        case nyx::ChainType::Transfer : data().queue = Vulkan::tranferQueue ( gpu ) ; break
-        default : data().queue = Vulkan::computeQueue( gpu ) ;
+        case nyx::ChainType::Graphics : this->queue = Vulkan::graphicsQueue( gpu ) ; this->supported = GRAPHICS_STAGES ; break ;
+        case nyx::ChainType::Compute  : this->queue = Vulkan::computeQueue ( gpu ) ; this->supported = COMPUTE_STAGES  ; break ;
+        case nyx::ChainType::Transfer : this->queue = Vulkan::transferQueue( gpu ) ; this->supported = TRANSFER_STAGES ; break ;
+        default : this->queue = Vulkan::computeQueue( gpu ) ; this->supported = COMPUTE_STAGES ;
+      }
+      
+      // Transfer queues of their own family hand ownership of what they write over to the family of the queue that uses it next.
+      this->target_family = UINT32_MAX ;
+      if( type == nyx::ChainType::Transfer )
+      {
+        const unsigned family = this->target_type == nyx::ChainType::Compute ? Vulkan::computeQueue( gpu ).family() : Vulkan::graphicsQueue( gpu ).family() ;
+        
+        if( this->queue.family() != family ) this->target_family = family ;
       }
-
-      data().cmd.initialize( data().queue, COMMAND_BUFFER_COUNT ) ;
     }
-    
-    void Chain::initialize( const RenderPass& pass, ChainType type, bool multi_pass )
+
+    void ChainData::access( const vkg::Buffer& buffer, vk::PipelineStageFlags stage, vk::AccessFlags access, bool write )
     {
-      const unsigned gpu = pass.device() ;
-      this->reset() ;
-      data().pass = &pass ;
-      switch( type )
+      const ResourceState      initial = { vk::PipelineStageFlags(), vk::AccessFlags(), vk::PipelineStageFlagBits::eAllCommands, vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite } ;
+      ResourceState&           state   = this->buffer_states.emplace( static_cast<VkBuffer>( buffer.buffer() ), initial ).first->second ;
+      vk::PipelineStageFlags   src     ;
+      vk::AccessFlags          src_access ;
+      vk::BufferMemoryBarrier  barrier ;
+      
+      stage = this->stages( stage ) ;
+      if( !depend( state, stage, access, write, src, src_access ) ) return ;
+      
+      if( !src_access && write )
       {
-        case nyx::ChainType::Graphics : data().queue = Vulkan::graphicsQueue( gpu ) ; break ;
-        case nyx::ChainType::Compute  : data().queue = Vulkan::computeQueue ( gpu ) ; break ;
-//        case nyx::ChainType::Transfer : data().queue = Vulkan::tranferQueue ( gpu ) ; break
-        default : data().queue = Vulkan::computeQueue( gpu ) ;
+        // Nothing to make visible, so waiting on the earlier stages is enough.
+        this->pending_src |= src   ;
+        this->pending_dst |= stage ;
+        return ;
       }
-
-      data().cmd.initialize( data().queue, COMMAND_BUFFER_COUNT, vkg::CommandBuffer::Level::Primary, multi_pass ) ;
+      
+      barrier.setBuffer             ( buffer.buffer()         ) ;
+      barrier.setOffset             ( 0                       ) ;
+      barrier.setSize               ( VK_WHOLE_SIZE           ) ;
+      barrier.setSrcAccessMask      ( src_access              ) ;
+      barrier.setDstAccessMask      ( access                  ) ;
+      barrier.setSrcQueueFamilyIndex( VK_QUEUE_FAMILY_IGNORED ) ;
+      barrier.setDstQueueFamilyIndex( VK_QUEUE_FAMILY_IGNORED ) ;
+      
+      this->queue( barrier, src, stage ) ;
     }
     
-    void Chain::initialize( const RenderPass& pass, unsigned window_id, bool multi_pass )
+    void ChainData::access( const vkg::Image& image, vk::PipelineStageFlags stage, vk::AccessFlags access, bool write )
     {
-      this->reset() ;
-      data().pass  = &pass ;
-      if( Vulkan::hasWindow( window_id ) )
+      const ResourceState      initial = { vk::PipelineStageFlags(), vk::AccessFlags(), vk::PipelineStageFlagBits::eAllCommands, vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite } ;
+      const vk::ImageLayout    layout  = Vulkan::convert( image.layout() ) ;
+      ResourceState&           state   = this->image_states.emplace( static_cast<VkImage>( image.image() ), initial ).first->second ;
+      vk::PipelineStageFlags   src     ;
+      vk::AccessFlags          src_access ;
+      vk::ImageMemoryBarrier   barrier ;
+      vk::ImageSubresourceRange range  ;
+      
+      stage = this->stages( stage ) ;
+      if( !depend( state, stage, access, write, src, src_access ) ) return ;
+      
+      if( !src_access && write )
       {
-        data().queue = Vulkan::presentQueue( window_id, pass.device()                                             ) ;
-        data().cmd.initialize( data().queue, COMMAND_BUFFER_COUNT, vkg::CommandBuffer::Level::Primary, multi_pass ) ;
+        this->pending_src |= src   ;
+        this->pending_dst |= stage ;
+        return ;
       }
+      
+      range.setBaseArrayLayer( 0                               ) ;
+      range.setBaseMipLevel  ( 0                               ) ;
+      range.setLevelCount    ( 1                               ) ;
+      range.setLayerCount    ( image.layers()                  ) ;
+      range.setAspectMask    ( vk::ImageAspectFlagBits::eColor ) ;
+      
+      barrier.setOldLayout          ( layout                  ) ;
+      barrier.setNewLayout          ( layout                  ) ;
+      barrier.setImage              ( image.image()           ) ;
+      barrier.setSubresourceRange   ( range                   ) ;
+      barrier.setSrcAccessMask      ( src_access              ) ;
+      barrier.setDstAccessMask      ( access                  ) ;
+      barrier.setSrcQueueFamilyIndex( VK_QUEUE_FAMILY_IGNORED ) ;
+      barrier.setDstQueueFamilyIndex( VK_QUEUE_FAMILY_IGNORED ) ;
+      
+      this->queue( barrier, src, stage ) ;
     }
     
-    bool Chain::initialized() const 
+    void ChainData::access( const vkg::Computer& computer )
     {
-      return data().cmd.initialized() ;
+      const vk::AccessFlags read_write = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite ;
+      
+      // Uniform buffers & sampled images are only ever read by the kernel, while storage buffers & images may be written.
+      for( unsigned index = 0; index < computer.numBuffers(); index++ )
+      {
+        if( computer.writes( index ) ) this->access( computer.buffer( index ), Stage::eComputeShader, read_write                       , true  ) ;
+        else                           this->access( computer.buffer( index ), Stage::eComputeShader, vk::AccessFlagBits::eUniformRead, false ) ;
+      }
+      
+      for( unsigned index = 0; index < computer.numImages(); index++ )
+      {
+        if( computer.writesImage( index ) ) this->access( computer.image( index ), Stage::eComputeShader, read_write                      , true  ) ;
+        else                                this->access( computer.image( index ), Stage::eComputeShader, vk::AccessFlagBits::eShaderRead, false ) ;
+      }
     }
-
-    unsigned Chain::device() const
+    
+    void ChainData::touch( const vkg::Buffer& buffer, vk::PipelineStageFlags stage )
     {
-      return data().queue.device() ;
+      const ResourceState initial = { vk::PipelineStageFlags(), vk::AccessFlags(), vk::PipelineStageFlagBits::eAllCommands, vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite } ;
+      
+      this->buffer_states.emplace( static_cast<VkBuffer>( buffer.buffer() ), initial ).first->second.stages |= this->stages( stage ) ;
     }
-
-    void Chain::transition( vkg::Image& image, nyx::ImageLayout layout )
+    
+    void ChainData::transition( vkg::Image& image, vk::ImageLayout layout )
     {
+      const vk::ImageLayout     old_layout = Vulkan::convert( image.layout() )                      ;
+      const auto                iter       = this->image_states.find( static_cast<VkImage>( image.image() ) ) ;
       vk::ImageMemoryBarrier    barrier    ;
       vk::ImageSubresourceRange range      ;
       vk::PipelineStageFlags    src        ;
       vk::PipelineStageFlags    dst        ;
-      vk::DependencyFlags       dep_flags  ;
-      vk::ImageLayout           new_layout ;
-      vk::ImageLayout           old_layout ;
+      vk::AccessFlags           src_access ;
+      vk::AccessFlags           dst_access ;
       
-      new_layout = nyx::vkg::Vulkan::convert( layout         ) ;
-      old_layout = nyx::vkg::Vulkan::convert( image.layout() ) ;
+      if( layout == vk::ImageLayout::eUndefined || layout == old_layout ) return ;
+      
+      if( iter != this->image_states.end() )
+      {
+        src        = iter->second.stages ? iter->second.stages : iter->second.visible_stages ;
+        src_access = iter->second.writes                                                      ;
+      }
+      else
+      {
+        // Nothing is known about the image, so anything before could have written to it, unless its contents are discarded.
+        src        = old_layout == vk::ImageLayout::eUndefined ? vk::PipelineStageFlags( vk::PipelineStageFlagBits::eTopOfPipe ) : vk::PipelineStageFlags( vk::PipelineStageFlagBits::eAllCommands ) ;
+        src_access = old_layout == vk::ImageLayout::eUndefined ? vk::AccessFlags()                                            : vk::AccessFlags( vk::AccessFlagBits::eMemoryWrite )                 ;
+      }
+      
+      layoutAccess( layout, dst, dst_access ) ;
+      dst = this->stages( dst ) ;
+
+      range.setBaseArrayLayer( 0                               ) ;
+      range.setBaseMipLevel  ( 0                               ) ;
+      range.setLevelCount    ( 1                               ) ;
+      range.setLayerCount    ( image.layers()                  ) ;
+      range.setAspectMask    ( vk::ImageAspectFlagBits::eColor ) ;
+      
+      barrier.setOldLayout          ( old_layout              ) ;
+      barrier.setNewLayout          ( layout                  ) ;
+      barrier.setImage              ( image.image()           ) ;
+      barrier.setSubresourceRange   ( range                   ) ;
+      barrier.setSrcAccessMask      ( src_access              ) ;
+      barrier.setDstAccessMask      ( dst_access              ) ;
+      barrier.setSrcQueueFamilyIndex( VK_QUEUE_FAMILY_IGNORED ) ;
+      barrier.setDstQueueFamilyIndex( VK_QUEUE_FAMILY_IGNORED ) ;
+      
+      this->queue( barrier, src, dst ) ;
+      this->image_states[ static_cast<VkImage>( image.image() ) ] = { vk::PipelineStageFlags(), vk::AccessFlags(), dst, dst_access } ;
+      image.setLayout( Vulkan::convert( layout ) ) ;
+    }
+    
+    void ChainData::queue( const vk::BufferMemoryBarrier& barrier, vk::PipelineStageFlags src, vk::PipelineStageFlags dst )
+    {
+      // Two barriers of one resource in a single command have no order between them.
+      for( const auto& pending : this->pending_buffers )
+      {
+        if( pending.buffer == barrier.buffer )
+        {
+          this->flush() ;
+          break ;
+        }
+      }
+
+      this->pending_buffers.push_back( barrier ) ;
+      this->pending_src |= src ;
+      this->pending_dst |= dst ;
+    }
+    
+    void ChainData::queue( const vk::ImageMemoryBarrier& barrier, vk::PipelineStageFlags src, vk::PipelineStageFlags dst )
+    {
+      for( const auto& pending : this->pending_images )
+      {
+        if( pending.image == barrier.image )
+        {
+          this->flush() ;
+          break ;
+        }
+      }
+
+      this->pending_images.push_back( barrier ) ;
+      this->pending_src |= src ;
+      this->pending_dst |= dst ;
+    }
+    
+    void ChainData::barrier( const vkg::Buffer& buffer )
+    {
+      vk::BufferMemoryBarrier barrier ;
+      
+      barrier.setBuffer             ( buffer.buffer()                    ) ;
+      barrier.setOffset             ( 0                                  ) ;
+      barrier.setSize               ( VK_WHOLE_SIZE                      ) ;
+      barrier.setSrcAccessMask      ( vk::AccessFlagBits::eMemoryWrite   ) ;
+      barrier.setDstAccessMask      ( vk::AccessFlagBits::eMemoryRead    ) ;
+      barrier.setSrcQueueFamilyIndex( VK_QUEUE_FAMILY_IGNORED            ) ;
+      barrier.setDstQueueFamilyIndex( VK_QUEUE_FAMILY_IGNORED            ) ;
+      
+      this->queue( barrier, Stage::eAllCommands, Stage::eAllCommands ) ;
+      this->buffer_states[ static_cast<VkBuffer>( buffer.buffer() ) ] = { vk::PipelineStageFlags(), vk::AccessFlags(), Stage::eAllCommands, vk::AccessFlagBits::eMemoryRead } ;
+    }
+    
+    void ChainData::flush()
+    {
+      const auto dep_flags = vk::DependencyFlags() ;
+
+      if( !this->pending_src ) return ;
+      
+      for( unsigned index = 0; index < this->num_cmd; index++ )
+      {
+        this->target().buffer().pipelineBarrier( this->pending_src, this->pending_dst, dep_flags, 0, nullptr, 
+                                                 static_cast<unsigned>( this->pending_buffers.size() ), this->pending_buffers.data(), 
+                                                 static_cast<unsigned>( this->pending_images .size() ), this->pending_images .data() ) ;
+        this->target().advance() ;
+      }
+      
+      this->target().setActive( this->current ) ;
+      this->pending_buffers.clear() ;
+      this->pending_images .clear() ;
+      this->pending_src = vk::PipelineStageFlags() ;
+      this->pending_dst = vk::PipelineStageFlags() ;
+    }
+    
+    vk::PipelineStageFlags ChainData::stages( vk::PipelineStageFlags stages ) const
+    {
+      const vk::PipelineStageFlags narrowed = stages & this->supported ;
+      
+      return narrowed ? narrowed : vk::PipelineStageFlags( vk::PipelineStageFlagBits::eAllCommands ) ;
+    }
+
+    void ChainData::written( const vkg::Buffer& buffer )
+    {
+      vk::BufferMemoryBarrier barrier ;
+      
+      if( this->target_family == UINT32_MAX ) return ;
+      
+      barrier.setBuffer             ( buffer.buffer()                    ) ;
+      barrier.setOffset             ( 0                                  ) ;
+      barrier.setSize               ( VK_WHOLE_SIZE                      ) ;
+      barrier.setSrcAccessMask      ( vk::AccessFlagBits::eTransferWrite ) ;
+      barrier.setDstAccessMask      ( vk::AccessFlags()                  ) ;
+      barrier.setSrcQueueFamilyIndex( this->queue.family()               ) ;
+      barrier.setDstQueueFamilyIndex( this->target_family                ) ;
+      
+      this->mutex.lock() ;
+      for( auto& released : this->released_buffers )
+      {
+        if( released.buffer == barrier.buffer )
+        {
+          this->mutex.unlock() ;
+          return ;
+        }
+      }
+      
+      this->released_buffers.push_back( barrier ) ;
+      this->mutex.unlock() ;
+    }
 
+    void ChainData::written( const vkg::Image& image )
+    {
+      const vk::ImageLayout     layout  = Vulkan::convert( image.layout() ) ;
+      vk::ImageMemoryBarrier    barrier ;
+      vk::ImageSubresourceRange range   ;
+      
+      if( this->target_family == UINT32_MAX ) return ;
+      
       range.setBaseArrayLayer( 0                               ) ;
       range.setBaseMipLevel  ( 0                               ) ;
       range.setLevelCount    ( 1                               ) ;
       range.setLayerCount    ( image.layers()                  ) ;
       range.setAspectMask    ( vk::ImageAspectFlagBits::eColor ) ;
       
-      barrier.setOldLayout          ( old_layout                       ) ;
-      barrier.setNewLayout          ( new_layout                       ) ;
-      barrier.setImage              ( image.image()                    ) ;
-      barrier.setSubresourceRange   ( range                            ) ;
-      barrier.setSrcQueueFamilyIndex( VK_QUEUE_FAMILY_IGNORED          ) ;
-      barrier.setDstQueueFamilyIndex( VK_QUEUE_FAMILY_IGNORED          ) ;
+      barrier.setImage              ( image.image()                      ) ;
+      barrier.setOldLayout          ( layout                             ) ;
+      barrier.setNewLayout          ( layout                             ) ;
+      barrier.setSubresourceRange   ( range                              ) ;
+      barrier.setSrcAccessMask      ( vk::AccessFlagBits::eTransferWrite ) ;
+      barrier.setDstAccessMask      ( vk::AccessFlags()                  ) ;
+      barrier.setSrcQueueFamilyIndex( this->queue.family()               ) ;
+      barrier.setDstQueueFamilyIndex( this->target_family                ) ;
+      
+      this->mutex.lock() ;
+      for( auto& released : this->released_images )
+      {
+        if( released.image == barrier.image )
+        {
+          // The image may have been transitioned since, so keep the latest layout.
+          released = barrier ;
+          this->mutex.unlock() ;
+          return ;
+        }
+      }
+      
+      this->released_images.push_back( barrier ) ;
+      this->mutex.unlock() ;
+    }
+    
+    void ChainData::releaseOwnership()
+    {
+      const auto src_flag  = vk::PipelineStageFlagBits::eTransfer     ;
+      const auto dst_flag  = vk::PipelineStageFlagBits::eBottomOfPipe ;
+      const auto dep_flags = vk::DependencyFlags()                    ;
+      
+      if( this->target_family == UINT32_MAX || this->pass != nullptr ) return ;
+      if( this->released_buffers.empty() && this->released_images.empty() ) return ;
+      
+      for( unsigned index = 0; index < this->num_cmd; index++ )
+      {
+        this->target().buffer().pipelineBarrier( src_flag, dst_flag, dep_flags, 0, nullptr, 
+                                            this->released_buffers.size(), this->released_buffers.data(), 
+                                            this->released_images .size(), this->released_images .data() ) ;
+        this->target().advance() ;
+      }
+      
+      this->target().setActive( this->current ) ;
+    }
+    
+    void ChainData::publishOwnership()
+    {
+      if( this->target_family == UINT32_MAX || this->pass != nullptr ) return ;
+      if( this->released_buffers.empty() && this->released_images.empty() ) return ;
+      
+      OwnershipTransfer transfer ;
+      
+      transfer.buffers = this->released_buffers   ;
+      transfer.images  = this->released_images    ;
+      transfer.queue   = this->queue              ;
+      transfer.sync    = this->timeline()         ;
+      transfer.value   = this->timeline().value() ;
+      transfer.family  = this->target_family      ;
+      transfer.owner   = this                     ;
+      
+      ownership_mutex.lock() ;
+      ownership_transfers[ this->queue.device() ].push_back( transfer ) ;
+      ownership_mutex.unlock() ;
+    }
+    
+    void ChainData::acquireOwnership()
+    {
+      const auto src_flag  = vk::PipelineStageFlagBits::eTopOfPipe   ;
+      const auto dst_flag  = vk::PipelineStageFlagBits::eAllCommands ;
+      const auto dep_flags = vk::DependencyFlags()                   ;
+      const auto access    = vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite ;
+      
+      std::vector<OwnershipTransfer> transfers ;
+      BufferBarriers                 buffers   ;
+      ImageBarriers                  images    ;
+      
+      if( this->target_family != UINT32_MAX ) return ;
+      
+      ownership_mutex.lock() ;
+      auto iter = ownership_transfers.find( this->queue.device() ) ;
+      if( iter != ownership_transfers.end() )
+      {
+        auto& list = iter->second ;
+        
+        for( auto transfer = list.begin(); transfer != list.end(); )
+        {
+          if( transfer->family == this->queue.family() ) { transfers.push_back( *transfer ) ; transfer = list.erase( transfer ) ; }
+          else                                           { ++transfer ;                                                       }
+        }
+      }
+      ownership_mutex.unlock() ;
+      
+      if( transfers.empty() ) return ;
+      
+      if( !this->acquire_made )
+      {
+        this->acquire_sync.setMakeFence( false                   ) ;
+        this->acquire_sync.setTimeline ( true                    ) ;
+        this->acquire_sync.initialize  ( this->queue.device(), 0 ) ;
+        this->acquire_made = true ;
+      }
+      
+      for( auto& transfer : transfers )
+      {
+        buffers.insert( buffers.end(), transfer.buffers.begin(), transfer.buffers.end() ) ;
+        images .insert( images .end(), transfer.images .begin(), transfer.images .end() ) ;
+        
+        // The acquire must not execute before the release finishes, so wait on the releasing chain's timeline on the device.
+        // Without timeline semaphores, only the host can order the two queues.
+        if( transfer.value == 0 ) continue ;
+        if( transfer.sync.timeline() && this->acquire_sync.timeline() ) this->acquire_sync.waitOn( transfer.sync, transfer.value ) ;
+        else                                                            transfer.queue.wait() ;
+      }
+      
+      for( auto& barrier : buffers ) { barrier.setSrcAccessMask( vk::AccessFlags() ) ; barrier.setDstAccessMask( access ) ; }
+      for( auto& barrier : images  ) { barrier.setSrcAccessMask( vk::AccessFlags() ) ; barrier.setDstAccessMask( access ) ; }
+      
+      if( !this->acquire_cmd.initialized() ) this->acquire_cmd.initialize( this->queue, this->frames ) ;
+      
+      this->acquire_cmd.record() ;
+      this->acquire_cmd.buffer().pipelineBarrier( src_flag, dst_flag, dep_flags, 0, nullptr, buffers.size(), buffers.data(), images.size(), images.data() ) ;
+      this->acquire_cmd.stop() ;
+      this->queue.submit( this->acquire_cmd, this->acquire_sync ) ;
+      this->acquire_sync.clear() ;
+    }
+
+    void ChainData::submitReadbacks( const vk::Fence& fence )
+    {
+      const unsigned index = this->cmd.current() ;
+      
+      if( this->pending.empty() ) return ;
+      if( this->readbacks.size() < this->cmd.size() ) this->readbacks.resize( this->cmd.size() ) ;
+      
+      for( auto& readback : this->pending )
+      {
+        readback.submit( Vulkan::device( this->queue.device() ).device(), fence ) ;
+        this->readbacks[ index ].push_back( readback ) ;
+      }
+      
+      this->pending.clear() ;
+    }
+
+    ChainData::ChainData()
+    {
+      this->has_record = false      ;
+      this->subpass_id = UINT32_MAX ;
+      this->parent     = nullptr    ;
+      this->pass       = nullptr    ;
+      this->num_cmd    = 1          ;
+      this->current    = 0          ;
+      this->dirty      = false      ;
+      
+      this->target_family = UINT32_MAX ;
+      this->target_type   = nyx::ChainType::Graphics ;
+      this->acquire_made  = false      ;
+      this->bundled       = false      ;
+      this->bundle_pass   = false      ;
+      this->multi_pass    = false      ;
+      this->supported     = GRAPHICS_STAGES ;
+      this->sync_made     = false      ;
+      this->frames        = COMMAND_BUFFER_COUNT ;
+      
+      this->timers_made      = false      ;
+      this->timestamp_period = 1.0f       ;
+      this->timestamp_mask   = UINT64_MAX ;
+    }
+    
+    vkg::Synchronization& ChainData::timeline()
+    {
+      if( !this->sync_made )
+      {
+        this->sync.setMakeFence( false                   ) ;
+        this->sync.setTimeline ( true                    ) ;
+        this->sync.initialize  ( this->queue.device(), 1 ) ;
+        this->sync_made = true ;
+      }
+      
+      return this->sync ;
+    }
+
+    Chain::Chain()
+    {
+      this->chain_data = new ChainData() ;
+    }
+
+    Chain::~Chain()
+    {
+      // Land any readbacks still in flight before their fences are destroyed.
+      for( const auto& readbacks : data().readbacks )
+      {
+        if( !readbacks.empty() )
+        {
+          this->synchronize() ;
+          break ;
+        }
+      }
+      
+      if( data().sync_made )
+      {
+        data().cmd.synchronize() ;
+        data().sync.reset() ;
+      }
+      
+      delete this->chain_data ;
+    }
+
+    void Chain::advance()
+    {
+      data().mutex.lock() ;
+      data().cmd.advance() ;
+      data().mutex.unlock() ;
+    }
+    
+    void Chain::initialize( const Chain& parent, unsigned subpass_id )
+    {
+      data().pass       = parent.data().pass            ;
+      data().parent     = const_cast<Chain*>( &parent ) ;
+      data().subpass_id = subpass_id                    ;
+      data().queue      = parent.data().queue           ;
+
+      data().cmd.initialize( parent.data().cmd ) ;
+    }
+    
+    void Chain::initialize( unsigned gpu, unsigned window_id )
+    {
+      if( Vulkan::hasWindow( window_id ) )
+      {
+        data().queue = Vulkan::presentQueue( window_id, gpu ) ;
+        data().cmd.initialize( data().queue, data().frames ) ;
+      }
+    }
+
+    void Chain::initialize( unsigned gpu, ChainType type )
+    {
+      this->reset() ;
+      data().select( gpu, type ) ;
+      data().cmd.initialize( data().queue, data().frames ) ;
+    }
+    
+    void Chain::initialize( const RenderPass& pass, ChainType type, bool multi_pass )
+    {
+      const unsigned gpu = pass.device() ;
+      this->reset() ;
+      data().pass       = &pass      ;
+      data().multi_pass = multi_pass ;
+      data().select( gpu, type ) ;
+      data().cmd.initialize( data().queue, data().frames, vkg::CommandBuffer::Level::Primary, multi_pass ) ;
+    }
+    
+    void Chain::initialize( const RenderPass& pass, unsigned window_id, bool multi_pass )
+    {
+      this->reset() ;
+      data().pass       = &pass      ;
+      data().multi_pass = multi_pass ;
+      if( Vulkan::hasWindow( window_id ) )
+      {
+        data().queue = Vulkan::presentQueue( window_id, pass.device()                                             ) ;
+        data().cmd.initialize( data().queue, data().frames, vkg::CommandBuffer::Level::Primary, multi_pass ) ;
+      }
+    }
+    
+    bool Chain::initialized() const 
+    {
+      return data().cmd.initialized() ;
+    }
+
+    const vkg::BindStats& Chain::bindStats() const
+    {
+      return data().target().bindStats() ;
+    }
+
+    unsigned Chain::device() const
+    {
+      return data().queue.device() ;
+    }
+
+    void Chain::transition( vkg::Image& image, nyx::ImageLayout layout )
+    {
+      data().record() ;
+      
+      // Queued instead of recorded, so it merges with the barriers of whatever is recorded next.
+      data().mutex.lock() ;
+      data().transition( image, Vulkan::convert( layout ) ) ;
+      data().dirty = true ;
+      data().mutex.unlock() ;
+    }
+
+    void Chain::setMode( nyx::ChainMode mode )
+    {
+      if( mode == nyx::ChainMode::All ) data().num_cmd = data().frames ;
+      else                              data().num_cmd = 1             ;
+      
+      data().bundled = mode == nyx::ChainMode::Once ;
+    }
+
+    void Chain::setFramesInFlight( unsigned count )
+    {
+      data().frames = std::max( 1u, std::min( count, MAX_FRAMES_IN_FLIGHT ) ) ;
+      if( data().num_cmd > 1 ) data().num_cmd = data().frames ;
+    }
+
+    void Chain::setTarget( nyx::ChainType type )
+    {
+      data().target_type = type ;
+    }
+    
+    unsigned Chain::framesInFlight() const
+    {
+      return data().parent != nullptr ? data().parent->framesInFlight() : data().frames ;
+    }
+    
+    float Chain::waitTime() const
+    {
+      return data().cmd.waitTime() ;
+    }
+    
+    void Chain::synchronize()
+    {
+      if( data().parent != nullptr )
+      {
+        data().parent->synchronize() ;
+        return ;
+      }
+      
+      if( this->initialized() ) 
+      {
+        // Only this chain's own submissions are waited on, never the rest of the queue's.
+        data().cmd.synchronize() ;
+        if( data().acquire_cmd.initialized() ) data().acquire_cmd.synchronize() ;
+        
+        data().mutex.lock() ;
+        for( auto& readbacks : data().readbacks )
+        {
+          for( const auto& readback : readbacks ) readback.finish() ;
+        }
+        
+        // Recorded but unsubmitted command buffers still hold their last submission's timestamps, so only resolve once all were submitted.
+        if( !data().dirty && !data().cmd.recording() )
+        {
+          for( unsigned index = 0; index < data().timers.size(); index++ )
+          {
+            if( data().resolve( index ) ) data().timers[ index ].clear() ;
+          }
+        }
+        data().mutex.unlock() ;
+      }
+    }
+    
+    void Chain::beginTimer( const char* name )
+    {
+      // Children & bundles are executed by other command buffers, which own the queries.
+      if( data().parent != nullptr || data().bundled ) return ;
+      
+      if( !data().timers_made )
+      {
+        const auto&    device   = Vulkan::device( data().queue.device() )                  ;
+        const auto     families = device.physicalDevice().getQueueFamilyProperties()       ;
+        const unsigned bits     = families[ data().queue.family() ].timestampValidBits     ;
+        
+        data().timers_made = true ;
+        
+        // Queues without valid timestamp bits can't be timed, so their timers are ignored.
+        if( bits != 0 )
+        {
+          data().timestamp_period = device.physicalDevice().getProperties().limits.timestampPeriod ;
+          data().timestamp_mask   = bits >= 64 ? UINT64_MAX : ( 1ull << bits ) - 1            ;
+          data().cmd.setTimestamps( TIMESTAMP_COUNT ) ;
+        }
+      }
+      
+      data().record() ;
+      
+      data().mutex.lock() ;
+      data().flush() ;
+      data().timestamp( name, false ) ;
+      data().open_timers.push_back( name ) ;
+      data().dirty = true ;
+      data().mutex.unlock() ;
+    }
+    
+    void Chain::endTimer()
+    {
+      if( data().open_timers.empty() ) return ;
+      
+      data().record() ;
+      
+      data().mutex.lock() ;
+      data().flush() ;
+      data().timestamp( data().open_timers.back(), true ) ;
+      data().open_timers.pop_back() ;
+      data().dirty = true ;
+      data().mutex.unlock() ;
+    }
+    
+    float Chain::timer( const char* name ) const
+    {
+      const auto iter = data().timings.find( name ) ;
+      
+      return iter != data().timings.end() ? iter->second : 0.0f ;
+    }
+
+    void Chain::submit()
+    {
+      nyx::TraceScope trace( "Chain::submit" ) ;
+      
+      this->end() ;
+
+      if( data().parent == nullptr && data().has_record && ( data().dirty || data().bundled ) )
+      {
+        if( data().bundled )
+        {
+          // Replays resubmit primaries that are never re-recorded, so wait on this one's previous submission.
+          data().cmd.wait() ;
+          data().release( data().cmd.current() ) ;
+        }
+        
+        data().acquireOwnership() ;
+        
+        data().mutex.lock() ;
+        data().submitReadbacks( data().cmd.fence() ) ;
+        data().timeline().advance() ;
+        if( data().timeline().timeline() ) data().queue.submit( data().cmd, data().timeline() ) ;
+        else                               data().queue.submit( data().cmd                    ) ;
+        data().timeline().clear() ;
+        data().current = data().cmd.current() ;
+        data().mutex.unlock() ;
+        data().publishOwnership() ;
+        data().dirty = false ;
+        if( data().pass != nullptr ) data().pass->advance() ;
+      }
+    }
+    
+    void Chain::submit( vkg::Chain* const* chains, unsigned count, const vk::Fence& fence )
+    {
+      std::vector<vkg::Chain*>                         staged    ;
+      std::vector<vk::CommandBuffer>                   buffers   ;
+      std::vector<vk::TimelineSemaphoreSubmitInfoKHR>  timelines ;
+      std::vector<vk::SubmitInfo>                      infos     ;
+      std::vector<std::vector<vk::PipelineStageFlags>> stages    ;
+      
+      if( count == 0 ) return ;
+      
+      vkg::Queue queue = chains[ 0 ]->data().queue ;
+      
+      for( unsigned index = 0; index < count; index++ )
+      {
+        vkg::Chain& chain = *chains[ index ] ;
+        
+        if( chain.data().queue.queue() != queue.queue() )
+        {
+          chain.submit() ;
+          continue ;
+        }
+        
+        chain.end() ;
+        
+        if( chain.data().parent == nullptr && chain.data().has_record && ( chain.data().dirty || chain.data().bundled ) )
+        {
+          if( chain.data().bundled )
+          {
+            chain.data().cmd.wait() ;
+            chain.data().release( chain.data().cmd.current() ) ;
+          }
+          
+          chain.data().acquireOwnership() ;
+          
+          // Held until the batch is submitted, so each chain's command buffer & timeline stay as staged.
+          chain.data().mutex.lock() ;
+          chain.data().submitReadbacks( fence ) ;
+          chain.data().timeline().advance() ;
+          staged.push_back( &chain ) ;
+        }
+      }
+      
+      buffers  .resize( staged.size() ) ;
+      timelines.resize( staged.size() ) ;
+      infos    .resize( staged.size() ) ;
+      stages   .resize( staged.size() ) ;
+      
+      for( unsigned index = 0; index < staged.size(); index++ )
+      {
+        const vkg::Synchronization& sync = staged[ index ]->data().timeline() ;
+        
+        // Each wait only blocks the stages this chain's queue type can run, never the host.
+        const vk::PipelineStageFlags wait_stages = staged[ index ]->data().supported & ~( Stage::eAllCommands | Stage::eHost ) ;
+        
+        buffers[ index ] = staged[ index ]->data().cmd.buffer() ;
+        stages [ index ].assign( sync.numWaitSems(), wait_stages ) ;
+        
+        infos[ index ].setCommandBufferCount( 1                 ) ;
+        infos[ index ].setPCommandBuffers   ( &buffers[ index ] ) ;
+        
+        if( sync.timeline() )
+        {
+          infos[ index ].setPSignalSemaphores   ( sync.signals()         ) ;
+          infos[ index ].setSignalSemaphoreCount( sync.numSignals()      ) ;
+          infos[ index ].setWaitSemaphoreCount  ( sync.numWaitSems()     ) ;
+          infos[ index ].setPWaitSemaphores     ( sync.waits()           ) ;
+          infos[ index ].setPWaitDstStageMask   ( stages[ index ].data() ) ;
+          
+          timelines[ index ].setSignalSemaphoreValueCount( sync.numSignals()   ) ;
+          timelines[ index ].setPSignalSemaphoreValues   ( sync.signalValues() ) ;
+          timelines[ index ].setWaitSemaphoreValueCount  ( sync.numWaitSems()  ) ;
+          timelines[ index ].setPWaitSemaphoreValues     ( sync.waitValues()   ) ;
+          infos[ index ].setPNext( &timelines[ index ] ) ;
+        }
+      }
+      
+      queue.submit( infos.data(), infos.size(), fence ) ;
       
-      dep_flags = vk::DependencyFlags()                    ;
-      src       = vk::PipelineStageFlagBits::eTopOfPipe    ;
-      dst       = vk::PipelineStageFlagBits::eBottomOfPipe ;
+      for( auto chain : staged )
+      {
+        chain->data().cmd.signalWith( fence ) ;
+        chain->data().cmd.advance() ;
+        chain->data().timeline().clear() ;
+        chain->data().current = chain->data().cmd.current() ;
+        chain->data().mutex.unlock() ;
+        chain->data().publishOwnership() ;
+        chain->data().dirty = false ;
+        if( chain->data().pass != nullptr ) chain->data().pass->advance() ;
+      }
+    }
+    
+    void Chain::waitOn( const vkg::Chain& chain, unsigned long long value )
+    {
+      // Children are submitted by their parents, so the dependency is between the parents' submissions.
+      const vkg::Chain& other = chain.data().parent != nullptr ? *chain.data().parent : chain ;
       
-      auto iter = data().image_barriers.end() ;
-           iter = data().image_barriers.insert( iter, { data().image_barriers.size(), barrier } ) ;
+      if( data().parent != nullptr )
+      {
+        data().parent->waitOn( other, value ) ;
+        return ;
+      }
       
-      data().record() ;
+      if( value == 0 ) value = other.signalValue() ;
+      if( value == 0 ) return ;
       
-      if( new_layout != vk::ImageLayout::eUndefined )
+      if( other.data().sync_made && other.data().sync.timeline() && data().timeline().timeline() )
       {
         data().mutex.lock() ;
-        
-        for( unsigned index = 0; index < data().num_cmd; index++ )
-        {
-          data().cmd.buffer().pipelineBarrier( src, dst, dep_flags, 0, nullptr, 0, nullptr, 1, &iter->second ) ;
-          data().cmd.advance() ;
-        }
-        
-        data().dirty = true ;
-        data().cmd.setActive( data().current ) ;
+        data().timeline().waitOn( other.data().sync, value ) ;
         data().mutex.unlock() ;
-        image.setLayout( Vulkan::convert( new_layout )  ) ;
+      }
+      else
+      {
+        // Without timeline semaphores the submissions can only be ordered on the host.
+        other.data().cmd.synchronize() ;
       }
     }
-
-    void Chain::setMode( nyx::ChainMode mode )
+    
+    bool Chain::isComplete() const
     {
-      if( mode == nyx::ChainMode::All ) data().num_cmd = COMMAND_BUFFER_COUNT ;
-      else                              data().num_cmd = 1                    ;
+      if( data().parent != nullptr ) return data().parent->isComplete() ;
+      if( !this->initialized()     ) return true                        ;
+      
+      return data().cmd.complete() && ( !data().acquire_cmd.initialized() || data().acquire_cmd.complete() ) ;
     }
-
-    void Chain::synchronize()
+    
+    unsigned long long Chain::signalValue() const
     {
-      if( this->initialized() ) data().queue.wait() ;
+      return data().sync_made ? data().sync.value() : 0 ;
     }
-
-    void Chain::submit()
+    
+    void Chain::reset()
     {
-      this->end() ;
+      // Nothing this chain submitted may still be in flight once it's command buffers are freed.
+      if( this->initialized() ) data().cmd.synchronize() ;
+      
+      if( this->initialized() && !data().staging.empty() )
+      {
+        for( unsigned index = 0; index < data().staging.size(); index++ ) data().release( index ) ;
+      }
+      
+      // Anything recorded but never submitted will never run.
+      for( const auto& readback : data().pending ) readback.cancel() ;
+      data().pending.clear() ;
 
-      if( data().parent == nullptr && data().has_record && data().dirty )
+      if( this->initialized() && !data().bundle_staging.empty() )
       {
-        data().mutex.lock() ;
-        data().queue.submit( data().cmd ) ;
-        data().current = data().cmd.current() ;
-        data().mutex.unlock() ;
-        data().dirty = false ;
-        if( data().pass != nullptr ) data().pass->advance() ;
+        data().releaseBundle() ;
       }
       
-      data().image_barriers .clear() ;
-      data().buffer_barriers.clear() ;
-    }
-    
-    void Chain::reset()
-    {
-      data().cmd .reset() ;
+      // Releases still waiting to be acquired completed above, so their acquires need not wait on this chain's timeline anymore.
+      ownership_mutex.lock() ;
+      for( auto& transfers : ownership_transfers )
+      {
+        for( auto& transfer : transfers.second )
+        {
+          if( transfer.owner == &data() ) { transfer.sync = vkg::Synchronization() ; transfer.value = 0 ; }
+        }
+      }
+      ownership_mutex.unlock() ;
+      
+      if( data().sync_made )
+      {
+        data().sync.reset() ;
+        data().sync_made = false ;
+      }
+      
+      if( data().acquire_cmd.initialized() )
+      {
+        data().acquire_cmd.synchronize() ;
+        data().acquire_cmd.reset() ;
+      }
+      
+      if( data().acquire_made )
+      {
+        data().acquire_sync.reset() ;
+        data().acquire_made = false ;
+      }
+      
+      data().cmd   .reset() ;
+      data().bundle.reset() ;
+      data().buffer_states  .clear() ;
+      data().image_states   .clear() ;
+      data().pending_buffers.clear() ;
+      data().pending_images .clear() ;
+      data().pending_src = vk::PipelineStageFlags() ;
+      data().pending_dst = vk::PipelineStageFlags() ;
       data().pass = nullptr ;
+      
+      data().timers     .clear() ;
+      data().open_timers.clear() ;
+      data().timings    .clear() ;
+      data().timers_made = false ;
     }
     
     void Chain::begin()
     {
+      nyx::TraceScope trace( "Chain::begin" ) ;
+      
       if( data().parent != nullptr )
       {
         data().cmd.advance() ;
@@ -381,25 +1728,25 @@ namespace nyx
       
       data().mutex.lock() ;
       data().record() ;
+      data().access( src, Stage::eTransfer, vk::AccessFlagBits::eTransferRead , false ) ;
+      data().access( dst, Stage::eTransfer, vk::AccessFlagBits::eTransferWrite, true  ) ;
+      data().flush () ;
       
       for( unsigned index = 0; index < data().num_cmd; index++ )
       {
-        data().cmd.buffer().copyImage( src.image(), src_layout, dst.image(), dst_layout, 1, &region ) ;
-        data().cmd.advance() ;
+        data().target().buffer().copyImage( src.image(), src_layout, dst.image(), dst_layout, 1, &region ) ;
+        data().target().advance() ;
       }
       
-      data().cmd.setActive( data().current ) ;
+      data().target().setActive( data().current ) ;
       data().dirty = true ;
       data().mutex.unlock() ;
+      data().written( dst ) ;
     }
     
     void Chain::copy( const vkg::Buffer& src, vkg::Buffer& dst, unsigned copy_amt, unsigned element_size, unsigned src_offset, unsigned dst_offset )
     {
-      vk::BufferCopy    region  ;
-      vk::MemoryBarrier barrier ;
-      
-      barrier.setSrcAccessMask( vk::AccessFlagBits::eMemoryRead  ) ;
-      barrier.setDstAccessMask( vk::AccessFlagBits::eMemoryWrite ) ;
+      vk::BufferCopy region ;
       
       region.setSize     ( copy_amt * element_size ) ;
       region.setSrcOffset( src_offset              ) ;
@@ -407,75 +1754,219 @@ namespace nyx
 
       data().mutex.lock() ;
       data().record() ;
+      data().access( src, Stage::eTransfer, vk::AccessFlagBits::eTransferRead , false ) ;
+      data().access( dst, Stage::eTransfer, vk::AccessFlagBits::eTransferWrite, true  ) ;
+      data().flush () ;
       
       for( unsigned index = 0; index < data().num_cmd; index++ )
       {
-        data().cmd.buffer().copyBuffer( src.buffer(), dst.buffer(), 1, &region ) ;
-        data().cmd.advance() ;
+        data().target().buffer().copyBuffer( src.buffer(), dst.buffer(), 1, &region ) ;
+        data().target().advance() ;
       }
       
-      data().cmd.setActive( data().current ) ;
+      data().target().setActive( data().current ) ;
       data().dirty = true ;
       data().mutex.unlock() ;
+      data().written( dst ) ;
     }
     
     void Chain::copy( const void* src, vkg::Buffer& dst, unsigned copy_amt, unsigned element_size, unsigned src_offset, unsigned dst_offset )
     {
       const unsigned byte_size = copy_amt * element_size ;
-
-      StagingBuffer*       buffer = data().findStaging() ;
-      vkg::Buffer&         tmp    = buffer->buffer       ;
-      nyx::Memory<Vulkan>& memory = tmp.memory()         ;
+      StagingRegion  region    ;
+      unsigned       chunk     ;
       
-      memory.copyToDevice( src, byte_size, src_offset, 0 ) ;
-      this->copy( buffer->buffer, dst, copy_amt, element_size, 0, dst_offset ) ;
-      buffer->unlock() ;
+      // Split large uploads so no single copy needs more than a chunk of staging memory.
+      for( unsigned done = 0; done < byte_size; done += chunk )
+      {
+        chunk  = static_cast<unsigned>( std::min<unsigned long long>( byte_size - done, STAGING_CHUNK_SIZE ) ) ;
+        region = data().stage( chunk ) ;
+        
+        region.segment->buffer.memory().copyToDevice( src, chunk, src_offset + done, region.offset ) ;
+        this->copy( region.segment->buffer, dst, chunk, 1, region.offset, dst_offset + done ) ;
+      }
     }
     
     void Chain::copy( const void* src, vkg::Image& dst )
     {
-      const unsigned byte_size = dst.byteSize() ;
+      const unsigned             byte_size  = dst.byteSize()                                                                     ;
+      const unsigned             row_size   = std::max( byte_size / ( dst.height() * dst.layers() ), 1u )                       ;
+      const unsigned             row_count  = std::max( static_cast<unsigned>( STAGING_CHUNK_SIZE ) / row_size, 1u )            ;
+      const nyx::ImageLayout     old_layout = dst.layout()                                                                       ;
+      vk::BufferImageCopy        info       ;
+      vk::ImageSubresourceLayers layers     ;
+      StagingRegion              region     ;
+      unsigned                   rows       ;
+      
+      if( byte_size <= STAGING_CHUNK_SIZE )
+      {
+        region = data().stage( byte_size ) ;
+        
+        region.segment->buffer.memory().copyToDevice( src, byte_size, 0, region.offset ) ;
+        this->copy( region.segment->buffer, dst, byte_size, 1, region.offset, 0 ) ;
+        return ;
+      }
       
-      StagingBuffer*       buffer = data().findStaging() ;
-      vkg::Buffer&         tmp    = buffer->buffer       ;
-      nyx::Memory<Vulkan>& memory = tmp.memory()         ;
+      // Split large images into bands of rows, one layer at a time.
+      this->transition( dst, nyx::ImageLayout::TransferDst ) ;
+      
+      // The bands never overlap, so only the first one has to wait on anything.
+      data().mutex.lock() ;
+      data().record() ;
+      data().access( dst, Stage::eTransfer, vk::AccessFlagBits::eTransferWrite, true ) ;
+      data().flush () ;
+      data().mutex.unlock() ;
+      
+      layers = dst.subresource() ;
+      layers.setLayerCount( 1 ) ;
+
+      for( unsigned layer = 0; layer < dst.layers(); layer++ )
+      {
+        for( unsigned row = 0; row < dst.height(); row += rows )
+        {
+          rows   = std::min( row_count, dst.height() - row ) ;
+          region = data().stage( rows * row_size )          ;
+          
+          region.segment->buffer.memory().copyToDevice( src, rows * row_size, ( layer * dst.height() + row ) * row_size, region.offset ) ;
+          
+          layers.setBaseArrayLayer( layer ) ;
+          info.setBufferOffset     ( region.offset                                       ) ;
+          info.setImageSubresource ( layers                                              ) ;
+          info.setImageOffset      ( vk::Offset3D( 0, static_cast<int32_t>( row ), 0 )   ) ;
+          info.setImageExtent      ( vk::Extent3D( dst.width(), rows, 1 )                ) ;
+          
+          data().mutex.lock() ;
+          data().record() ;
+          
+          for( unsigned index = 0; index < data().num_cmd; index++ )
+          {
+            data().target().buffer().copyBufferToImage( region.segment->buffer.buffer(), dst.image(), vk::ImageLayout::eTransferDstOptimal, 1, &info ) ;
+            data().target().advance() ;
+          }
+          
+          data().target().setActive( data().current ) ;
+          data().dirty = true ;
+          data().mutex.unlock() ;
+        }
+      }
       
-      memory.copyToDevice( src, byte_size, 0, 0 ) ;
-      this->copy( buffer->buffer, dst, byte_size, 1, 0, 0 ) ;
-      buffer->unlock() ;
+      this->transition( dst, old_layout ) ;
+      data().written  ( dst             ) ;
     }
     
     void Chain::copy( const vkg::Buffer& src, void* dst, unsigned copy_amt, unsigned element_size, unsigned src_offset, unsigned dst_offset )
     {
-      const unsigned byte_size = copy_amt * element_size ;
-
-      StagingBuffer*       buffer   = data().findStaging()                                   ;
-      vkg::Buffer&         tmp      = buffer->buffer                                         ;
-      nyx::Memory<Vulkan>& memory   = tmp.memory()                                           ;
-      const unsigned char* host_mem = static_cast<const unsigned char*>( memory.hostData() ) ;
+      this->readback( src, dst, copy_amt, element_size, src_offset, dst_offset ) ;
+    }
+    
+    void Chain::copy( const vkg::Image& src, void* dst )
+    {
+      this->readback( src, dst ) ;
+    }
+    
+    vkg::Readback Chain::readback( const vkg::Buffer& src, void* dst, unsigned copy_amt, unsigned element_size, unsigned src_offset, unsigned dst_offset )
+    {
+      const unsigned byte_size = copy_amt * element_size                       ;
+      unsigned char* host      = static_cast<unsigned char*>( dst ) + dst_offset ;
+      StagingRegion  region    ;
+      vkg::Readback  readback  ;
+      unsigned       chunk     ;
+      
+      // Split large readbacks the same way as uploads. Every chunk lands in the same submission, so one readback tracks them all.
+      for( unsigned done = 0; done < byte_size; done += chunk )
+      {
+        chunk  = static_cast<unsigned>( std::min<unsigned long long>( byte_size - done, STAGING_CHUNK_SIZE ) ) ;
+        region = data().stage( chunk ) ;
+        
+        this->copy( src, region.segment->buffer, chunk, 1, src_offset + done, region.offset ) ;
+        
+        const unsigned char* staging = static_cast<const unsigned char*>( region.segment->buffer.memory().memory().mapped() ) + region.offset ;
+        
+        if( done == 0 ) readback.initialize( staging, host + done, chunk ) ;
+        else            readback.append    ( staging, host + done, chunk ) ;
+      }
       
+      if( !readback.initialized() ) readback.initialize( nullptr, host, 0 ) ;
       
-      this->copy( src, buffer->buffer, copy_amt, element_size, src_offset, dst_offset ) ;
-      Vulkan::deviceSynchronize( src.device() ) ;
-      memory.syncToHost() ;
-      std::copy( host_mem, host_mem + byte_size, static_cast<unsigned char*>( dst ) ) ;
-      buffer->unlock() ;
+      data().mutex.lock() ;
+      data().pending.push_back( readback ) ;
+      data().mutex.unlock() ;
+      
+      return readback ;
     }
     
-    void Chain::copy( const vkg::Image& src, void* dst )
+    vkg::Readback Chain::readback( const vkg::Image& src, void* dst )
     {
-      const unsigned byte_size = src.byteSize() ;
+      const unsigned             byte_size = src.byteSize()                                                          ;
+      const unsigned             row_size  = std::max( byte_size / ( src.height() * src.layers() ), 1u )            ;
+      const unsigned             row_count = std::max( static_cast<unsigned>( STAGING_CHUNK_SIZE ) / row_size, 1u ) ;
+      unsigned char*             host      = static_cast<unsigned char*>( dst )                                      ;
+      vk::BufferImageCopy        info      ;
+      vk::ImageSubresourceLayers layers    ;
+      StagingRegion              region    ;
+      vkg::Readback              readback  ;
+      unsigned                   rows      ;
+      
+      if( byte_size <= STAGING_CHUNK_SIZE )
+      {
+        region = data().stage( byte_size ) ;
+        
+        this->copy( src, region.segment->buffer, byte_size, 0, region.offset ) ;
+        readback.initialize( static_cast<const unsigned char*>( region.segment->buffer.memory().memory().mapped() ) + region.offset, dst, byte_size ) ;
+      }
+      else
+      {
+        // Split large images into bands of rows, one layer at a time, as uploads do.
+        data().mutex.lock() ;
+        data().record() ;
+        data().access( src, Stage::eTransfer, vk::AccessFlagBits::eTransferRead, false ) ;
+        data().flush () ;
+        data().mutex.unlock() ;
+        
+        layers = src.subresource() ;
+        layers.setLayerCount( 1 ) ;
+        
+        for( unsigned layer = 0; layer < src.layers(); layer++ )
+        {
+          for( unsigned row = 0; row < src.height(); row += rows )
+          {
+            const unsigned long long offset = static_cast<unsigned long long>( layer * src.height() + row ) * row_size ;
+            
+            rows   = std::min( row_count, src.height() - row ) ;
+            region = data().stage( rows * row_size )          ;
+            
+            layers.setBaseArrayLayer( layer ) ;
+            info.setBufferOffset     ( region.offset                                     ) ;
+            info.setImageSubresource ( layers                                            ) ;
+            info.setImageOffset      ( vk::Offset3D( 0, static_cast<int32_t>( row ), 0 ) ) ;
+            info.setImageExtent      ( vk::Extent3D( src.width(), rows, 1 )              ) ;
+            
+            data().mutex.lock() ;
+            data().record() ;
+            
+            for( unsigned index = 0; index < data().num_cmd; index++ )
+            {
+              data().target().buffer().copyImageToBuffer( src.image(), vk::ImageLayout::eTransferSrcOptimal, region.segment->buffer.buffer(), 1, &info ) ;
+              data().target().advance() ;
+            }
+            
+            data().target().setActive( data().current ) ;
+            data().dirty = true ;
+            data().mutex.unlock() ;
+            
+            const unsigned char* staging = static_cast<const unsigned char*>( region.segment->buffer.memory().memory().mapped() ) + region.offset ;
+            
+            if( offset == 0 ) readback.initialize( staging, host + offset, rows * row_size ) ;
+            else              readback.append    ( staging, host + offset, rows * row_size ) ;
+          }
+        }
+      }
       
-      StagingBuffer*       buffer   = data().findStaging()                                   ;
-      vkg::Buffer&         tmp      = buffer->buffer                                         ;
-      nyx::Memory<Vulkan>& memory   = tmp.memory()                                           ;
-      const unsigned char* host_mem = static_cast<const unsigned char*>( memory.hostData() ) ;
+      data().mutex.lock() ;
+      data().pending.push_back( readback ) ;
+      data().mutex.unlock() ;
       
-      this->copy( src, buffer->buffer ) ;
-      Vulkan::deviceSynchronize( data().cmd.device() ) ;
-      memory.syncToHost() ;
-      std::copy( host_mem, host_mem + byte_size, static_cast<unsigned char*>( dst ) ) ;
-      buffer->unlock() ;
+      return readback ;
     }
     
     void Chain::copy( const vkg::Image& src, vkg::Buffer& dst, unsigned copy_amt, unsigned src_offset, unsigned dst_offset )
@@ -490,7 +1981,7 @@ namespace nyx
       info.setImageExtent      ( extent            ) ;
       info.setBufferImageHeight( 0                 ) ;
       info.setBufferRowLength  ( 0                 ) ;
-      info.setImageOffset      ( dst_offset        ) ;
+      info.setBufferOffset     ( dst_offset        ) ;
       info.setImageSubresource ( src.subresource() ) ;
       
       // In case we need in the future.
@@ -499,16 +1990,20 @@ namespace nyx
 
       data().mutex.lock() ;
       data().record() ;
+      data().access( src, Stage::eTransfer, vk::AccessFlagBits::eTransferRead , false ) ;
+      data().access( dst, Stage::eTransfer, vk::AccessFlagBits::eTransferWrite, true  ) ;
+      data().flush () ;
       
       for( unsigned index = 0; index < data().num_cmd; index++ )
       {
-        data().cmd.buffer().copyImageToBuffer( src.image(), vk::ImageLayout::eTransferSrcOptimal, dst.buffer(), 1, &info ) ;
-        data().cmd.advance() ;
+        data().target().buffer().copyImageToBuffer( src.image(), vk::ImageLayout::eTransferSrcOptimal, dst.buffer(), 1, &info ) ;
+        data().target().advance() ;
       }
       
-      data().cmd.setActive( data().current ) ;
+      data().target().setActive( data().current ) ;
       data().dirty = true ;
       data().mutex.unlock() ;
+      data().written( dst ) ;
     }
     
     void Chain::copy( const vkg::Buffer& src, vkg::Image& dst, unsigned copy_amt, unsigned element_size, unsigned src_offset, unsigned dst_offset )
@@ -526,27 +2021,31 @@ namespace nyx
       info.setImageExtent      ( extent            ) ;
       info.setBufferImageHeight( 0                 ) ;
       info.setBufferRowLength  ( 0                 ) ;
+      info.setBufferOffset     ( src_offset        ) ;
       info.setImageOffset      ( dst_offset        ) ;
       info.setImageSubresource ( dst.subresource() ) ;
       
       // In case we need in the future.
-      src_offset   = src_offset   ;
       copy_amt     = copy_amt     ;
       element_size = element_size ;
 
       this->transition ( dst, nyx::ImageLayout::TransferDst ) ;
       data().mutex.lock() ;
+      data().access( src, Stage::eTransfer, vk::AccessFlagBits::eTransferRead , false ) ;
+      data().access( dst, Stage::eTransfer, vk::AccessFlagBits::eTransferWrite, true  ) ;
+      data().flush () ;
       
       for( unsigned index = 0; index < data().num_cmd; index++ )
       {
-        data().cmd.buffer().copyBufferToImage( src.buffer(), dst.image(), vk::ImageLayout::eTransferDstOptimal, 1, &info ) ;
-        data().cmd.advance() ;
+        data().target().buffer().copyBufferToImage( src.buffer(), dst.image(), vk::ImageLayout::eTransferDstOptimal, 1, &info ) ;
+        data().target().advance() ;
       }
       
-      data().cmd.setActive( data().current ) ;
+      data().target().setActive( data().current ) ;
       data().dirty = true ;
       data().mutex.unlock() ;
       this->transition ( dst, old_layout ) ;
+      data().written   ( dst             ) ;
     }
     
     void Chain::combine( const vkg::Chain& chain )
@@ -556,6 +2055,7 @@ namespace nyx
       if( data().parent == nullptr && chain.data().parent == this && !chain.data().cmd.recording() ) 
       {
         data().mutex.lock() ;
+        data().flush() ;
         data().has_record = true ;
       
         subpass = 0 ;
@@ -582,21 +2082,61 @@ namespace nyx
       }
     }
 
+    void Chain::execute( const vkg::Chain& child )
+    {
+      ChainData::Regions& staging = data().staging ;
+
+      if( data().parent == nullptr && child.data().parent == this && !child.data().cmd.recording() ) 
+      {
+        data().record( true ) ;
+        data().mutex.lock() ;
+        data().flush() ;
+        data().has_record = true ;
+        
+        for( unsigned index = 0; index < data().num_cmd; index++ )
+        {
+          data().cmd.combine( child.data().cmd ) ;
+          data().cmd.advance() ;
+        }
+        
+        data().cmd.setActive( data().current ) ;
+        
+        // The child's staging now lives as long as the command buffers it was combined into. Each region holds a reference per command buffer, so they are spread the same way the child staged them.
+        if( staging.size() < data().cmd.size() ) staging.resize( data().cmd.size() ) ;
+        for( unsigned index = 0; index < child.data().staging.size(); index++ )
+        {
+          auto& regions = child.data().staging[ ( child.data().current + index ) % child.data().staging.size() ] ;
+          auto& target  = staging[ ( data().current + index ) % staging.size() ]                              ;
+          
+          target.insert( target.end(), regions.begin(), regions.end() ) ;
+          regions.clear() ;
+        }
+        
+        data().pending.insert( data().pending.end(), child.data().pending.begin(), child.data().pending.end() ) ;
+        child.data().pending.clear() ;
+        
+        data().dirty = true ;
+        data().mutex.unlock() ;
+      }
+    }
+
     void Chain::drawBase( const vkg::Renderer& renderer, const vkg::Buffer& vertices, unsigned count, unsigned offset )
     {
       data().record( true ) ;
       data().has_record = true ;
       data().mutex.lock() ;
+      data().flush() ;
+      data().touch( vertices, Stage::eVertexInput ) ;
       
       for( unsigned index = 0; index < data().num_cmd; index++ )
       {
-        data().cmd.bind    ( renderer.pipeline()     ) ;
-        data().cmd.bind    ( renderer.descriptor()   ) ;
-        data().cmd.drawBase( vertices, count, offset ) ;
-        data().cmd.advance () ;
+        data().target().bind    ( renderer.pipeline()     ) ;
+        data().target().bind    ( renderer.descriptor( data().target() ) ) ;
+        data().target().drawBase( vertices, count, offset ) ;
+        data().target().advance () ;
       }
       
-      data().cmd.setActive( data().current ) ;
+      data().target().setActive( data().current ) ;
       data().dirty = true ;
       data().mutex.unlock() ;
     }
@@ -606,15 +2146,18 @@ namespace nyx
       data().record( true ) ;
       data().has_record = true ;
       data().mutex.lock() ;
+      data().flush() ;
+      data().touch( indices , Stage::eVertexInput ) ;
+      data().touch( vertices, Stage::eVertexInput ) ;
       
       for( unsigned index = 0; index < data().num_cmd; index++ )
       {
-        data().cmd.bind    ( renderer.pipeline()     ) ;
-        data().cmd.bind    ( renderer.descriptor()   ) ;
-        data().cmd.drawIndexedBase( indices, vertices, index_count, vertex_count ) ;
-        data().cmd.advance () ;
+        data().target().bind    ( renderer.pipeline()     ) ;
+        data().target().bind    ( renderer.descriptor( data().target() ) ) ;
+        data().target().drawIndexedBase( indices, vertices, index_count, vertex_count ) ;
+        data().target().advance () ;
       }
-      data().cmd.setActive( data().current ) ;
+      data().target().setActive( data().current ) ;
       data().dirty = true ;
       data().mutex.unlock() ;
     }
@@ -625,15 +2168,18 @@ namespace nyx
       data().record( true ) ;
       data().has_record = true ;
       data().mutex.lock() ;
+      data().flush() ;
+      data().touch( indices , Stage::eVertexInput ) ;
+      data().touch( vertices, Stage::eVertexInput ) ;
       
       for( unsigned index = 0; index < data().num_cmd; index++ )
       {
-        data().cmd.bind    ( renderer.pipeline()     ) ;
-        data().cmd.bind    ( renderer.descriptor()   ) ;
-        data().cmd.drawInstanced( indices, index_count, vertices, vertex_count, instance_count ) ;
-        data().cmd.advance () ;
+        data().target().bind    ( renderer.pipeline()     ) ;
+        data().target().bind    ( renderer.descriptor( data().target() ) ) ;
+        data().target().drawInstanced( indices, index_count, vertices, vertex_count, instance_count ) ;
+        data().target().advance () ;
       }
-      data().cmd.setActive( data().current ) ;
+      data().target().setActive( data().current ) ;
       data().dirty = true ;
       data().mutex.unlock() ;
     }
@@ -643,24 +2189,67 @@ namespace nyx
       data().record( true ) ;
       data().has_record = true ;
       data().mutex.lock() ;
+      data().flush() ;
+      data().touch( vertices, Stage::eVertexInput ) ;
+      
+      for( unsigned index = 0; index < data().num_cmd; index++ )
+      {
+        data().target().bind    ( renderer.pipeline()     ) ;
+        data().target().bind    ( renderer.descriptor( data().target() ) ) ;
+        data().target().drawInstanced( vertices, vertex_count, instanced_count ) ;
+        data().target().advance () ;
+      }
+      data().target().setActive( data().current ) ;
+      data().dirty = true ;
+      data().mutex.unlock() ;
+    }
+
+    void Chain::drawIndirectBase( const vkg::Renderer& renderer, const vkg::Buffer* indices, const vkg::Buffer& vertices, const vkg::Buffer& arguments, unsigned offset, unsigned draw_count, unsigned stride, const vkg::Buffer* count )
+    {
+      if( count && !Vulkan::device( data().queue.device() ).hasExtension( VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME ) )
+      {
+        Vulkan::add( Vulkan::Error::ExtensionNotPresent ) ;
+        return ;
+      }
+      
+      data().record( true ) ;
+      data().has_record = true ;
+      data().mutex.lock() ;
+      data().flush() ;
+      data().touch( vertices , Stage::eVertexInput  ) ;
+      data().touch( arguments, Stage::eDrawIndirect ) ;
+      if( indices ) data().touch( *indices, Stage::eVertexInput  ) ;
+      if( count   ) data().touch( *count  , Stage::eDrawIndirect ) ;
       
       for( unsigned index = 0; index < data().num_cmd; index++ )
       {
-        data().cmd.bind    ( renderer.pipeline()     ) ;
-        data().cmd.bind    ( renderer.descriptor()   ) ;
-        data().cmd.drawInstanced( vertices, vertex_count, instanced_count ) ;
-        data().cmd.advance () ;
+        data().target().bind        ( renderer.pipeline()                                                ) ;
+        data().target().bind        ( renderer.descriptor( data().target() )                             ) ;
+        data().target().drawIndirect( indices, vertices, arguments, offset, draw_count, stride, count ) ;
+        data().target().advance     () ;
       }
-      data().cmd.setActive( data().current ) ;
+      
+      data().target().setActive( data().current ) ;
       data().dirty = true ;
       data().mutex.unlock() ;
     }
 
     void Chain::end()
     {
-      if( data().cmd.recording() )
+      nyx::TraceScope trace( "Chain::end" ) ;
+      
+      if( data().bundled )
+      {
+        data().mutex.lock() ;
+        if( data().bundle.recording() ) data().flush() ;
+        data().replay() ;
+        data().mutex.unlock() ;
+      }
+      else if( data().cmd.recording() )
       {
         data().mutex.lock() ;
+        data().flush() ;
+        data().releaseOwnership() ;
         
         for( unsigned index = 0; index < data().num_cmd; index++ )
         {
@@ -677,83 +2266,145 @@ namespace nyx
     
     void Chain::memoryBarrier( const vkg::Buffer& src, const vkg::Buffer& dst )
     {
-      const auto src_flag  = vk::PipelineStageFlagBits::eAllCommands ;
-      const auto dst_flag  = vk::PipelineStageFlagBits::eAllCommands ;
-      const auto dep_flags = vk::DependencyFlags()                   ;
-      
-      vk::BufferMemoryBarrier barrier ;
-      
       dst.buffer() ;
-      barrier.setBuffer       ( src.buffer()                     ) ;
-      barrier.setSize         ( VK_WHOLE_SIZE                    ) ;
-      barrier.setSrcAccessMask( vk::AccessFlagBits::eMemoryWrite ) ;
-      barrier.setDstAccessMask( vk::AccessFlagBits::eMemoryRead  ) ;
-      
       data().mutex.lock() ;
       data().record() ;
-      
-      auto iter = data().buffer_barriers.end()                                                      ;
-           iter = data().buffer_barriers.insert( iter, { data().buffer_barriers.size(), barrier } ) ;
+      data().barrier( src ) ;
+      data().dirty = true ;
+      data().mutex.unlock() ;
+    }
+    
+    void Chain::pipelineBarrier( nyx::GPUStages src, nyx::GPUStages dst )
+    {
+      data().mutex.lock() ;
+      data().record() ;
+      data().pending_src |= data().stages( Vulkan::convert( src ) ) ;
+      data().pending_dst |= data().stages( Vulkan::convert( dst ) ) ;
+      data().dirty = true ;
+      data().mutex.unlock() ;
+    }
+    
+    void Chain::memoryBarrier( const vkg::Buffer& src, const vkg::Image& dst )
+    {
+      dst.size() ;
+      data().mutex.lock() ;
+      data().record() ;
+      data().barrier( src ) ;
+      data().dirty = true ;
+      data().mutex.unlock() ;
+    }
+    
+    void Chain::dispatch( const vkg::Computer& computer, unsigned x, unsigned y, unsigned z )
+    {
+      const unsigned group_x = ( x + computer.workgroupSize( 0 ) - 1 ) / computer.workgroupSize( 0 ) ;
+      const unsigned group_y = ( y + computer.workgroupSize( 1 ) - 1 ) / computer.workgroupSize( 1 ) ;
+      const unsigned group_z = ( z + computer.workgroupSize( 2 ) - 1 ) / computer.workgroupSize( 2 ) ;
 
+      data().record() ;
+      data().has_record = true ;
+      data().mutex.lock() ;
+      
+      data().access( computer ) ;
+      data().flush() ;
+      
       for( unsigned index = 0; index < data().num_cmd; index++ )
       {
-        data().cmd.buffer().pipelineBarrier( src_flag, dst_flag, dep_flags, 0, nullptr, 1, &iter->second, 0, nullptr ) ;
-        data().cmd.advance() ;
+        data().target().bind    ( computer.pipeline()                              ) ;
+        data().target().bind    ( computer.descriptor( data().target() )           ) ;
+        data().target().dispatch( group_x, group_y, group_z                        ) ;
+        data().target().advance () ;
       }
-
+      
+      data().target().setActive( data().current ) ;
       data().dirty = true ;
-      data().cmd.setActive( data().current ) ;
       data().mutex.unlock() ;
     }
     
-    void Chain::pipelineBarrier( nyx::GPUStages src, nyx::GPUStages dst )
+    void Chain::dispatchIndirectBase( const vkg::Computer& computer, const vkg::Buffer& arguments, unsigned offset )
     {
-      auto m_src = Vulkan::convert( src ) ;
-      auto m_dst = Vulkan::convert( dst ) ;
-
-      const auto dep_flags = vk::DependencyFlags() ;
-      data().mutex.lock() ;
       data().record() ;
+      data().has_record = true ;
+      data().mutex.lock() ;
+      
+      data().access( arguments, Stage::eDrawIndirect, vk::AccessFlagBits::eIndirectCommandRead, false ) ;
+      data().access( computer ) ;
+      data().flush() ;
+      
       for( unsigned index = 0; index < data().num_cmd; index++ )
       {
-        data().cmd.buffer().pipelineBarrier( m_src, m_dst, dep_flags, 0, nullptr, 0, nullptr, 0, nullptr ) ;
-        data().cmd.advance() ;
+        data().target().bind            ( computer.pipeline()                              ) ;
+        data().target().bind            ( computer.descriptor( data().target() )           ) ;
+        data().target().dispatchIndirect( arguments, offset                                ) ;
+        data().target().advance         () ;
       }
-
+      
+      data().target().setActive( data().current ) ;
       data().dirty = true ;
-      data().cmd.setActive( data().current ) ;
       data().mutex.unlock() ;
     }
     
-    void Chain::memoryBarrier( const vkg::Buffer& src, const vkg::Image& dst )
+    void Chain::pushBase( const Computer& computer, const void* value, unsigned byte_size, unsigned offset )
     {
       data().mutex.lock() ;
-      data().record() ;
+      data().record( data().pass != nullptr ) ;
+      
+      for( unsigned index = 0; index < data().num_cmd; index++ )
+      {
+        data().target().bind( computer.pipeline()                  ) ;
+        data().target().pushConstantBase( value, byte_size, offset ) ;
+        data().target().advance() ;
+      }
+
+      data().target().setActive( data().current ) ;
+      data().dirty = true ;
+      data().mutex.unlock() ;
+    }
 
+    void Chain::pushBase( const Renderer& pipeline, const void* value, unsigned byte_size, unsigned offset )
+    {
+      data().mutex.lock() ;
+      data().record( data().pass != nullptr ) ;
+      
       for( unsigned index = 0; index < data().num_cmd; index++ )
       {
-        data().cmd.barrier( src, dst ) ;
-        data().cmd.advance() ;
+        data().target().bind( pipeline.pipeline()                  ) ;
+        data().target().pushConstantBase( value, byte_size, offset ) ;
+        data().target().advance() ;
       }
+
+      data().target().setActive( data().current ) ;
+      data().dirty = true ;
+      data().mutex.unlock() ;
+    }
+
+    void Chain::setViewport( const nyx::Viewport& viewport )
+    {
+      data().mutex.lock() ;
+      data().record( data().pass != nullptr ) ;
       
+      for( unsigned index = 0; index < data().num_cmd; index++ )
+      {
+        data().target().setViewport( viewport ) ;
+        data().target().advance() ;
+      }
+
+      data().target().setActive( data().current ) ;
       data().dirty = true ;
-      data().cmd.setActive( data().current ) ;
       data().mutex.unlock() ;
     }
-    
-    void Chain::pushBase( const Renderer& pipeline, const void* value, unsigned byte_size, unsigned offset )
+
+    void Chain::setScissor( int x, int y, unsigned width, unsigned height )
     {
       data().mutex.lock() ;
       data().record( data().pass != nullptr ) ;
       
       for( unsigned index = 0; index < data().num_cmd; index++ )
       {
-        data().cmd.bind( pipeline.pipeline()                  ) ;
-        data().cmd.pushConstantBase( value, byte_size, offset ) ;
-        data().cmd.advance() ;
+        data().target().setScissor( x, y, width, height ) ;
+        data().target().advance() ;
       }
 
-      data().cmd.setActive( data().current ) ;
+      data().target().setActive( data().current ) ;
       data().dirty = true ;
       data().mutex.unlock() ;
     }
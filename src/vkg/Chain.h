@@ -25,6 +25,7 @@
 #pragma once
 
 #include "Buffer.h"
+#include "Readback.h"
 
 namespace nyx
 {
@@ -37,6 +38,8 @@ namespace nyx
   template<typename Framework>
   class Renderer ;
   
+  class Viewport ;
+  
   enum class ChainMode     : unsigned ;
   enum class ChainType     : unsigned ;
   enum class GPUStages     : unsigned ;
@@ -49,7 +52,10 @@ namespace nyx
     class Image      ;
     class Vulkan     ;
     class Renderer   ;
+    class Computer   ;
     class RenderPass ;
+    class Batch      ;
+    struct BindStats ;
     
     /** Class to handle recording operations to perform on the GPU.
      */
@@ -69,7 +75,9 @@ namespace nyx
         void advance() ;
 
         /** Method to initialize this chain as a child of the input.
+         * @note Children allocate from the calling thread's command pool, so initialize a child on the thread that records it.
          * @param parent The chain to initialize this object off of.
+         * @param subpass_id The subpass of the parent's render pass this child records to.
          */
         void initialize( const Chain& parent, unsigned subpass_id ) ;
         
@@ -189,6 +197,13 @@ namespace nyx
          * @param chain
          */
         void combine( const vkg::Chain& chain ) ;
+        
+        /** Method to execute a child chain's finished recording in this object's current subpass.
+         * Children can be recorded in parallel, one per thread, and are executed in the order this is called.
+         * @note Within a render pass, this object must be initialized as multi-pass.
+         * @param child The child chain to execute. Must be done recording.
+         */
+        void execute( const vkg::Chain& child ) ;
 
         /** Method to append a draw command to this object.
          * @param array The array of vertices to draw.
@@ -218,6 +233,72 @@ namespace nyx
         template<typename Type>
         void drawInstanced( unsigned instance_count, const vkg::Renderer& renderer, const Array<Vulkan, Type>& vertices ) ;
         
+        /** Method to append draw commands whose parameters are read from a GPU array to this object.
+         * @note Each element of the arguments array is a nyx::DrawIndirectArguments, or a type with the same leading layout.
+         * @param vertices The array of vertices used for drawing.
+         * @param arguments The array of draw parameters. Must be created with nyx::ArrayFlags::Indirect.
+         * @param draw_count The amount of draws to perform. Defaults to one per element of the arguments array.
+         * @param offset The offset, in elements, of the first draw's parameters in the arguments array.
+         */
+        template<typename Type, typename Arguments>
+        void drawIndirect( const vkg::Renderer& renderer, const Array<Vulkan, Type>& vertices, const Array<Vulkan, Arguments>& arguments, unsigned draw_count = 0, unsigned offset = 0 ) ;
+        
+        /** Method to append indexed draw commands whose parameters are read from a GPU array to this object.
+         * @note Each element of the arguments array is a nyx::DrawIndexedIndirectArguments, or a type with the same leading layout.
+         * @param indices The index array describing the render order of the vertex array.
+         * @param vertices The array of vertices used for drawing.
+         * @param arguments The array of draw parameters. Must be created with nyx::ArrayFlags::Indirect.
+         * @param draw_count The amount of draws to perform. Defaults to one per element of the arguments array.
+         * @param offset The offset, in elements, of the first draw's parameters in the arguments array.
+         */
+        template<typename Type, typename Type2, typename Arguments>
+        void drawIndexedIndirect( const vkg::Renderer& renderer, const Array<Vulkan, Type2>& indices, const Array<Vulkan, Type>& vertices, const Array<Vulkan, Arguments>& arguments, unsigned draw_count = 0, unsigned offset = 0 ) ;
+        
+        /** Method to append draw commands whose parameters & amount are read from GPU arrays to this object.
+         * @note Requires the device extension VK_KHR_draw_indirect_count. Without it, nothing is recorded and ExtensionNotPresent is reported.
+         * @param vertices The array of vertices used for drawing.
+         * @param arguments The array of draw parameters. Must be created with nyx::ArrayFlags::Indirect.
+         * @param count The array whose first element is the amount of draws to perform. Must be created with nyx::ArrayFlags::Indirect.
+         * @param max_draws The maximum amount of draws to perform. Defaults to the size of the arguments array.
+         */
+        template<typename Type, typename Arguments>
+        void drawIndirectCount( const vkg::Renderer& renderer, const Array<Vulkan, Type>& vertices, const Array<Vulkan, Arguments>& arguments, const Array<Vulkan, unsigned>& count, unsigned max_draws = 0 ) ;
+        
+        /** Method to append indexed draw commands whose parameters & amount are read from GPU arrays to this object.
+         * @note Requires the device extension VK_KHR_draw_indirect_count. Without it, nothing is recorded and ExtensionNotPresent is reported.
+         * @param indices The index array describing the render order of the vertex array.
+         * @param vertices The array of vertices used for drawing.
+         * @param arguments The array of draw parameters. Must be created with nyx::ArrayFlags::Indirect.
+         * @param count The array whose first element is the amount of draws to perform. Must be created with nyx::ArrayFlags::Indirect.
+         * @param max_draws The maximum amount of draws to perform. Defaults to the size of the arguments array.
+         */
+        template<typename Type, typename Type2, typename Arguments>
+        void drawIndexedIndirectCount( const vkg::Renderer& renderer, const Array<Vulkan, Type2>& indices, const Array<Vulkan, Type>& vertices, const Array<Vulkan, Arguments>& arguments, const Array<Vulkan, unsigned>& count, unsigned max_draws = 0 ) ;
+        
+        /** Method to append a compute dispatch to this object.
+         * @note Counts are in invocations, and are rounded up to whole workgroups of the computer's shader.
+         * @param computer The computer whose pipeline & bound resources to dispatch.
+         * @param x The amount of invocations along the x axis.
+         * @param y The amount of invocations along the y axis.
+         * @param z The amount of invocations along the z axis.
+         */
+        void dispatch( const vkg::Computer& computer, unsigned x, unsigned y = 1, unsigned z = 1 ) ;
+        
+        /** Method to append a compute dispatch over every element of an array to this object.
+         * @param computer The computer whose pipeline & bound resources to dispatch.
+         * @param array The array whose size is the amount of invocations to dispatch.
+         */
+        template<typename Type>
+        void dispatch( const vkg::Computer& computer, const Array<Vulkan, Type>& array ) ;
+        
+        /** Method to append a compute dispatch whose workgroup counts are read from a GPU array to this object.
+         * @param computer The computer whose pipeline & bound resources to dispatch.
+         * @param arguments The array containing the x, y & z workgroup counts.
+         * @param offset The offset, in elements, of the counts in the array.
+         */
+        template<typename Type>
+        void dispatchIndirect( const vkg::Computer& computer, const Array<Vulkan, Type>& arguments, unsigned offset = 0 ) ;
+        
         /** Method to explicitly end recording of this object.
           * @note The submit method implicitly ends this chain's record as well.
           */
@@ -231,12 +312,60 @@ namespace nyx
         template<typename Type>
         void push( const Renderer& pipeline, const Type& data, unsigned offset ) ;
         
+        /** Method to push a variable onto the input compute pipeline.
+         * @param computer The computer to push the data to.
+         * @param data The data to push.
+         * @param offset The offset, in bytes, to update the data in the pipeline. Defaults to 0.
+         */
+        template<typename Type>
+        void push( const Computer& computer, const Type& data, unsigned offset ) ;
+        
+        /** Method to set the viewport all following draws of this chain render to.
+         * @note Viewports are dynamic state, so changing them never rebuilds a pipeline. Lasts until this chain is reset.
+         * @param viewport The viewport to render to.
+         */
+        void setViewport( const nyx::Viewport& viewport ) ;
+        
+        /** Method to set the scissor all following draws of this chain render with.
+         * @note Defaults to the area of the viewport set by setViewport(). Lasts until this chain is reset.
+         * @param x The x offset of the scissor, in pixels.
+         * @param y The y offset of the scissor, in pixels.
+         * @param width The width of the scissor, in pixels.
+         * @param height The height of the scissor, in pixels.
+         */
+        void setScissor( int x, int y, unsigned width, unsigned height ) ;
+        
         /** Method to record an image transition operation.
          * @param image The image to transition.
          * @param layout The layout of the image to transition to.
          */
         void transition( vkg::Image& image, nyx::ImageLayout layout ) ;
         
+        /** Method to record an asynchronous copy from a library array to a host data pointer.
+         * @note The host pointer is written once this chain's submission completes, which the returned object can poll or wait on.
+         * @param src The array to copy from.
+         * @param dst The host data pointer to copy data to. Must stay valid until the readback completes.
+         * @param amt The amount of data to copy. Defaults to the entire array size.
+         * @param src_offset The offset of the source to copy from.
+         * @param dst_offset The offset of the destination to copy to.
+         * @return The object tracking the readback.
+         */
+        template<typename Type>
+        vkg::Readback readback( const nyx::Array<Vulkan, Type>& src, Type* dst, unsigned amt = 0, unsigned src_offset = 0, unsigned dst_offset = 0 ) ;
+        
+        /** Method to record an asynchronous copy from an image to a host data pointer.
+         * @note The host pointer is written once this chain's submission completes, which the returned object can poll or wait on.
+         * @param src The image to copy from.
+         * @param dst The host data pointer to copy data to. Must stay valid until the readback completes.
+         * @return The object tracking the readback.
+         */
+        vkg::Readback readback( const vkg::Image& src, void* dst ) ;
+        
+        /** Method to retrieve the amount of redundant binds this object skipped while recording.
+         * @return The counters of skipped pipeline, descriptor, vertex, index & push constant binds.
+         */
+        const vkg::BindStats& bindStats() const ;
+        
         /** Method to retrieve the device used by this object.
          * @return 
          */
@@ -246,11 +375,68 @@ namespace nyx
          * @param mode The mode for this chain's operation.
          */
         void setMode( nyx::ChainMode mode ) ;
+        
+        /** Method to set how many frames of this chain's work may be in flight on the device at once.
+         * @note Takes effect the next time this object is initialized. Clamped between 1 and 8. Defaults to 4.
+         * @param count The number of command buffers this object cycles through.
+         */
+        void setFramesInFlight( unsigned count ) ;
+        
+        /** Method to set which type of queue takes ownership of what this chain writes, when this is a transfer chain.
+         * @note Takes effect the next time this object is initialized. Defaults to nyx::ChainType::Graphics.
+         * @param type The type of chain that uses this chain's transfers next.
+         */
+        void setTarget( nyx::ChainType type ) ;
+        
+        /** Method to retrieve how many frames of this chain's work may be in flight at once.
+         * @return The number of frames this object may have in flight.
+         */
+        unsigned framesInFlight() const ;
+        
+        /** Method to retrieve how long the host has blocked waiting for this object's command buffers to become reusable.
+         * @return The accumulated time, in milliseconds, spent waiting on this object's fences before re-recording.
+         */
+        float waitTime() const ;
 
-        /** Method to synchronize this object's operations with the device.
+        /** Method to make this object's next submission wait on the device for another chain's submission to complete.
+         * @note Uses timeline semaphores, so neither queue waits on the host. On devices without them, this waits for the other chain's queue instead.
+         * @param chain The chain to wait on. Must have been submitted.
+         * @param value The signal value of the other chain's submission to wait on. Defaults to it's latest submission.
+         */
+        void waitOn( const vkg::Chain& chain, unsigned long long value = 0 ) ;
+        
+        /** Method to retrieve the value this object's timeline is signaled with once it's latest submission completes.
+         * @return The signal value of this object's latest submission, or 0 if it was never submitted.
+         */
+        unsigned long long signalValue() const ;
+        
+        /** Method to wait on the host for this object's submitted operations to complete.
+         * @note Waits only on this object's own submissions, not on other work sharing it's queue. Completes every readback this object has submitted.
          */
         void synchronize() ;
         
+        /** Method to poll whether this object's submitted operations have completed, without blocking.
+         * @return Whether or not every operation this object submitted has completed.
+         */
+        bool isComplete() const ;
+        
+        /** Method to start timing this object's subsequent GPU work.
+         * @note Timers nest, and are only recorded by chains that are neither children nor bundled. Queues without timestamp support ignore them.
+         * @param name The name to retrieve the timer's result by.
+         */
+        void beginTimer( const char* name ) ;
+        
+        /** Method to stop the most recently started timer.
+         */
+        void endTimer() ;
+        
+        /** Method to retrieve how long a timer last took on the GPU.
+         * @note Results are resolved without waiting, once the submission measuring them is known to be complete. See @synchronize.
+         * @param name The name of the timer.
+         * @return The duration of the timer's latest resolved measurement in milliseconds, or 0 if none is resolved yet.
+         */
+        float timer( const char* name ) const ;
+        
         /** Method to submit this object's work to the device.
          */
         void submit() ;
@@ -270,6 +456,8 @@ namespace nyx
         void drawInstancedBase( unsigned instanced_count, const vkg::Renderer& renderer, const vkg::Buffer& vertices, unsigned vertex_count ) ;
         
         void copy( const vkg::Buffer& src, vkg::Buffer& dst, unsigned copy_amt, unsigned element_size, unsigned src_offset, unsigned dst_offset ) ;
+        
+        vkg::Readback readback( const vkg::Buffer& src, void* dst, unsigned copy_amt, unsigned element_size, unsigned src_offset, unsigned dst_offset ) ;
 
         void copy( const void* src, vkg::Buffer& dst, unsigned copy_amt, unsigned element_size, unsigned src_offset, unsigned dst_offset ) ;
         
@@ -285,6 +473,22 @@ namespace nyx
         
         void pushBase( const Renderer& pipeline, const void* value, unsigned byte_size, unsigned offset ) ;
         
+        void pushBase( const Computer& computer, const void* value, unsigned byte_size, unsigned offset ) ;
+        
+        void dispatchIndirectBase( const vkg::Computer& computer, const vkg::Buffer& arguments, unsigned offset ) ;
+        
+        void drawIndirectBase( const vkg::Renderer& renderer, const vkg::Buffer* indices, const vkg::Buffer& vertices, const vkg::Buffer& arguments, unsigned offset, unsigned draw_count, unsigned stride, const vkg::Buffer* count ) ;
+        
+        /** Method to submit several chains' work to the device in a single queue submission.
+         * @note Chains on a different queue than the first are submitted on their own.
+         * @param chains The chains to submit.
+         * @param count The amount of chains to submit.
+         * @param fence The fence to signal once every chain's work completes. Always submitted, even if no chain had work.
+         */
+        static void submit( vkg::Chain* const* chains, unsigned count, const vk::Fence& fence ) ;
+        
+        friend class Batch ;
+        
         struct ChainData* chain_data ;
         
         friend struct ChainData ;
@@ -324,6 +528,13 @@ namespace nyx
       this->copy( src, dst, amt, sizeof( Type ), src_offset, dst_offset ) ;
     }
     
+    template<typename Type>
+    vkg::Readback Chain::readback( const nyx::Array<Vulkan, Type>& src, Type* dst, unsigned amt, unsigned src_offset, unsigned dst_offset )
+    {
+      if( amt == 0 ) amt = src.size() ;
+      return this->readback( src, static_cast<void*>( dst ), amt, sizeof( Type ), src_offset, dst_offset ) ;
+    }
+    
     template<typename Type>
     void Chain::draw( const vkg::Renderer& renderer, const Array<Vulkan, Type>& array, unsigned offset )
     {
@@ -348,10 +559,63 @@ namespace nyx
       this->drawInstancedBase( amt, renderer, vertices, vertices.size() ) ;
     }
     
+    template<typename Type, typename Arguments>
+    void Chain::drawIndirect( const vkg::Renderer& renderer, const Array<Vulkan, Type>& vertices, const Array<Vulkan, Arguments>& arguments, unsigned draw_count, unsigned offset )
+    {
+      if( draw_count == 0 ) draw_count = arguments.size() - offset ;
+      this->drawIndirectBase( renderer, nullptr, vertices, arguments, offset * sizeof( Arguments ), draw_count, sizeof( Arguments ), nullptr ) ;
+    }
+    
+    template<typename Type, typename Type2, typename Arguments>
+    void Chain::drawIndexedIndirect( const vkg::Renderer& renderer, const Array<Vulkan, Type2>& indices, const Array<Vulkan, Type>& vertices, const Array<Vulkan, Arguments>& arguments, unsigned draw_count, unsigned offset )
+    {
+      const vkg::Buffer& index_buffer = indices ;
+      
+      if( draw_count == 0 ) draw_count = arguments.size() - offset ;
+      this->drawIndirectBase( renderer, &index_buffer, vertices, arguments, offset * sizeof( Arguments ), draw_count, sizeof( Arguments ), nullptr ) ;
+    }
+    
+    template<typename Type, typename Arguments>
+    void Chain::drawIndirectCount( const vkg::Renderer& renderer, const Array<Vulkan, Type>& vertices, const Array<Vulkan, Arguments>& arguments, const Array<Vulkan, unsigned>& count, unsigned max_draws )
+    {
+      const vkg::Buffer& count_buffer = count ;
+      
+      if( max_draws == 0 ) max_draws = arguments.size() ;
+      this->drawIndirectBase( renderer, nullptr, vertices, arguments, 0, max_draws, sizeof( Arguments ), &count_buffer ) ;
+    }
+    
+    template<typename Type, typename Type2, typename Arguments>
+    void Chain::drawIndexedIndirectCount( const vkg::Renderer& renderer, const Array<Vulkan, Type2>& indices, const Array<Vulkan, Type>& vertices, const Array<Vulkan, Arguments>& arguments, const Array<Vulkan, unsigned>& count, unsigned max_draws )
+    {
+      const vkg::Buffer& index_buffer = indices ;
+      const vkg::Buffer& count_buffer = count   ;
+      
+      if( max_draws == 0 ) max_draws = arguments.size() ;
+      this->drawIndirectBase( renderer, &index_buffer, vertices, arguments, 0, max_draws, sizeof( Arguments ), &count_buffer ) ;
+    }
+    
     template<typename Type>
     void Chain::push( const Renderer& pipeline, const Type& data, unsigned offset )
     {
       this->pushBase( pipeline, static_cast<const void*>( &data ), sizeof( Type ), offset ) ;
     }
+    
+    template<typename Type>
+    void Chain::push( const Computer& computer, const Type& data, unsigned offset )
+    {
+      this->pushBase( computer, static_cast<const void*>( &data ), sizeof( Type ), offset ) ;
+    }
+    
+    template<typename Type>
+    void Chain::dispatch( const vkg::Computer& computer, const Array<Vulkan, Type>& array )
+    {
+      this->dispatch( computer, array.size(), 1, 1 ) ;
+    }
+    
+    template<typename Type>
+    void Chain::dispatchIndirect( const vkg::Computer& computer, const Array<Vulkan, Type>& arguments, unsigned offset )
+    {
+      this->dispatchIndirectBase( computer, arguments, offset * sizeof( Type ) ) ;
+    }
   }
 }
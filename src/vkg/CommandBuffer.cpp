@@ -35,6 +35,7 @@
 #include "Device.h"
 #include "RenderPass.h"
 #include "Descriptor.h"
+#include "library/Renderer.h"
 #include <algorithm>
 #include <vulkan/vulkan.hpp>
 #include <map>
@@ -42,22 +43,74 @@
 #include <mutex>
 #include <thread>
 #include <algorithm>
+#include <cstring>
+#include <chrono>
 
 namespace nyx
 {
   namespace vkg
   {
     typedef unsigned Family ;
-    using PoolMap   = std::unordered_map<Family, vk::CommandPool>  ;
-    using MutexMap  = std::unordered_map<Family, std::mutex     >  ;
-    using ThreadMap = std::unordered_map<std::thread::id, PoolMap> ;
-    static ThreadMap thread_map ;
-    static MutexMap mutex_map ;
+    using PoolMap        = std::unordered_map<Family, vk::CommandPool>   ;
+    using MutexMap       = std::unordered_map<Family, std::mutex     >   ;
+    using ThreadMap      = std::unordered_map<std::thread::id, PoolMap>  ;
+    using ThreadMutexMap = std::unordered_map<std::thread::id, MutexMap> ;
+    static ThreadMap      thread_map ;
+    static ThreadMutexMap mutex_map  ;
+    static std::mutex     map_mutex  ;
+
+    /** The largest push constant block tracked for redundant updates.
+     */
+    static constexpr unsigned PUSH_CONSTANT_SIZE = 256 ;
+    
+    /** Function to find the stages whose push constant ranges hold a byte.
+     * @param ranges The push constant ranges to search.
+     * @param count The amount of push constant ranges.
+     * @param byte The offset of the byte.
+     * @return The stages of every range holding the byte. Empty if none do.
+     */
+    static vk::ShaderStageFlags stagesAt( const vk::PushConstantRange* ranges, unsigned count, unsigned byte )
+    {
+      vk::ShaderStageFlags flags ;
+      
+      for( unsigned index = 0; index < count; index++ )
+      {
+        if( byte >= ranges[ index ].offset && byte < ranges[ index ].offset + ranges[ index ].size ) flags |= ranges[ index ].stageFlags ;
+      }
+      
+      return flags ;
+    }
+    
+    /** Structure to track the state last recorded to a single command buffer, so that redundant binds can be skipped.
+     */
+    struct BindState
+    {
+      vk::Pipeline          pipeline                   ;
+      vk::DescriptorSet     descriptor                 ;
+      vk::PipelineLayout    descriptor_layout          ;
+      vk::PipelineBindPoint descriptor_point           ;
+      vk::Buffer            vertices                   ;
+      vk::DeviceSize        vertex_offset              ;
+      vk::Buffer            indices                    ;
+      vk::PipelineLayout    push_layout                ;
+      unsigned              push_offset                ;
+      unsigned              push_size                  ;
+      unsigned char         push[ PUSH_CONSTANT_SIZE ] ;
+      
+      /** Default constructor.
+       */
+      BindState() ;
+      
+      /** Method to forget all tracked state, for when the command buffer's state is no longer known.
+       */
+      void reset() ;
+    };
 
     struct CommandBufferData
     {
       using CmdBuffers = std::vector<vk::CommandBuffer> ;
       using Fences     = std::vector<vk::Fence>         ;
+      using States     = std::vector<BindState>         ;
       
       std::mutex*                      pool_mutex          ;
       vk::CommandBufferInheritanceInfo inheritance         ;
@@ -71,17 +124,66 @@ namespace nyx
       vk::CommandBufferBeginInfo       begin_info          ;
       vk::CommandPool                  vk_pool             ;
       Fences                           fences              ;
+      mutable Fences                   shared              ;
       CommandBuffer::Level             level               ;
       CmdBuffers                       cmd_buffers         ;
       mutable std::vector<bool>        is_signaled         ;
       std::vector<bool>                started_render_pass ;
       bool                             recording           ;
       mutable unsigned                 current             ;
+      States                           states              ;
+      BindStats                        stats               ;
+      unsigned long long               wait_time           ;
+      vk::QueryPool                    query_pool          ;
+      unsigned                         query_count         ;
+      std::vector<unsigned>            queries_used        ;
+      std::vector<bool>                queries_reset       ;
+      vk::Viewport                     viewport            ;
+      vk::Rect2D                       scissor             ;
+      vk::Rect2D                       area                ; ///< The area of the render pass being recorded, if any.
+      bool                             has_viewport        ;
+      bool                             has_scissor         ;
+      const vk::PushConstantRange*     push_ranges         ; ///< The push constant ranges of the bound pipeline.
+      unsigned                         num_push_ranges     ;
+      std::vector<unsigned>            push_bounds         ; ///< Scratch offsets a push is split at.
+      std::vector<unsigned char>       push_padding        ;
       
       /** Default constructor.
        */
       CommandBufferData() ;
       
+      /** Method to record the viewport & scissor of the active command buffer for a graphics pipeline.
+       * Uses the viewport & scissor set on this object if any, otherwise the pipeline's own, otherwise the full area of the render pass.
+       * @param pipeline The graphics pipeline being bound.
+       */
+      inline void setDynamicState( const nyx::vkg::Pipeline& pipeline ) ;
+      
+      /** Method to wait until the active command buffer's last submission completes, so that it can be recorded again.
+       * @note Must be called with the pool mutex locked. The time spent waiting is accumulated.
+       */
+      inline void reuse() ;
+      
+      /** Method to reset the active command buffer's range of timestamp queries, if it has one.
+       * @note Must be called right after the active command buffer begins, outside of any render pass.
+       */
+      inline void resetQueries() ;
+      
+      /** Method to retrieve the tracked state of the active command buffer.
+       * @return Reference to the tracked state of the active command buffer.
+       */
+      inline BindState& state() ;
+      
+      /** Method to bind a vertex buffer to the active command buffer, unless already bound.
+       * @param buffer The buffer to bind.
+       * @param offset The offset into the buffer to bind.
+       */
+      inline void bindVertices( const vk::Buffer& buffer, vk::DeviceSize offset ) ;
+      
+      /** Method to bind an index buffer to the active command buffer, unless already bound.
+       * @param buffer The buffer to bind.
+       */
+      inline void bindIndices( const vk::Buffer& buffer ) ;
+      
       /** Method to retrieve the map of command pools from a queue family.
        * @note creates pool if it is not found.
        * @param queue_family
@@ -107,15 +209,146 @@ namespace nyx
       this->level               = CommandBuffer::Level::Primary ;
       this->recording           = false                         ;
       this->current             = 0                             ;
+      this->wait_time           = 0                             ;
+      this->query_count         = 0                             ;
+      this->has_viewport        = false                         ;
+      this->has_scissor         = false                         ;
+      this->push_ranges         = nullptr                       ;
+      this->num_push_ranges     = 0                             ;
+    }
+    
+    void CommandBufferData::setDynamicState( const nyx::vkg::Pipeline& pipeline )
+    {
+      vk::CommandBuffer& cmd = this->cmd_buffers[ this->current ] ;
+      
+      vk::Viewport       full = vk::Viewport() ;
+      
+      // The pipeline declares both as dynamic, so something must always be recorded before a draw.
+      full.setX       ( static_cast<float>( this->area.offset.x          ) ) ;
+      full.setY       ( static_cast<float>( this->area.offset.y          ) ) ;
+      full.setWidth   ( static_cast<float>( this->area.extent.width      ) ) ;
+      full.setHeight  ( static_cast<float>( this->area.extent.height     ) ) ;
+      full.setMinDepth( 0.0f                                               ) ;
+      full.setMaxDepth( 1.0f                                               ) ;
+      
+      if     ( this->has_viewport            ) cmd.setViewport( 0, 1, &this->viewport           ) ;
+      else if( pipeline.numViewports() != 0  ) cmd.setViewport( 0, 1, &pipeline.viewport( 0 )   ) ;
+      else                                     cmd.setViewport( 0, 1, &full                     ) ;
+      
+      if     ( this->has_scissor || this->has_viewport ) cmd.setScissor( 0, 1, &this->scissor          ) ;
+      else if( pipeline.numViewports() != 0            ) cmd.setScissor( 0, 1, &pipeline.scissor( 0 )  ) ;
+      else                                               cmd.setScissor( 0, 1, &this->area             ) ;
+    }
+    
+    void CommandBufferData::resetQueries()
+    {
+      if( !this->query_pool ) return ;
+      
+      this->cmd_buffers[ this->current ].resetQueryPool( this->query_pool, this->current * this->query_count, this->query_count ) ;
+      this->queries_used [ this->current ] = 0    ;
+      this->queries_reset[ this->current ] = true ;
+    }
+    
+    void CommandBufferData::reuse()
+    {
+      const vk::Fence fence = this->fences[ this->current ] ;
+      
+      const vk::Fence shared = this->shared[ this->current ] ;
+      const auto      start  = std::chrono::steady_clock::now() ;
+      
+      if( this->is_signaled[ this->current ] )
+      {
+        {
+          vkg::StallScope stall( "CommandBuffer::reuse" ) ;
+          vkg::Vulkan::add( this->device.waitForFences( 1, &fence, true, UINT64_MAX ) ) ;
+        }
+        vkg::Vulkan::add( this->device.resetFences( 1, &fence ) ) ;
+        this->is_signaled[ this->current ] = false ;
+      }
+      else if( shared )
+      {
+        // Shared fences belong to whoever submitted this buffer, so they are only waited on, never reset.
+        vkg::StallScope stall( "CommandBuffer::reuse" ) ;
+        vkg::Vulkan::add( this->device.waitForFences( 1, &shared, true, UINT64_MAX ) ) ;
+      }
+      
+      this->shared[ this->current ] = vk::Fence() ;
+      this->wait_time += std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count() ;
     }
     
+    BindStats::BindStats()
+    {
+      this->pipelines      = 0 ;
+      this->descriptors    = 0 ;
+      this->vertex_buffers = 0 ;
+      this->index_buffers  = 0 ;
+      this->push_constants = 0 ;
+    }
+
+    BindState::BindState()
+    {
+      this->reset() ;
+    }
+    
+    void BindState::reset()
+    {
+      this->pipeline          = nullptr                          ;
+      this->descriptor        = nullptr                          ;
+      this->descriptor_layout = nullptr                          ;
+      this->descriptor_point  = vk::PipelineBindPoint::eGraphics ;
+      this->vertices          = nullptr                          ;
+      this->vertex_offset     = 0                                ;
+      this->indices           = nullptr                          ;
+      this->push_layout       = nullptr                          ;
+      this->push_offset       = 0                                ;
+      this->push_size         = 0                                ;
+    }
+    
+    BindState& CommandBufferData::state()
+    {
+      return this->states[ this->current ] ;
+    }
+    
+    void CommandBufferData::bindVertices( const vk::Buffer& buffer, vk::DeviceSize offset )
+    {
+      BindState& state = this->state() ;
+      
+      if( state.vertices == buffer && state.vertex_offset == offset )
+      {
+        this->stats.vertex_buffers++ ;
+        return ;
+      }
+      
+      this->cmd_buffers[ this->current ].bindVertexBuffers( 0, 1, &buffer, &offset ) ;
+      state.vertices      = buffer ;
+      state.vertex_offset = offset ;
+    }
+    
+    void CommandBufferData::bindIndices( const vk::Buffer& buffer )
+    {
+      BindState& state = this->state() ;
+      
+      if( state.indices == buffer )
+      {
+        this->stats.index_buffers++ ;
+        return ;
+      }
+      
+      this->cmd_buffers[ this->current ].bindIndexBuffer( buffer, 0, vk::IndexType::eUint32 ) ;
+      state.indices = buffer ;
+    }
+
     std::mutex* CommandBufferData::mutex( Family queue_family )
     {
-      return &mutex_map[ queue_family ] ;
+      // Pools are per thread, so only command buffers allocated on the same thread ever share a lock.
+      std::lock_guard<std::mutex> lock( map_mutex ) ;
+      
+      return &mutex_map[ std::this_thread::get_id() ][ queue_family ] ;
     }
     
     vk::CommandPool& CommandBufferData::pool( Family queue_family )
     {
+      std::lock_guard<std::mutex> lock( map_mutex ) ;
       const auto id = std::this_thread::get_id() ;
       const PoolMap::iterator          iter   = thread_map[ id ].find( queue_family ) ;
       const vk::CommandPoolCreateFlags flags  = vk::CommandPoolCreateFlagBits::eResetCommandBuffer ; // TODO make this configurable.
@@ -186,31 +419,161 @@ namespace nyx
     
     void CommandBuffer::bind( const nyx::vkg::Descriptor& descriptor )
     {
+      BindState& state = data().state() ;
+      
       if( descriptor.set() ) 
       {
+        if( state.descriptor == descriptor.set() && state.descriptor_layout == data().pipeline_layout && state.descriptor_point == data().bind_point )
+        {
+          data().stats.descriptors++ ;
+          return ;
+        }
+        
         data().cmd_buffers[ data().current ].bindDescriptorSets( data().bind_point, data().pipeline_layout, 0, 1, &descriptor.set(), 0, nullptr ) ;
+        state.descriptor        = descriptor.set()       ;
+        state.descriptor_layout = data().pipeline_layout ;
+        state.descriptor_point  = data().bind_point      ;
       }
     }
 
     void CommandBuffer::bind( const nyx::vkg::Pipeline& pipeline )
     {
+      BindState& state = data().state() ;
+
       data().bind_point      = pipeline.isGraphics() ? vk::PipelineBindPoint::eGraphics : vk::PipelineBindPoint::eCompute ;
       data().pipeline        = pipeline.pipeline()                                                                        ;
       data().pipeline_layout = pipeline.layout()                                                                          ;
+      data().push_ranges     = pipeline.pushConstantRanges()                                                              ;
+      data().num_push_ranges = pipeline.numPushConstantRanges()                                                           ;
+      
+      if( state.pipeline == data().pipeline )
+      {
+        data().stats.pipelines++ ;
+        return ;
+      }
       
       data().cmd_buffers[ data().current ].bindPipeline( data().bind_point, data().pipeline ) ;
+      state.pipeline = data().pipeline ;
+      
+      // Dynamic state stays set across binds of the same pipeline, so it is only recorded along with a new one.
+      if( data().bind_point == vk::PipelineBindPoint::eGraphics ) data().setDynamicState( pipeline ) ;
+    }
+    
+    void CommandBuffer::setViewport( const nyx::Viewport& viewport )
+    {
+      data().viewport.setX       ( static_cast<float>( viewport.xpos()   ) ) ;
+      data().viewport.setY       ( static_cast<float>( viewport.ypos()   ) ) ;
+      data().viewport.setWidth   ( static_cast<float>( viewport.width()  ) ) ;
+      data().viewport.setHeight  ( static_cast<float>( viewport.height() ) ) ;
+      data().viewport.setMinDepth( 0.0f                                    ) ;
+      data().viewport.setMaxDepth( viewport.maxDepth()                     ) ;
+      data().has_viewport = true ;
+      
+      if( !data().has_scissor )
+      {
+        data().scissor.setOffset( { static_cast<int>( viewport.xpos() ), static_cast<int>( viewport.ypos() ) } ) ;
+        data().scissor.setExtent( { viewport.width(), viewport.height() }                                      ) ;
+      }
+      
+      if( data().recording )
+      {
+        data().cmd_buffers[ data().current ].setViewport( 0, 1, &data().viewport ) ;
+        data().cmd_buffers[ data().current ].setScissor ( 0, 1, &data().scissor  ) ;
+      }
+    }
+    
+    void CommandBuffer::setScissor( int x, int y, unsigned width, unsigned height )
+    {
+      data().scissor.setOffset( { x    , y      } ) ;
+      data().scissor.setExtent( { width, height } ) ;
+      data().has_scissor = true ;
+      
+      if( data().recording ) data().cmd_buffers[ data().current ].setScissor( 0, 1, &data().scissor ) ;
+    }
+    
+    const BindStats& CommandBuffer::bindStats() const
+    {
+      return data().stats ;
+    }
+    
+    void CommandBuffer::resetBindStats()
+    {
+      data().stats = BindStats() ;
     }
     
     void CommandBuffer::pushConstantBase( const void* value, unsigned byte_size, unsigned offset )
     {
-      const auto flags = vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute ;
-      char buff[ 256 ] ;
-     
-      if( byte_size < 256 )
+      const vk::PushConstantRange* ranges = data().push_ranges                       ;
+      const unsigned               count  = data().num_push_ranges                   ;
+      std::vector<unsigned>&       bounds = data().push_bounds                       ;
+      BindState&                   state  = data().state()                           ;
+      const unsigned char*         bytes  = static_cast<const unsigned char*>( value ) ;
+      const unsigned               padded = ( byte_size + 3 ) & ~3u                  ;
+      const unsigned               end    = offset + padded                          ;
+      const bool                   cached = byte_size <= PUSH_CONSTANT_SIZE          ;
+      vk::ShaderStageFlags         flags  ;
+      vk::ShaderStageFlags         next   ;
+      unsigned                     start  ;
+      bool                         valid  ;
+      
+      // Split the push wherever a stage's range starts or ends, so every part is pushed with exactly the stages whose ranges hold it.
+      bounds.assign( { offset, end } ) ;
+      for( unsigned index = 0; index < count; index++ )
+      {
+        const unsigned first = ranges[ index ].offset                          ;
+        const unsigned last  = ranges[ index ].offset + ranges[ index ].size ;
+        
+        if( first > offset && first < end ) bounds.push_back( first ) ;
+        if( last  > offset && last  < end ) bounds.push_back( last  ) ;
+      }
+      
+      std::sort( bounds.begin(), bounds.end() ) ;
+      bounds.erase( std::unique( bounds.begin(), bounds.end() ), bounds.end() ) ;
+      
+      // Ranges start & end on whole words, so a push whose bytes are all held by some range is held once padded too.
+      valid = offset % 4 == 0 && byte_size != 0 ;
+      for( unsigned index = 0; valid && index + 1 < bounds.size(); index++ )
       {
-        std::memcpy( buff, reinterpret_cast<const char*>( ( value ) ), byte_size ) ;
-        data().cmd_buffers[ data().current ].pushConstants( data().pipeline_layout, flags, offset, 256 - offset, buff ) ;
+        valid = static_cast<bool>( stagesAt( ranges, count, bounds[ index ] ) ) ;
       }
+      
+      if( !valid )
+      {
+        vkg::Vulkan::add( vkg::Vulkan::Error::InvalidPushConstant ) ;
+        return ;
+      }
+      
+      if( cached && state.push_layout == data().pipeline_layout && state.push_offset == offset && state.push_size == byte_size && std::memcmp( state.push, bytes, byte_size ) == 0 )
+      {
+        data().stats.push_constants++ ;
+        return ;
+      }
+      
+      // Vulkan pushes whole 4 byte words, and ranges always end on one, so a partial word is zero padded.
+      if( padded != byte_size )
+      {
+        data().push_padding.assign( padded, 0 ) ;
+        std::memcpy( data().push_padding.data(), bytes, byte_size ) ;
+        bytes = data().push_padding.data() ;
+      }
+      
+      // Neighbouring parts read by the same stages are pushed together.
+      start = bounds[ 0 ]                          ;
+      flags = stagesAt( ranges, count, start ) ;
+      for( unsigned index = 1; index < bounds.size(); index++ )
+      {
+        next = index + 1 < bounds.size() ? stagesAt( ranges, count, bounds[ index ] ) : vk::ShaderStageFlags() ;
+        if( next == flags ) continue ;
+        
+        data().cmd_buffers[ data().current ].pushConstants( data().pipeline_layout, flags, start, bounds[ index ] - start, bytes + ( start - offset ) ) ;
+        start = bounds[ index ] ;
+        flags = next            ;
+      }
+      
+      if( cached ) std::memcpy( state.push, bytes, byte_size ) ;
+      state.push_layout = cached ? data().pipeline_layout : vk::PipelineLayout() ;
+      state.push_offset = offset                                                 ;
+      state.push_size   = byte_size                                              ;
     }
     
     void CommandBuffer::initialize( const CommandBuffer& parent ) 
@@ -242,8 +605,10 @@ namespace nyx
       
       data().cmd_buffers        .resize( parent.data().cmd_buffers.size() ) ;
       data().fences             .resize( parent.data().cmd_buffers.size() ) ;
+      data().shared             .resize( parent.data().cmd_buffers.size() ) ;
       data().started_render_pass.resize( parent.data().cmd_buffers.size() ) ;
       data().is_signaled        .resize( parent.data().cmd_buffers.size() ) ;
+      data().states             .resize( parent.data().cmd_buffers.size() ) ;
       
       std::fill( data().started_render_pass.begin(), data().started_render_pass.end(), false ) ;
       std::fill( data().is_signaled        .begin(), data().is_signaled        .end(), true  ) ;
@@ -290,8 +655,10 @@ namespace nyx
       
       data().cmd_buffers        .resize( count ) ;
       data().fences             .resize( count ) ;
+      data().shared             .resize( count ) ;
       data().started_render_pass.resize( count ) ;
       data().is_signaled        .resize( count ) ;
+      data().states             .resize( count ) ;
 
       data().subpass_flags = multi_pass ? vk::SubpassContents::eSecondaryCommandBuffers : vk::SubpassContents::eInline ;
 
@@ -317,14 +684,21 @@ namespace nyx
       if( data().level == Level::Primary )
       {
         if( data().started_render_pass[ data().current ] ) data().cmd_buffers[ data().current ].nextSubpass( data().subpass_flags ) ;
+        data().state().reset() ;
       }
     }
     
     void CommandBuffer::combine( const CommandBuffer& cmd )
     {
-      if( data().level == Level::Primary && cmd.data().level == Level::Secondary && data().subpass_flags == vk::SubpassContents::eSecondaryCommandBuffers )
+      const bool inline_pass = data().started_render_pass[ data().current ] && data().subpass_flags != vk::SubpassContents::eSecondaryCommandBuffers ;
+      
+      // Outside of a render pass, secondaries can always be executed.
+      if( data().level == Level::Primary && cmd.data().level == Level::Secondary && !inline_pass )
       {
         data().cmd_buffers[ data().current ].executeCommands( 1, &cmd.data().cmd_buffers[ cmd.data().current ] ) ;
+        
+        // Executed commands leave the bound state undefined.
+        data().state().reset() ;
       }
     }
     
@@ -334,6 +708,60 @@ namespace nyx
       return data().fences[ data().current ] ;
     }
     
+    void CommandBuffer::setTimestamps( unsigned count )
+    {
+      vk::QueryPoolCreateInfo info ;
+      
+      if( data().query_pool ) data().device.destroy( data().query_pool ) ;
+      data().query_pool  = vk::QueryPool() ;
+      data().query_count = count           ;
+      
+      data().queries_used .assign( data().cmd_buffers.size(), 0     ) ;
+      data().queries_reset.assign( data().cmd_buffers.size(), false ) ;
+      
+      if( count == 0 || data().cmd_buffers.empty() ) return ;
+      
+      info.setQueryType ( vk::QueryType::eTimestamp         ) ;
+      info.setQueryCount( count * data().cmd_buffers.size() ) ;
+      
+      auto result = data().device.createQueryPool( info ) ;
+      vkg::Vulkan::add( result.result ) ;
+      data().query_pool = result.value ;
+    }
+    
+    unsigned CommandBuffer::timestamp( bool end )
+    {
+      const auto stage = end ? vk::PipelineStageFlagBits::eBottomOfPipe : vk::PipelineStageFlagBits::eTopOfPipe ;
+      unsigned   query ;
+      
+      // Buffers begun before the queries existed never reset their range, so they can't write to it.
+      if( !data().query_pool || !data().queries_reset[ data().current ] ) return UINT32_MAX ;
+      if( data().queries_used[ data().current ] >= data().query_count   ) return UINT32_MAX ;
+      
+      query = data().queries_used[ data().current ]++ ;
+      data().cmd_buffers[ data().current ].writeTimestamp( stage, data().query_pool, data().current * data().query_count + query ) ;
+      
+      return query ;
+    }
+    
+    bool CommandBuffer::timestamps( unsigned index, unsigned count, unsigned long long* values ) const
+    {
+      const auto flags = vk::QueryResultFlagBits::e64 ;
+      
+      if( !data().query_pool || count == 0 || count > data().query_count ) return false ;
+      
+      const auto result = data().device.getQueryPoolResults( data().query_pool, index * data().query_count, count, count * sizeof( unsigned long long ), 
+                                                             values, sizeof( unsigned long long ), flags ) ;
+      
+      return result == vk::Result::eSuccess ;
+    }
+    
+    void CommandBuffer::signalWith( const vk::Fence& fence ) const
+    {
+      data().is_signaled[ data().current ] = false ;
+      data().shared     [ data().current ] = fence ;
+    }
+    
     void CommandBuffer::advance() const
     {
       data().current++ ;
@@ -379,38 +807,68 @@ namespace nyx
     {
       const vk::DeviceSize device_size = offset ;
       
-      data().cmd_buffers[ data().current ].bindVertexBuffers( 0, 1, &buffer.buffer(), &device_size ) ;
+      data().bindVertices( buffer.buffer(), device_size ) ;
       data().cmd_buffers[ data().current ].draw( count, 1, 0, 0 ) ;
     }
     
+    void CommandBuffer::drawIndirect( const nyx::vkg::Buffer* indices, const nyx::vkg::Buffer& vertices, const nyx::vkg::Buffer& arguments, unsigned offset, unsigned draw_count, unsigned stride, const nyx::vkg::Buffer* count )
+    {
+      const vk::DeviceSize device_offset = offset ;
+      auto&                cmd           = data().cmd_buffers[ data().current ] ;
+      
+      data().bindVertices( vertices.buffer(), 0 ) ;
+      if( indices ) data().bindIndices( indices->buffer() ) ;
+      
+      if( count )
+      {
+        if( indices ) cmd.drawIndexedIndirectCountKHR( arguments.buffer(), device_offset, count->buffer(), 0, draw_count, stride ) ;
+        else          cmd.drawIndirectCountKHR       ( arguments.buffer(), device_offset, count->buffer(), 0, draw_count, stride ) ;
+      }
+      else
+      {
+        if( indices ) cmd.drawIndexedIndirect( arguments.buffer(), device_offset, draw_count, stride ) ;
+        else          cmd.drawIndirect       ( arguments.buffer(), device_offset, draw_count, stride ) ;
+      }
+    }
+    
+    void CommandBuffer::dispatch( unsigned x, unsigned y, unsigned z )
+    {
+      data().cmd_buffers[ data().current ].dispatch( x, y, z ) ;
+    }
+    
+    void CommandBuffer::dispatchIndirect( const nyx::vkg::Buffer& arguments, unsigned offset )
+    {
+      const vk::DeviceSize device_offset = offset ;
+      
+      data().cmd_buffers[ data().current ].dispatchIndirect( arguments.buffer(), device_offset ) ;
+    }
+    
     void CommandBuffer::drawIndexedBase( const nyx::vkg::Buffer& index, const nyx::vkg::Buffer& vert, unsigned index_count, unsigned vert_count, unsigned offset ) 
     {
-      const vk::DeviceSize device_size = offset                 ;
-      const vk::IndexType  type        = vk::IndexType::eUint32 ;
+      const vk::DeviceSize device_size = offset ;
 
       vert_count = vert_count ;
-      data().cmd_buffers[ data().current ].bindVertexBuffers( 0, 1, &vert.buffer(), &device_size ) ;
-      data().cmd_buffers[ data().current ].bindIndexBuffer  ( index.buffer(), 0, type            ) ;
-      data().cmd_buffers[ data().current ].drawIndexed      ( index_count, 1, 0, 0, 0            ) ;
+      data().bindVertices( vert.buffer(), device_size ) ;
+      data().bindIndices ( index.buffer()             ) ;
+      data().cmd_buffers[ data().current ].drawIndexed( index_count, 1, 0, 0, 0 ) ;
     }
 
     void CommandBuffer::drawInstanced( const nyx::vkg::Buffer& vertices, unsigned vert_count, unsigned instance_count, unsigned offset, unsigned first )
     {
       const vk::DeviceSize device_size = offset ;
       
-      data().cmd_buffers[ data().current ].bindVertexBuffers( 0, 1, &vertices.buffer(), &device_size ) ;
+      data().bindVertices( vertices.buffer(), device_size ) ;
       data().cmd_buffers[ data().current ].draw( vert_count, instance_count, offset, first ) ;
     }
     
     void CommandBuffer::drawInstanced( const nyx::vkg::Buffer& indices, unsigned index_count, const nyx::vkg::Buffer& vertices, unsigned vert_count, unsigned instance_count, unsigned offset, unsigned first )
     {
-      const vk::DeviceSize device_size = offset                 ;
-      const vk::IndexType  type        = vk::IndexType::eUint32 ;
+      const vk::DeviceSize device_size = offset ;
 
       vert_count = vert_count ;
-      data().cmd_buffers[ data().current ].bindVertexBuffers( 0, 1, &vertices.buffer(), &device_size        ) ;
-      data().cmd_buffers[ data().current ].bindIndexBuffer  ( indices.buffer(), 0, type                     ) ;
-      data().cmd_buffers[ data().current ].drawIndexed      ( index_count, instance_count, offset, 0, first ) ;
+      data().bindVertices( vertices.buffer(), device_size ) ;
+      data().bindIndices ( indices.buffer()               ) ;
+      data().cmd_buffers[ data().current ].drawIndexed( index_count, instance_count, offset, 0, first ) ;
     }
     
     bool CommandBuffer::recording() const
@@ -420,8 +878,7 @@ namespace nyx
 
     void CommandBuffer::record( const nyx::vkg::RenderPass& render_pass, unsigned index )
     {
-      vk::Fence               fence ;
-      vk::RenderPassBeginInfo info  ;
+      vk::RenderPassBeginInfo info ;
       
       info.setClearValueCount( render_pass.count()       ) ;
       info.setPClearValues   ( render_pass.clearValues() ) ;
@@ -429,43 +886,40 @@ namespace nyx
       info.setRenderPass     ( render_pass.pass()        ) ;
       info.setFramebuffer    ( render_pass.current()     ) ;
       
-      fence = data().fences[ data().current ] ;
-      
       data().pool_mutex->lock() ;
+      data().area = render_pass.area() ;
       if( data().level == Level::Primary )
       {
-        if( data().is_signaled[ data().current ] )
-        {
-          vkg::Vulkan::add( data().device.waitForFences( 1, &fence, true, UINT64_MAX ) ) ;
-          vkg::Vulkan::add( data().device.resetFences( 1, &fence )                     ) ;
-          data().is_signaled[ data().current ] = false ;
-        }
+        data().reuse() ;
         
         vkg::Vulkan::add( data().cmd_buffers[ data().current ].begin          ( &data().begin_info )        ) ;
+                          data().resetQueries()                                                           ;
                           data().cmd_buffers[ data().current ].beginRenderPass( &info, data().subpass_flags ) ;
   
         data().recording                             = true ;
         data().started_render_pass[ data().current ] = true ;
+        data().state().reset() ;
       }
       else
       {
 //        data().inheritance.setFramebuffer    ( render_pass.current()                               ) ;
         data().inheritance.setSubpass        ( index                                               ) ;
         data().inheritance.setRenderPass     ( render_pass.pass()                                  ) ;
-        data().begin_info.setPInheritanceInfo( &data().inheritance                                 ) ;
-        data().begin_info.setFlags           ( vk::CommandBufferUsageFlagBits::eRenderPassContinue ) ;
+        // Secondaries may be executed from every primary of a chain at once, like a recorded bundle is.
+        data().begin_info.setPInheritanceInfo( &data().inheritance                                                                           ) ;
+        data().begin_info.setFlags           ( vk::CommandBufferUsageFlagBits::eRenderPassContinue | vk::CommandBufferUsageFlagBits::eSimultaneousUse ) ;
 
         vkg::Vulkan::add( data().cmd_buffers[ data().current ].begin( &data().begin_info ) ) ;
         
         data().recording = true ;
+        data().state().reset() ;
       }
       data().pool_mutex->unlock() ;
     }
 
     void CommandBuffer::record( const nyx::vkg::RenderPass& render_pass )
     {
-      vk::RenderPassBeginInfo info  ;
-      vk::Fence               fence ;
+      vk::RenderPassBeginInfo info ;
       
       info.setClearValueCount( render_pass.count()       ) ;
       info.setPClearValues   ( render_pass.clearValues() ) ;
@@ -473,44 +927,91 @@ namespace nyx
       info.setRenderPass     ( render_pass.pass()        ) ;
       info.setFramebuffer    ( render_pass.current()     ) ;
       
-      fence = data().fences[ data().current ] ;
-      
       data().pool_mutex->lock() ;
+      data().area = render_pass.area() ;
       if( data().level == Level::Primary )
       {
-        if( data().is_signaled[ data().current ] )
-        {
-          vkg::Vulkan::add( data().device.waitForFences( 1, &fence, true, UINT64_MAX ) ) ;
-          vkg::Vulkan::add( data().device.resetFences( 1, &fence )                     ) ;
-          data().is_signaled[ data().current ] = false ;
-        }
+        data().reuse() ;
   
         vkg::Vulkan::add( data().cmd_buffers[ data().current ].begin          ( &data().begin_info )        ) ;
+                          data().resetQueries()                                                           ;
                           data().cmd_buffers[ data().current ].beginRenderPass( &info, data().subpass_flags ) ;
         
         data().recording                             = true ;
         data().started_render_pass[ data().current ] = true ;
+        data().state().reset() ;
       }
       data().pool_mutex->unlock() ;
     }
 
     void CommandBuffer::record()
     {
-      vk::Fence fence = data().fences[ data().current ] ;
-      
       data().pool_mutex->lock() ;
-      if( data().is_signaled[ data().current ] )
+      data().reuse() ;
+      
+      if( data().level == Level::Secondary )
       {
-        vkg::Vulkan::add( data().device.waitForFences( 1, &fence, true, UINT64_MAX ) ) ;
-        vkg::Vulkan::add( data().device.resetFences( 1, &fence )                     ) ;
-        data().is_signaled[ data().current ] = false ;
+        // Secondary buffers recorded outside of a render pass still need inheritance info, and may be executed from several primaries at once.
+        data().inheritance = vk::CommandBufferInheritanceInfo() ;
+        data().begin_info.setPInheritanceInfo( &data().inheritance                         ) ;
+        data().begin_info.setFlags           ( vk::CommandBufferUsageFlagBits::eSimultaneousUse ) ;
       }
 
       vkg::Vulkan::add( data().cmd_buffers[ data().current ].begin( &data().begin_info ) ) ;
+      if( data().level == Level::Primary ) data().resetQueries() ;
       data().recording = true ;
+      data().state().reset() ;
       data().pool_mutex->unlock() ;
     }
     
+    void CommandBuffer::wait()
+    {
+      data().pool_mutex->lock() ;
+      data().reuse() ;
+      data().pool_mutex->unlock() ;
+    }
+    
+    void CommandBuffer::synchronize() const
+    {
+      std::vector<vk::Fence> fences ;
+      
+      for( unsigned index = 0; index < data().fences.size(); index++ )
+      {
+        if     ( data().is_signaled[ index ] ) fences.push_back( data().fences[ index ] ) ;
+        else if( data().shared     [ index ] ) fences.push_back( data().shared[ index ] ) ;
+      }
+      
+      if( !fences.empty() )
+      {
+        vkg::StallScope stall( "CommandBuffer::synchronize" ) ;
+        vkg::Vulkan::add( data().device.waitForFences( fences.size(), fences.data(), true, UINT64_MAX ) ) ;
+      }
+      
+      // Finished shared fences are no longer needed, so their owners are free to destroy them.
+      std::fill( data().shared.begin(), data().shared.end(), vk::Fence() ) ;
+    }
+    
+    float CommandBuffer::waitTime() const
+    {
+      return static_cast<float>( data().wait_time ) / 1000000.0f ;
+    }
+    
+    bool CommandBuffer::complete() const
+    {
+      for( unsigned index = 0; index < data().fences.size(); index++ )
+      {
+        if( data().is_signaled[ index ] && data().device.getFenceStatus( data().fences[ index ] ) != vk::Result::eSuccess ) return false ;
+        if( data().shared     [ index ] && data().device.getFenceStatus( data().shared[ index ] ) != vk::Result::eSuccess ) return false ;
+      }
+      
+      return true ;
+    }
+    
+    void CommandBuffer::setMultiPass( bool multi_pass )
+    {
+      data().subpass_flags = multi_pass ? vk::SubpassContents::eSecondaryCommandBuffers : vk::SubpassContents::eInline ;
+    }
+    
     void CommandBuffer::setActive( unsigned index )
     {
       data().current = index < data().cmd_buffers.size() ? index : data().current ;
@@ -536,8 +1037,26 @@ namespace nyx
     {
       const vk::Device device = data().device ;
       
-      if( data().cmd_buffers.size() != 0 ) device.freeCommandBuffers( data().vk_pool, data().cmd_buffers.size(), data().cmd_buffers.data() ) ;
+      // Renderers keep a descriptor per handle, which must not be inherited by a later handle of the same value.
+      if( data().cmd_buffers.size() != 0 ) RendererImpl::release( *this ) ;
+      
+      // The pool may belong to a thread still allocating or recording from it, so free under it's lock.
+      if( data().cmd_buffers.size() != 0 && data().pool_mutex )
+      {
+        data().pool_mutex->lock() ;
+        device.freeCommandBuffers( data().vk_pool, data().cmd_buffers.size(), data().cmd_buffers.data() ) ;
+        data().pool_mutex->unlock() ;
+      }
       data().cmd_buffers.clear() ;
+      data().shared     .clear() ;
+      
+      if( data().query_pool ) device.destroy( data().query_pool ) ;
+      data().query_pool  = vk::QueryPool() ;
+      data().query_count = 0               ;
+      data().wait_time    = 0     ;
+      data().has_viewport = false        ;
+      data().has_scissor  = false        ;
+      data().area         = vk::Rect2D() ;
     }
 
     CommandBufferData& CommandBuffer::data()
@@ -38,6 +38,8 @@ namespace nyx
   class Array ;
   
   enum class PipelineStage : unsigned ;
+  class Viewport ;
+  
   namespace vkg
   {
     /** Forward declared library objects.
@@ -52,6 +54,21 @@ namespace nyx
     class Chain      ;
     class Queue      ;
 
+    /** Structure describing the amount of redundant state changes a command buffer skipped recording.
+     */
+    struct BindStats
+    {
+      unsigned long long pipelines      ; ///< The amount of pipeline binds skipped.
+      unsigned long long descriptors    ; ///< The amount of descriptor set binds skipped.
+      unsigned long long vertex_buffers ; ///< The amount of vertex buffer binds skipped.
+      unsigned long long index_buffers  ; ///< The amount of index buffer binds skipped.
+      unsigned long long push_constants ; ///< The amount of identical push constant updates skipped.
+      
+      /** Default constructor.
+       */
+      BindStats() ;
+    };
+
     /** Class for handling command buffer generation & management.
      */
     class CommandBuffer
@@ -90,16 +107,41 @@ namespace nyx
         void push( const Type& value, nyx::PipelineStage stage ) ;
         
         /** Method to bind a descriptor to this command buffer.
-         * @note Requires a pipeline already bound to this object.
+         * @note Requires a pipeline already bound to this object. Skipped if already bound with the same pipeline layout.
          * @param descriptor The descriptor to bind.
          */
         void bind( const nyx::vkg::Descriptor& descriptor ) ;
 
         /** Method to bind a pipeline to this command buffer.
+         * @note Skipped if the pipeline is already bound to the active command buffer.
          * @param pipeline The pipeline to bind.
          */
         void bind( const nyx::vkg::Pipeline& pipeline ) ;
         
+        /** Method to set the viewport graphics pipelines bound to this object draw to.
+         * @note Overrides the default viewport of each pipeline until this object is reset.
+         * @param viewport The viewport to draw to.
+         */
+        void setViewport( const nyx::Viewport& viewport ) ;
+        
+        /** Method to set the scissor graphics pipelines bound to this object draw with.
+         * @note Overrides the default scissor of each pipeline until this object is reset. Defaults to the viewport set by setViewport().
+         * @param x The x offset of the scissor, in pixels.
+         * @param y The y offset of the scissor, in pixels.
+         * @param width The width of the scissor, in pixels.
+         * @param height The height of the scissor, in pixels.
+         */
+        void setScissor( int x, int y, unsigned width, unsigned height ) ;
+        
+        /** Method to retrieve the amount of redundant binds this object has skipped recording.
+         * @return The counters of skipped binds, accumulated over all of this object's command buffers.
+         */
+        const BindStats& bindStats() const ;
+        
+        /** Method to reset the counters of skipped binds of this object.
+         */
+        void resetBindStats() ;
+        
         /** Assignment operator. Assigns this object to the input.
          * @param cmd The command buffer to assign this object to.
          * @return A reference to this object after assignment.
@@ -203,6 +245,31 @@ namespace nyx
          */
         void record() ;
         
+        /** Method to wait on the active command buffer's last submission, so that it can be submitted again without being re-recorded.
+         */
+        void wait() ;
+        
+        /** Method to wait on the host for every submission of this object's command buffers to complete.
+         * @note Unlike waiting on the queue, this does not wait on submissions made by any other object.
+         */
+        void synchronize() const ;
+        
+        /** Method to poll whether every submission of this object's command buffers has completed, without blocking.
+         * @return Whether or not all of this object's submitted work has completed.
+         */
+        bool complete() const ;
+        
+        /** Method to retrieve how long the host has waited for this object's command buffers to be free to record again.
+         * @return The total time, in milliseconds, spent waiting on previous submissions before re-recording.
+         */
+        float waitTime() const ;
+        
+        /** Method to set whether the render passes this object begins take their contents from secondary command buffers.
+         * @note Only affects render passes begun after this call.
+         * @param multi_pass Whether the render pass contents are recorded in secondary command buffers.
+         */
+        void setMultiPass( bool multi_pass ) ;
+        
         unsigned current() const ;
         
         /** Method to set the active command buffer of this object.
@@ -257,10 +324,35 @@ namespace nyx
          */
         void drawInstanced( const nyx::vkg::Buffer& indices, unsigned index_count, const nyx::vkg::Buffer& vertices, unsigned vert_count, unsigned instance_count, unsigned offset = 0, unsigned first = 0 ) ;
         
+        /** Base method to draw vertices with draw parameters read from a buffer.
+         * @param indices The buffer to use for indices, or nullptr to draw non-indexed.
+         * @param vertices The buffer to use for vertices.
+         * @param arguments The buffer containing the tightly-packed draw parameters.
+         * @param offset The offset, in bytes, of the first draw's parameters in the buffer.
+         * @param draw_count The amount of draws to perform, or the maximum amount when a count buffer is used.
+         * @param stride The size, in bytes, of each draw's parameters.
+         * @param count The buffer containing the amount of draws to perform, or nullptr to perform @draw_count draws.
+         */
+        void drawIndirect( const nyx::vkg::Buffer* indices, const nyx::vkg::Buffer& vertices, const nyx::vkg::Buffer& arguments, unsigned offset, unsigned draw_count, unsigned stride, const nyx::vkg::Buffer* count ) ;
+        
+        /** Base method to dispatch the bound compute pipeline.
+         * @param x The amount of workgroups along the x axis.
+         * @param y The amount of workgroups along the y axis.
+         * @param z The amount of workgroups along the z axis.
+         */
+        void dispatch( unsigned x, unsigned y, unsigned z ) ;
+        
+        /** Base method to dispatch the bound compute pipeline with workgroup counts read from a buffer.
+         * @param arguments The buffer containing the workgroup counts.
+         * @param offset The offset, in bytes, of the counts in the buffer.
+         */
+        void dispatchIndirect( const nyx::vkg::Buffer& arguments, unsigned offset ) ;
+        
         /** Private method for pushing a value as a push-constant to this command buffer.
+         * @note Each byte is pushed to the stages whose ranges in the bound pipeline hold it. Pushes with any byte outside of every range are rejected.
          * @param value The pointer value to push onto the Device.
          * @param byte_size The size in bytes of the object being pushed.
-         * @param stage_flags The stage that the push constant is used on.
+         * @param offset The offset, in bytes, to push the value to. Must be a multiple of 4.
          */
         void pushConstantBase( const void* value, unsigned byte_size, unsigned offset ) ;
         
@@ -269,6 +361,32 @@ namespace nyx
          */
         vk::Fence fence() const ;
         
+        /** Method to give each of this object's command buffers a range of timestamp queries, reset whenever it begins recording.
+         * @note Command buffers already recording can't write timestamps until they are recorded again.
+         * @param count The amount of timestamp queries each command buffer gets. 0 removes them.
+         */
+        void setTimestamps( unsigned count ) ;
+        
+        /** Method to write a timestamp into the active command buffer's next query.
+         * @param end Whether to write the timestamp once all prior commands complete, instead of before they start.
+         * @return The index of the query within the active command buffer's range, or UINT32_MAX if none is left.
+         */
+        unsigned timestamp( bool end ) ;
+        
+        /** Method to retrieve the timestamps written by one of this object's command buffers, without waiting.
+         * @param index The index of the command buffer to retrieve the timestamps of.
+         * @param count The amount of timestamps to retrieve, from the start of the command buffer's range.
+         * @param values The array to write the timestamps into. Must have room for @count values.
+         * @return Whether or not every requested timestamp was available.
+         */
+        bool timestamps( unsigned index, unsigned count, unsigned long long* values ) const ;
+        
+        /** Method to mark the active command buffer as submitted under a fence this object does not own.
+         * @note The fence is only ever waited on by this object, so whoever owns it may keep reusing it.
+         * @param fence The fence signaled once the submission containing the active command buffer completes.
+         */
+        void signalWith( const vk::Fence& fence ) const ;
+        
         void advance() const ;
         
         /** Forward declared structure containing this object's data.
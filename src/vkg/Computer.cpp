@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * File:   Computer.cpp
+ * Author: Jordan Hendl
+ * 
+ * Created on October 16, 2026
+ */
+
+#include "Computer.h"
+#include "Pipeline.h"
+
+namespace nyx
+{
+  namespace vkg
+  {
+    void Computer::initialize( unsigned device, const char* nyx_file_path )
+    {
+      this->impl.initialize( device, nyx_file_path ) ;
+    }
+
+    void Computer::initialize( unsigned device, const unsigned char* nyx_file_bytes, unsigned size )
+    {
+      this->impl.initialize( device, nyx_file_bytes, size ) ;
+    }
+
+    bool Computer::initialized() const
+    {
+      return this->impl.pipeline().initialized() ;
+    }
+    
+    void Computer::bind( const char* name, const vkg::Image& image )
+    {
+      this->impl.bind( name, image ) ;
+    }
+    
+    unsigned Computer::device() const
+    {
+      return this->impl.device() ;
+    }
+    
+    unsigned Computer::workgroupSize( unsigned axis ) const
+    {
+      return this->impl.workgroupSize( axis ) ;
+    }
+    
+    unsigned Computer::numBuffers() const
+    {
+      return this->impl.numBuffers() ;
+    }
+    
+    const vkg::Buffer& Computer::buffer( unsigned index ) const
+    {
+      return this->impl.buffer( index ) ;
+    }
+    
+    bool Computer::writes( unsigned index ) const
+    {
+      return this->impl.writes( index ) ;
+    }
+    
+    unsigned Computer::numImages() const
+    {
+      return this->impl.numImages() ;
+    }
+    
+    const vkg::Image& Computer::image( unsigned index ) const
+    {
+      return this->impl.boundImage( index ) ;
+    }
+    
+    bool Computer::writesImage( unsigned index ) const
+    {
+      return this->impl.writesImage( index ) ;
+    }
+    
+    const vkg::Descriptor& Computer::descriptor( const vkg::CommandBuffer& cmd ) const
+    {
+      return this->impl.descriptor( cmd ) ;
+    }
+
+    const vkg::Pipeline& Computer::pipeline() const
+    {
+      return this->impl.pipeline() ;
+    }
+    
+    void Computer::reset()
+    {
+      this->impl.reset() ;
+    }
+  }
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * File:   Computer.h
+ * Author: Jordan Hendl
+ *
+ * Created on October 16, 2026
+ */
+
+#pragma once
+
+#include "Renderer.h"
+
+namespace nyx
+{
+  template<typename Framework>
+  class Computer ;
+
+  namespace vkg
+  {
+    class Vulkan        ;
+    class Buffer        ;
+    class Image         ;
+    class Pipeline      ;
+    class Chain         ;
+    class Descriptor    ;
+    class CommandBuffer ;
+    struct ChainData    ;
+    
+    /** Class to manage a compute pipeline and the resources bound to it.
+     * @note Recorded into a vkg::Chain using @Chain::dispatch.
+     */
+    class Computer
+    {
+      private:
+        
+        /** Friend decleration so the template interface can access this object's functionality.
+         */
+        template<typename Framework>
+        friend class nyx::Computer ;
+        
+        friend class  Chain     ;
+        friend struct ChainData ;
+        
+        /** Default constructor.
+         */
+        Computer() = default ;
+  
+        /** Default deconstructor.
+         */
+        ~Computer() = default ;
+  
+        /** Method to initialize this object.
+         * @param device The device to use for all GPU operations.
+         * @param nyx_file_path The path to the .nyx file on the filesystem to use.
+         */
+        void initialize( unsigned device, const char* nyx_file_path ) ;
+  
+        /** Method to initialize this object.
+         * @param device The device to use for all GPU operations.
+         * @param nyx_file_bytes The bytes of the .nyx file to use for this object.
+         * @param size The size of the byte array.
+         */
+        void initialize( unsigned device, const unsigned char* nyx_file_bytes, unsigned size ) ;
+  
+        /** Method to check whether this object is initialized or not.
+         * @return Whether or not this object is initialized.
+         */
+        bool initialized() const ;
+        
+        /** Method to bind an array to one of this object's values on the GPU.
+         * @param name The name associated with the value in the inputted pipeline.
+         * @param array The GPU array to bind to the pipeline variable.
+         */
+        template<typename Type>
+        void bind( const char* name, const nyx::Array<vkg::Vulkan, Type>& array ) ;
+        
+        /** Method to bind an image to one of this object's values on the GPU.
+         * @param name The name associated with the value in the inputted pipeline.
+         * @param image The GPU image to bind to the pipeline variable.
+         */
+        void bind( const char* name, const vkg::Image& image ) ;
+        
+        /** Method to retrieve the device used by this computer.
+         * @return The device used for this computer.
+         */
+        unsigned device() const ;
+        
+        /** Method to retrieve the local workgroup size of this object's compute shader.
+         * @param axis The axis ( 0 = x, 1 = y, 2 = z ) of the workgroup to retrieve.
+         * @return The amount of invocations per workgroup along the axis.
+         */
+        unsigned workgroupSize( unsigned axis = 0 ) const ;
+        
+        /** Method to retrieve the amount of buffers currently bound to this object.
+         * @return The amount of buffers currently bound to this object.
+         */
+        unsigned numBuffers() const ;
+        
+        /** Method to retrieve a buffer currently bound to this object.
+         * @param index The index of bound buffer to retrieve. See @numBuffers for the amount.
+         * @return Const reference to the bound buffer.
+         */
+        const vkg::Buffer& buffer( unsigned index ) const ;
+        
+        /** Method to check whether this object's shader may write to a buffer currently bound to this object.
+         * @param index The index of bound buffer to check. See @numBuffers for the amount.
+         * @return Whether the buffer is bound to a writable shader variable.
+         */
+        bool writes( unsigned index ) const ;
+        
+        /** Method to retrieve the amount of images currently bound to this object.
+         * @return The amount of images currently bound to this object.
+         */
+        unsigned numImages() const ;
+        
+        /** Method to retrieve an image currently bound to this object.
+         * @param index The index of bound image to retrieve. See @numImages for the amount.
+         * @return Const reference to the bound image.
+         */
+        const vkg::Image& image( unsigned index ) const ;
+        
+        /** Method to check whether this object's kernel may write to an image currently bound to this object.
+         * @param index The index of bound image to check. See @numImages for the amount.
+         * @return Whether the image is bound to a writable shader variable.
+         */
+        bool writesImage( unsigned index ) const ;
+        
+        /** Method to retrieve the descriptor to use for the specified command buffer.
+         * @param cmd The command buffer whose active buffer the descriptor is used in.
+         * @return Const reference to the descriptor.
+         */
+        const vkg::Descriptor& descriptor( const vkg::CommandBuffer& cmd ) const ;
+        
+        /** Method to retrieve the compute pipeline of this object.
+         * @return Const reference to this object's pipeline.
+         */
+        const vkg::Pipeline& pipeline() const ;
+        
+        /** Method to reset this object and deallocate all allocated data.
+         */
+        void reset() ;
+  
+        /** The underlying implementation of this object.
+         */
+        RendererImpl impl ;
+    };
+
+    template<typename Type>
+    void Computer::bind( const char* name, const nyx::Array<vkg::Vulkan, Type>& array )
+    {
+      this->impl.bind( name, array ) ;
+    }
+  }
+}
@@ -38,6 +38,9 @@
 #include <unordered_map>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <vector>
+#include <algorithm>
 
 namespace nyx
 {
@@ -60,8 +63,15 @@ namespace nyx
      * @return The vulkan flag equivalient
      */
     static vk::DescriptorType convert( nyx::UniformType flags ) ;
+    
+    /** The most sets any single chained pool is grown to.
+     */
+    static constexpr unsigned long long MAX_POOL_SETS = 1024 ;
 
-    struct DescriptorPoolData
+    /** Structure to hand out descriptor sets of a single layout out of a growing chain of vulkan pools.
+     * Sets given back are kept on a free list and handed out again before any pool is touched.
+     */
+    struct DescriptorAllocator
     {
       struct Uniform
       {
@@ -71,26 +81,80 @@ namespace nyx
       };
 
       using UniformMap = std::unordered_map<std::string, Uniform> ;
+      using Pools      = std::vector<vk::DescriptorPool>          ;
+      using Sets       = std::vector<vk::DescriptorSet>           ;
+      using Sizes      = std::vector<vk::DescriptorPoolSize>      ;
+      
+      UniformMap              map        ;
+      vk::Device              device     ;
+      vk::DescriptorSetLayout layout     ;
+      Sizes                   sizes      ; ///< The descriptors a single set needs, per type.
+      Pools                   pools      ;
+      Sets                    free       ;
+      unsigned long long      capacity   ; ///< The amount of sets every pool in the chain holds combined.
+      unsigned                current    ; ///< The pool in the chain currently allocated out of.
+      unsigned                amount     ; ///< The amount of sets the first pool in the chain holds.
+      unsigned                generation ; ///< Bumped on every reset, so sets from before one are never recycled.
+      std::mutex              mutex      ;
+      
+      /** Default constructor.
+       */
+      DescriptorAllocator() ;
+      
+      /** Deconstructor. Destroys every pool of the chain.
+       */
+      ~DescriptorAllocator() ;
+      
+      /** Method to compute the descriptors needed per set out of the uniform map.
+       */
+      void build() ;
+      
+      /** Method to chain a new pool, twice the size of the last one.
+       * @return Whether a pool was added.
+       */
+      bool grow() ;
+      
+      /** Method to retrieve a set, recycling a released one when possible.
+       * @param generation Reference to store the generation the set was allocated in.
+       * @return The allocated set, or a null set on failure.
+       */
+      vk::DescriptorSet allocate( unsigned& generation ) ;
+      
+      /** Method to give a set back to this allocator.
+       * @param set The set to recycle.
+       * @param generation The generation the set was allocated in.
+       */
+      void release( const vk::DescriptorSet& set, unsigned generation ) ;
       
-      UniformMap              map       ;
-      nyx::vkg::Device        device    ;
-      unsigned                device_id ;
-      unsigned                amount    ;
-      vk::DescriptorPool      pool      ;
-      vk::DescriptorSetLayout layout    ;
+      /** Method to reset every pool of the chain, recycling every set at once.
+       */
+      void reset() ;
+    };
+
+    struct DescriptorPoolData
+    {
+      using Allocator = std::shared_ptr<DescriptorAllocator> ;
+      
+      Allocator        allocator ;
+      nyx::vkg::Device device    ;
+      unsigned         device_id ;
       
       /** Default constructor.
        */
       DescriptorPoolData() ;
+      
+      /** Method to swap in a fresh allocator with the same inputs, leaving sets already made on the old one.
+       */
+      void detach() ;
     };
 
     struct DescriptorData
     {
-      using UniformMap = std::unordered_map<std::string, DescriptorPoolData::Uniform> ;
-      
-      vk::DescriptorSet           set        ;
-      vk::Device                  device     ;
-      std::shared_ptr<UniformMap> parent_map ;
+      std::shared_ptr<DescriptorAllocator> allocator  ;
+      std::shared_ptr<bool>                lease      ; ///< Shared by every copy holding the set, so only the last one to reset releases it.
+      vk::DescriptorSet                    set        ;
+      vk::Device                           device     ;
+      unsigned                             generation ;
     };
 
     nyx::UniformType convert( nyx::ArrayFlags flags )
@@ -121,10 +185,153 @@ namespace nyx
       }
     }
     
+    DescriptorAllocator::DescriptorAllocator()
+    {
+      this->capacity   = 0  ;
+      this->current    = 0  ;
+      this->amount     = 20 ;
+      this->generation = 0  ;
+    }
+    
+    DescriptorAllocator::~DescriptorAllocator()
+    {
+      for( auto& pool : this->pools ) this->device.destroyDescriptorPool( pool, nullptr ) ;
+    }
+    
+    void DescriptorAllocator::build()
+    {
+      vk::DescriptorPoolSize size ;
+      
+      this->sizes.clear() ;
+      for( const auto& uniform : this->map )
+      {
+        const auto type  = nyx::vkg::convert( uniform.second.type ) ;
+        const auto count = std::max( uniform.second.size, 1u )      ;
+        auto       iter  = std::find_if( this->sizes.begin(), this->sizes.end(), [&]( const vk::DescriptorPoolSize& entry ) { return entry.type == type ; } ) ;
+        
+        if( iter != this->sizes.end() )
+        {
+          iter->descriptorCount += count ;
+        }
+        else
+        {
+          size.setType           ( type  ) ;
+          size.setDescriptorCount( count ) ;
+          this->sizes.push_back( size ) ;
+        }
+      }
+    }
+    
+    bool DescriptorAllocator::grow()
+    {
+      vk::DescriptorPoolCreateInfo info   ;
+      Sizes                        scaled ;
+      
+      const unsigned long long first = std::max( this->amount, 1u )                                                 ;
+      const unsigned long long count = std::min( first << std::min<size_t>( this->pools.size(), 16 ), MAX_POOL_SETS ) ;
+      
+      if( this->sizes.empty() ) return false ;
+      
+      scaled = this->sizes ;
+      for( auto& size : scaled ) size.descriptorCount *= count ;
+      
+      // Sets are recycled through the free list instead of being freed, so pools don't need eFreeDescriptorSet.
+      info.setPoolSizeCount( scaled.size() ) ;
+      info.setPPoolSizes   ( scaled.data() ) ;
+      info.setMaxSets      ( count         ) ;
+      
+      auto result = this->device.createDescriptorPool( info, nullptr ) ;
+      vkg::Vulkan::add( result.result ) ;
+      
+      if( result.result != vk::Result::eSuccess ) return false ;
+      
+      // Reserving the whole chain up front means releasing a set never reallocates the free list.
+      this->pools.push_back( result.value ) ;
+      this->capacity += count ;
+      this->free.reserve( this->capacity ) ;
+      
+      return true ;
+    }
+    
+    vk::DescriptorSet DescriptorAllocator::allocate( unsigned& generation )
+    {
+      vk::DescriptorSetAllocateInfo info                                     ;
+      vk::DescriptorSet             set                                      ;
+      vk::Result                    result = vk::Result::eErrorOutOfPoolMemory ;
+      
+      std::lock_guard<std::mutex> lock( this->mutex ) ;
+      
+      generation = this->generation ;
+      
+      if( !this->free.empty() )
+      {
+        set = this->free.back() ;
+        this->free.pop_back() ;
+        return set ;
+      }
+      
+      if( this->sizes.empty() ) return set ;
+      
+      info.setPSetLayouts       ( &this->layout ) ;
+      info.setDescriptorSetCount( 1             ) ;
+      
+      // Walk forward through the chain, only adding a pool once every existing one is exhausted.
+      while( this->current < this->pools.size() )
+      {
+        info.setDescriptorPool( this->pools[ this->current ] ) ;
+        result = this->device.allocateDescriptorSets( &info, &set ) ;
+        
+        if( result == vk::Result::eSuccess ) return set ;
+        if( result != vk::Result::eErrorOutOfPoolMemory && result != vk::Result::eErrorFragmentedPool ) break ;
+        
+        this->current++ ;
+      }
+      
+      if( this->current == this->pools.size() && this->grow() )
+      {
+        info.setDescriptorPool( this->pools.back() ) ;
+        result = this->device.allocateDescriptorSets( &info, &set ) ;
+        
+        if( result == vk::Result::eSuccess ) return set ;
+      }
+      
+      vkg::Vulkan::add( result ) ;
+      return vk::DescriptorSet() ;
+    }
+    
+    void DescriptorAllocator::release( const vk::DescriptorSet& set, unsigned generation )
+    {
+      std::lock_guard<std::mutex> lock( this->mutex ) ;
+      
+      if( set && generation == this->generation ) this->free.push_back( set ) ;
+    }
+    
+    void DescriptorAllocator::reset()
+    {
+      std::lock_guard<std::mutex> lock( this->mutex ) ;
+      
+      for( auto& pool : this->pools ) this->device.resetDescriptorPool( pool ) ;
+      
+      this->free.clear() ;
+      this->current = 0 ;
+      this->generation++ ;
+    }
+    
     DescriptorPoolData::DescriptorPoolData()
     {
-      this->amount = 20      ;
-      this->pool   = nullptr ;
+      this->allocator = std::make_shared<DescriptorAllocator>() ;
+      this->device_id = 0                                       ;
+    }
+    
+    void DescriptorPoolData::detach()
+    {
+      auto fresh = std::make_shared<DescriptorAllocator>() ;
+      
+      fresh->map    = this->allocator->map    ;
+      fresh->layout = this->allocator->layout ;
+      fresh->amount = this->allocator->amount ;
+      
+      this->allocator = fresh ;
     }
     
     Descriptor::Descriptor()
@@ -141,11 +348,17 @@ namespace nyx
 
     Descriptor::~Descriptor()
     {
+      // Gives the set back when this is the last copy holding it, instead of losing it until the pool is reset.
+      this->reset() ;
+      
       delete this->desc_data ;
     }
 
     Descriptor& Descriptor::operator=( const Descriptor& desc )
     {
+      // Assigning from a copy of the same set keeps the lease, so only a different set lets go of this one.
+      if( this->desc_data->lease != desc.desc_data->lease ) this->reset() ;
+      
       *this->desc_data = *desc.desc_data ;
       
       return *this ;
@@ -153,20 +366,13 @@ namespace nyx
     
     void Descriptor::initialize( const vkg::DescriptorPool& pool )
     {
-      vk::DescriptorSetAllocateInfo info ;
-
-      info.setDescriptorPool    ( pool.data().pool    ) ;
-      info.setPSetLayouts       ( &pool.data().layout ) ;
-      info.setDescriptorSetCount( 1                   ) ;
+      this->reset() ;
       
-      if( pool.data().pool )
-      {
-        auto result = pool.data().device.device().allocateDescriptorSets( info ) ;
-        vkg::Vulkan::add( result.result ) ;
-        data().device     = pool.data().device.device()                                         ;
-        data().parent_map = std::make_shared<DescriptorPoolData::UniformMap>( pool.data().map ) ; 
-        data().set        = result.value[ 0 ]                                                   ;
-      }
+      // The uniform map is shared with the pool's allocator rather than copied into every descriptor.
+      data().allocator = pool.data().allocator                         ;
+      data().device    = data().allocator->device                      ;
+      data().set       = data().allocator->allocate( data().generation ) ;
+      data().lease     = std::make_shared<bool>( true )                 ;
     }
 
     const vk::DescriptorSet& Descriptor::set() const
@@ -174,20 +380,33 @@ namespace nyx
       return data().set ;
     }
     
+    bool Descriptor::initialized() const
+    {
+      return static_cast<bool>( data().set ) ;
+    }
+    
     void Descriptor::reset()
     {
+      // Copies share the set, so it is only recycled once no other copy still references it.
+      if( data().allocator && data().lease.use_count() == 1 )
+      {
+        data().allocator->release( data().set, data().generation ) ;
+      }
       
+      data().allocator = nullptr ;
+      data().lease     = nullptr ;
+      data().set       = nullptr ;
     }
 
     void Descriptor::set( const char* name, const nyx::vkg::Buffer& buffer )
     {
-      if( data().parent_map )
+      if( data().allocator && data().set )
       {
-        const auto iter = data().parent_map->find( name ) ;
+        const auto iter = data().allocator->map.find( name ) ;
         vk::DescriptorBufferInfo info  ;
         vk::WriteDescriptorSet   write ;
         
-        if( iter != data().parent_map->end() )
+        if( iter != data().allocator->map.end() )
         {
           info.setBuffer( buffer.buffer() ) ;
           info.setRange ( VK_WHOLE_SIZE   ) ;
@@ -207,13 +426,13 @@ namespace nyx
 
     void Descriptor::set( const char* name, const nyx::vkg::Image& image )
     {
-      if( data().parent_map )
+      if( data().allocator && data().set )
       {
-        const auto iter = data().parent_map->find( name ) ;
+        const auto iter = data().allocator->map.find( name ) ;
         vk::DescriptorImageInfo info  ;
         vk::WriteDescriptorSet  write ;
   
-        if( iter != data().parent_map->end() )
+        if( iter != data().allocator->map.end() )
         {
           info.setImageLayout( vkg::Vulkan::convert( image.layout() ) ) ;
           info.setSampler    ( image.sampler()                        ) ;
@@ -233,14 +452,14 @@ namespace nyx
     
     void Descriptor::set( const char* name, const nyx::vkg::Image* const* images, unsigned count )
     {
-      if( data().parent_map )
+      if( data().allocator && data().set )
       {
-        const auto iter = data().parent_map->find( name ) ;
+        const auto iter = data().allocator->map.find( name ) ;
         unsigned                             amt   ;
         std::vector<vk::DescriptorImageInfo> infos ;
         vk::WriteDescriptorSet               write ;
   
-        if( iter != data().parent_map->end() )
+        if( iter != data().allocator->map.end() )
         {
           amt = count < iter->second.size ? count : iter->second.size ;
           
@@ -288,6 +507,8 @@ namespace nyx
     {
       unsigned index ;
       
+      if( !data().allocator->pools.empty() ) data().detach() ;
+      
       this->setAmount( amount ) ;
       
       if( shader.file().size() != 0 )
@@ -296,13 +517,13 @@ namespace nyx
         {
           for( index = 0; index < shader.numUniforms(); index++ )
           {
-            data().map[ shader.uniformName( index ) ] = { shader.uniformType( index ), shader.uniformSize( index ), shader.uniformBinding( index ) } ;
+            data().allocator->map[ shader.uniformName( index ) ] = { shader.uniformType( index ), shader.uniformSize( index ), shader.uniformBinding( index ) } ;
           }
         }
       
-      data().device_id = shader.device()                   ;
-      data().device    = Vulkan::device( shader.device() ) ;
-      data().layout    = shader.layout()                   ;
+      data().device_id         = shader.device()                   ;
+      data().device            = Vulkan::device( shader.device() ) ;
+      data().allocator->layout = shader.layout()                   ;
 
       this->initialize() ;
       }
@@ -310,52 +531,52 @@ namespace nyx
 
     void DescriptorPool::initialize()
     {
-      const auto flag = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet ;
-
-      vk::DescriptorPoolCreateInfo        info  ;
-      std::vector<vk::DescriptorPoolSize> sizes ;
-      vk::DescriptorPoolSize              size  ;
+      if( !data().allocator->pools.empty() ) data().detach() ;
       
-      size .setDescriptorCount( data().amount     ) ;
-      sizes.reserve           ( data().map.size() ) ;
-
-      for( const auto& uniform : data().map )
-      {
-        size.setType( nyx::vkg::convert( uniform.second.type ) ) ;
-        sizes.push_back( size ) ;
-      }
+      data().allocator->device = data().device.device() ;
+      data().allocator->build() ;
       
-      info.setPoolSizeCount( sizes.size()  ) ;
-      info.setPPoolSizes   ( sizes.data()  ) ;
-      info.setMaxSets      ( data().amount ) ;
-      info.setFlags        ( flag          ) ;
-     
-      if( info.poolSizeCount != 0 )
-      {
-        auto result = data().device.device().createDescriptorPool( info, nullptr ) ;
-        vkg::Vulkan::add( result.result ) ;
-        data().pool = result.value ;
-      }
+      // The first pool is made up front so a bad configuration is reported here instead of on the first set.
+      data().allocator->grow() ;
+    }
+    
+    void DescriptorPool::reset()
+    {
+      data().allocator->reset() ;
+    }
+    
+    unsigned DescriptorPool::numPools() const
+    {
+      return data().allocator->pools.size() ;
+    }
+    
+    bool DescriptorPool::writable( const char* name ) const
+    {
+      const auto iter = data().allocator->map.find( name ) ;
+      
+      if( iter == data().allocator->map.end() ) return true ;
+      
+      return iter->second.type != nyx::UniformType::Ubo && iter->second.type != nyx::UniformType::Sampler && iter->second.type != nyx::UniformType::InputImage ;
     }
     
     void DescriptorPool::addArrayInput( const char* name, unsigned binding, const nyx::ArrayFlags& type )
     {
-      data().map[ name ] = { nyx::vkg::convert( type ), 1, binding } ;
+      data().allocator->map[ name ] = { nyx::vkg::convert( type ), 1, binding } ;
     }
 
     void DescriptorPool::addImageInput( const char* name, unsigned binding, nyx::ImageUsage usage )
     {
-      data().map[ name ] = { nyx::vkg::convert( usage ), 1, binding } ;
+      data().allocator->map[ name ] = { nyx::vkg::convert( usage ), 1, binding } ;
     }
 
     void DescriptorPool::setLayout( const vk::DescriptorSetLayout& layout )
     {
-      data().layout = layout ;
+      data().allocator->layout = layout ;
     }
 
     void DescriptorPool::setAmount( unsigned amount )
     {
-      data().amount = amount ;
+      data().allocator->amount = amount ;
     }
 
     nyx::vkg::Descriptor DescriptorPool::make()
@@ -77,11 +77,11 @@ namespace nyx
          */
         Descriptor( const Descriptor& desc ) ;
 
-        /** Default deconstructor.
+        /** Default deconstructor. Gives the set back to it's pool if this is the last copy holding it.
          */
         ~Descriptor() ;
         
-        /** Assignment operator. Assigns this object to the input.
+        /** Assignment operator. Assigns this object to the input, first giving back this object's set if it was the last copy holding it.
          * @param desc The descriptor to assign this object to.
          * @return Reference to this object after assignment.
          */
@@ -97,7 +97,13 @@ namespace nyx
          */
         const vk::DescriptorSet& set() const ;
         
-        /** Method to reset this descriptor, if allowed.
+        /** Method to check whether this object holds a descriptor set.
+         * @return Whether this object holds a descriptor set.
+         */
+        bool initialized() const ;
+        
+        /** Method to reset this descriptor, giving its set back to the pool it was made from to be reused.
+         * @note Copies of this object share its set, so it is only given back by the last copy to be reset. It must no longer be in use on the GPU by then.
          */
         void reset() ;
 
@@ -169,8 +175,9 @@ namespace nyx
         void initialize() ;
         
         /** Method to initialize this object.
+         * @note Once the first pool of sets runs out, more are chained on, each twice the size of the last.
          * @param shader The shader to use for reflection.
-         * @param amount The amount of descriptors to create.
+         * @param amount The amount of descriptors the first pool holds.
          */
         void initialize( const nyx::vkg::NyxShader& shader, unsigned amount = 1 ) ;
         
@@ -188,11 +195,27 @@ namespace nyx
          */
         void addImageInput( const char* name, unsigned binding, nyx::ImageUsage usage ) ;
         
-        /** Method to set the amount of descriptors to generate.
-         * @param amount The amount of descriptors to be allowed to generate.
+        /** Method to set the amount of descriptors the first pool holds.
+         * @param amount The amount of descriptors the first pool holds.
          */
         void setAmount( unsigned amount ) ;
         
+        /** Method to reset every pool of this object at once, recycling every descriptor made from it.
+         * @note Meant for transient, per-frame descriptors. Every descriptor made before this call is invalidated.
+         */
+        void reset() ;
+        
+        /** Method to retrieve the amount of vulkan pools chained by this object.
+         * @return The amount of vulkan pools chained by this object.
+         */
+        unsigned numPools() const ;
+        
+        /** Method to check whether a shader using this object's descriptors may write to what is bound to a name.
+         * @param name The name of the shader variable.
+         * @return Whether the variable is writable. Uniform buffers, samplers & input images are not, while storage buffers & unknown names, like storage images, are.
+         */
+        bool writable( const char* name ) const ;
+        
         /** Method to manually set the descriptor set layout of this object.
          * @param layout The layout to set.
          */
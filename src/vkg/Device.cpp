@@ -46,6 +46,7 @@ namespace nyx
   namespace vkg
   {
     static vk::PhysicalDeviceBufferDeviceAddressFeaturesKHR ext_buffer_address  ;
+    static vk::PhysicalDeviceTimelineSemaphoreFeaturesKHR   ext_timeline        ;
     
     /** Structure to manage vulkan queue families.
      */
@@ -73,6 +74,11 @@ namespace nyx
        */
       bool graphics() ;
       
+      /** Whether or not this object can do transfers.
+       * @return Whether or not this family can do transfers.
+       */
+      bool transfer() ;
+      
       /** Whether or not this object can present to the input surface.
        * @return Whether or not this family can present to the input surface.
        */
@@ -158,6 +164,12 @@ namespace nyx
       return false ;
     }
     
+    bool QueueFamily::transfer()
+    {
+      if( this->prop->queueFlags & vk::QueueFlagBits::eTransfer ) return true ;
+      return false ;
+    }
+
     bool QueueFamily::present( vk::SurfaceKHR surface )
     {
       auto result = this->p_dev.getSurfaceSupportKHR( this->family, surface ) ;
@@ -182,7 +194,7 @@ namespace nyx
     DeviceData::DeviceData()
     {
       this->id = UINT32_MAX ;
-      this->extension_list = { "VK_KHR_buffer_device_address", "VK_KHR_swapchain" } ;
+      this->extension_list = { "VK_KHR_buffer_device_address", "VK_KHR_swapchain", "VK_KHR_timeline_semaphore" } ;
     }
 
     DeviceData& DeviceData::operator=( const DeviceData& data )
@@ -272,6 +284,7 @@ namespace nyx
       this->features.setShaderInt64                   ( true ) ;
       this->features.setFragmentStoresAndAtomics      ( true ) ;
       this->features.setVertexPipelineStoresAndAtomics( true ) ;
+      this->features.setMultiDrawIndirect             ( this->physical_device.getFeatures().multiDrawIndirect ) ;
 
       info.setQueueCreateInfoCount   ( queue_infos.size()     ) ;
       info.setPQueueCreateInfos      ( queue_infos.data()     ) ;
@@ -286,6 +299,13 @@ namespace nyx
       nyx::vkg::ext_buffer_address.setBufferDeviceAddressMultiDevice( false ) ;
       info.setPNext( static_cast<void*>( &nyx::vkg::ext_buffer_address ) ) ;
       
+      nyx::vkg::ext_buffer_address.setPNext( nullptr ) ;
+      if( std::find( this->extension_list.begin(), this->extension_list.end(), VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME ) != this->extension_list.end() )
+      {
+        nyx::vkg::ext_timeline.setTimelineSemaphore( true ) ;
+        nyx::vkg::ext_buffer_address.setPNext( static_cast<void*>( &nyx::vkg::ext_timeline ) ) ;
+      }
+      
       vkg::Vulkan::add( this->physical_device.createDevice( &info, nullptr, &this->gpu ) ) ;
       VULKAN_HPP_DEFAULT_DISPATCHER.init( this->gpu ) ;
     }
@@ -325,6 +345,7 @@ namespace nyx
           if( std::string( ext.extensionName.data() ) == std::string( requested ) )
           {
             list.push_back( std::string( ext.extensionName ) ) ;
+            break ;
           }
         }
       }
@@ -493,6 +514,31 @@ namespace nyx
       return dummy ;
     }
 
+    const nyx::vkg::Queue& Device::transferQueue() const
+    {
+      if( data().queues )
+      {
+        // Prefer a transfer-only family, as those map to the device's dedicated copy engines.
+        for( auto& family : *data().queues )
+        {
+          if( family.transfer() && !family.graphics() && !family.compute() )
+          {
+            return family.makeQueue( *this ) ;
+          }
+        }
+        
+        for( auto& family : *data().queues )
+        {
+          if( family.transfer() && !family.graphics() )
+          {
+            return family.makeQueue( *this ) ;
+          }
+        }
+      }
+      
+      return this->computeQueue() ;
+    }
+
     const ::vk::Device& Device::device() const
     {
       return data().gpu ;
@@ -507,6 +553,7 @@ namespace nyx
     {
       if( data().gpu )
       {
+        vkg::StallScope stall( "Device::wait" ) ;
         vkg::Vulkan::add( data().gpu.waitIdle() ) ;
       }
     }
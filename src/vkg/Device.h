@@ -180,9 +180,10 @@ namespace nyx
         const nyx::vkg::Queue& computeQueue() const ;
         
         /** Method to retrieve a transfer queue from the device, if available.
+         * @note Falls back to a compute queue if the device has no separate transfer family.
          * @return A const reference to the created transfer queue.
          */
-        const nyx::vkg::Queue& transferQueue() ;
+        const nyx::vkg::Queue& transferQueue() const ;
         
         /** Method to enable the Sampler Anisotropy device feature.
          * @param value Whether or not to enable the feature.
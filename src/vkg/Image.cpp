@@ -314,12 +314,12 @@ namespace nyx
       
       if( !data().preallocated )
       {
-        data().memory.initialize( data().device, data().requirements.size, data().requirements.memoryTypeBits, false ) ;
+        data().memory.initialize( data().device, data().requirements.size, data().requirements.memoryTypeBits, static_cast<unsigned>( data().requirements.alignment ), false ) ;
       }
       
       if( data().requirements.size <= data().memory.size() - data().memory.offset() )
       {
-        vkg::Vulkan::add( data().device.device().bindImageMemory( data().image, data().memory.memory(), data().memory.offset() ) ) ;
+        vkg::Vulkan::add( data().device.device().bindImageMemory( data().image, data().memory.memory(), data().memory.memory().offset() + data().memory.offset() ) ) ;
         
         data().view    = data().createView ()   ;
         data().sampler = data().createSampler() ;
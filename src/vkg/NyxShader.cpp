@@ -34,11 +34,14 @@
 #include <loaders/NyxFile.h>
 #include <library/Array.h>
 #include <library/Image.h>
+#include <library/Trace.h>
 #include <vulkan/vulkan.hpp>
 #include <map>
 #include <vector>
 #include <istream>
 #include <fstream>
+#include <algorithm>
+#include <cstdint>
 
 namespace nyx
 {
@@ -83,6 +86,28 @@ namespace nyx
      */
     static inline nyx::ShaderStage nyxStageFromVulkan( const vk::ShaderStageFlagBits& flag ) ;
 
+    /** Structure to compute the byte sizes of types declared in SPIRV.
+     */
+    struct SpirvTypes
+    {
+      using Words   = std::vector<unsigned>                             ;
+      using Members = std::map<std::pair<unsigned, unsigned>, unsigned> ;
+      
+      std::map<unsigned, Words>    types           ; ///< The operands of each type declaration, by result id. The first word is the opcode.
+      std::map<unsigned, unsigned> constants       ; ///< The value of each 32-bit integer constant, by result id.
+      std::map<unsigned, unsigned> array_strides   ; ///< The ArrayStride decoration of each array type, by result id.
+      Members                      offsets         ; ///< The Offset decoration of each struct member, by struct id & member index.
+      Members                      matrix_strides  ; ///< The MatrixStride decoration of each struct member, by struct id & member index.
+      
+      /** Method to compute the size of a type, in bytes.
+       * @param id The result id of the type.
+       * @param matrix_stride The stride between the columns of a matrix type, if known.
+       * @param depth The current depth of recursion, to guard against malformed SPIRV.
+       * @return The size of the type in bytes. 0 if it can not be computed.
+       */
+      unsigned size( unsigned id, unsigned matrix_stride = 0, unsigned depth = 0 ) const ;
+    };
+    
     struct NyxShaderData
     {
       using SPIRVMap      = std::map<vk::ShaderStageFlagBits, vk::ShaderModuleCreateInfo> ; ///< TODO
@@ -91,6 +116,7 @@ namespace nyx
       using Bindings      = std::vector<vk::VertexInputBindingDescription>                ; ///< TODO
       using Infos         = std::vector<vk::PipelineShaderStageCreateInfo>                ; ///< TODO
       using Descriptors   = std::vector<vk::DescriptorSetLayoutBinding>                   ; ///< TODO
+      using PushRanges    = std::vector<vk::PushConstantRange>                            ; ///< The push constant range of each stage.
 
       ShaderModules                          modules     ; ///< TODO
       Descriptors                            descriptors ; ///< TODO
@@ -105,11 +131,26 @@ namespace nyx
       vk::DescriptorSetLayout                layout      ; ///< TODO
       vk::PipelineVertexInputStateCreateInfo info        ; ///< TODO
       vk::VertexInputRate                    rate        ; ///< TODO
+      unsigned                               local_size[ 3 ] ; ///< The workgroup size of the compute stage, if any.
+      PushRanges                             push_ranges     ; ///< The push constant range of each stage that declares a push constant block.
       
       /** Method to parse the loaded KgFile for its shader information.
        */
       void parse() ;
       
+      /** Method to read the workgroup size of a compute stage out of it's SPIRV.
+       * @param spirv The SPIRV of the compute stage.
+       * @param count The amount of 32-bit words of SPIRV.
+       */
+      void reflect( const unsigned* spirv, unsigned count ) ;
+      
+      /** Method to read the push constant block of a stage out of it's SPIRV.
+       * @param stage The stage the SPIRV is of.
+       * @param spirv The SPIRV of the stage.
+       * @param count The amount of 32-bit words of SPIRV.
+       */
+      void reflectPushConstants( vk::ShaderStageFlagBits stage, const unsigned* spirv, unsigned count ) ;
+      
       /** Helper method for creating a Vulkan descriptor set layout 
        */
       void makeDescriptorLayout() ;
@@ -259,10 +300,180 @@ namespace nyx
     NyxShaderData::NyxShaderData()
     {
       this->rate = vk::VertexInputRate::eVertex ;
+      
+      this->local_size[ 0 ] = 1 ;
+      this->local_size[ 1 ] = 1 ;
+      this->local_size[ 2 ] = 1 ;
+    }
+    
+    void NyxShaderData::reflect( const unsigned* spirv, unsigned count )
+    {
+      const unsigned HEADER_SIZE         = 5  ;
+      const unsigned OP_EXECUTION_MODE   = 16 ;
+      const unsigned OP_FUNCTION         = 54 ;
+      const unsigned MODE_LOCAL_SIZE     = 17 ;
+      
+      unsigned words  ;
+      unsigned opcode ;
+      
+      // Execution modes are declared ahead of every function, so stop at the first one.
+      for( unsigned index = HEADER_SIZE; index < count; index += words )
+      {
+        words  = spirv[ index ] >> 16     ;
+        opcode = spirv[ index ] &  0xFFFF ;
+        
+        if( words == 0 || opcode == OP_FUNCTION ) return ;
+        
+        if( opcode == OP_EXECUTION_MODE && words >= 6 && index + 5 < count && spirv[ index + 2 ] == MODE_LOCAL_SIZE )
+        {
+          this->local_size[ 0 ] = spirv[ index + 3 ] ;
+          this->local_size[ 1 ] = spirv[ index + 4 ] ;
+          this->local_size[ 2 ] = spirv[ index + 5 ] ;
+          return ;
+        }
+      }
+    }
+    
+    unsigned SpirvTypes::size( unsigned id, unsigned matrix_stride, unsigned depth ) const
+    {
+      const unsigned OP_TYPE_INT     = 21 ;
+      const unsigned OP_TYPE_FLOAT   = 22 ;
+      const unsigned OP_TYPE_VECTOR  = 23 ;
+      const unsigned OP_TYPE_MATRIX  = 24 ;
+      const unsigned OP_TYPE_ARRAY   = 28 ;
+      const unsigned OP_TYPE_STRUCT  = 30 ;
+      const unsigned OP_TYPE_POINTER = 32 ;
+      const unsigned MAX_DEPTH       = 16 ;
+      
+      unsigned end = 0 ;
+      
+      auto type = this->types.find( id ) ;
+      if( type == this->types.end() || depth > MAX_DEPTH ) return 0 ;
+      
+      const Words& words = type->second ;
+      switch( words[ 0 ] )
+      {
+        case OP_TYPE_INT     :
+        case OP_TYPE_FLOAT   : return words.size() > 1 ? words[ 1 ] / 8 : 0 ;
+        case OP_TYPE_POINTER : return 8 ; // Only physical storage buffer pointers can live in a push constant block.
+        case OP_TYPE_VECTOR  : return words.size() > 2 ? words[ 2 ] * this->size( words[ 1 ], 0, depth + 1 ) : 0 ;
+        case OP_TYPE_MATRIX  :
+          if( words.size() < 3 ) return 0 ;
+          return words[ 2 ] * ( matrix_stride ? matrix_stride : this->size( words[ 1 ], 0, depth + 1 ) ) ;
+        case OP_TYPE_ARRAY   :
+        {
+          if( words.size() < 3 ) return 0 ;
+          
+          auto length = this->constants    .find( words[ 2 ] ) ;
+          auto stride = this->array_strides.find( id         ) ;
+          if( length == this->constants.end() ) return 0 ;
+          
+          return length->second * ( stride != this->array_strides.end() ? stride->second : this->size( words[ 1 ], matrix_stride, depth + 1 ) ) ;
+        }
+        case OP_TYPE_STRUCT  :
+          // A struct spans up to the end of its furthest member.
+          for( unsigned member = 0; member + 1 < words.size(); member++ )
+          {
+            auto offset = this->offsets       .find( { id, member } ) ;
+            auto stride = this->matrix_strides.find( { id, member } ) ;
+            
+            const unsigned start = offset != this->offsets.end()        ? offset->second : 0 ;
+            const unsigned mat   = stride != this->matrix_strides.end() ? stride->second : 0 ;
+            
+            end = std::max( end, start + this->size( words[ member + 1 ], mat, depth + 1 ) ) ;
+          }
+          return end ;
+        default : return 0 ;
+      }
+    }
+    
+    void NyxShaderData::reflectPushConstants( vk::ShaderStageFlagBits stage, const unsigned* spirv, unsigned count )
+    {
+      const unsigned HEADER_SIZE          = 5  ;
+      const unsigned OP_DECORATE          = 71 ;
+      const unsigned OP_MEMBER_DECORATE   = 72 ;
+      const unsigned OP_TYPE_INT          = 21 ;
+      const unsigned OP_TYPE_POINTER      = 32 ;
+      const unsigned OP_CONSTANT          = 43 ;
+      const unsigned OP_VARIABLE          = 59 ;
+      const unsigned OP_FUNCTION          = 54 ;
+      const unsigned DECORATION_STRIDE    = 6  ;
+      const unsigned DECORATION_MATRIX    = 7  ;
+      const unsigned DECORATION_OFFSET    = 35 ;
+      const unsigned STORAGE_PUSH         = 9  ;
+      
+      SpirvTypes            types  ;
+      vk::PushConstantRange range  ;
+      unsigned              words  ;
+      unsigned              opcode ;
+      unsigned              block  ;
+      unsigned              start  ;
+      
+      block = 0          ;
+      start = UINT32_MAX ;
+      
+      // Annotations, types & global variables are all declared ahead of every function, so stop at the first one.
+      for( unsigned index = HEADER_SIZE; index < count; index += words )
+      {
+        words  = spirv[ index ] >> 16     ;
+        opcode = spirv[ index ] &  0xFFFF ;
+        
+        if( words == 0 || index + words > count || opcode == OP_FUNCTION ) break ;
+        
+        const unsigned* op = spirv + index ;
+        
+        if     ( opcode == OP_DECORATE        && words >= 4 && op[ 2 ] == DECORATION_STRIDE ) types.array_strides [ op[ 1 ]             ] = op[ 3 ] ;
+        else if( opcode == OP_MEMBER_DECORATE && words >= 5 && op[ 3 ] == DECORATION_OFFSET ) types.offsets       [ { op[ 1 ], op[ 2 ] } ] = op[ 4 ] ;
+        else if( opcode == OP_MEMBER_DECORATE && words >= 5 && op[ 3 ] == DECORATION_MATRIX ) types.matrix_strides[ { op[ 1 ], op[ 2 ] } ] = op[ 4 ] ;
+        else if( opcode == OP_CONSTANT        && words >= 4                                 ) types.constants     [ op[ 2 ]             ] = op[ 3 ] ;
+        else if( opcode >= OP_TYPE_INT && opcode <= OP_TYPE_POINTER && words >= 2 )
+        {
+          // Store the opcode followed by every operand after the result id.
+          SpirvTypes::Words& type = types.types[ op[ 1 ] ] ;
+          type.assign( 1, opcode ) ;
+          type.insert( type.end(), op + 2, op + words ) ;
+        }
+        else if( opcode == OP_VARIABLE && words >= 4 && op[ 3 ] == STORAGE_PUSH )
+        {
+          // The variable's type is a pointer to the block.
+          auto pointer = types.types.find( op[ 1 ] ) ;
+          if( pointer != types.types.end() && pointer->second[ 0 ] == OP_TYPE_POINTER && pointer->second.size() > 2 ) block = pointer->second[ 2 ] ;
+        }
+      }
+      
+      if( block == 0 || types.types.find( block ) == types.types.end() ) return ;
+      
+      for( unsigned member = 0; member + 1 < types.types[ block ].size(); member++ )
+      {
+        auto offset = types.offsets.find( { block, member } ) ;
+        start = std::min( start, offset != types.offsets.end() ? offset->second : 0u ) ;
+      }
+      
+      const unsigned end = types.size( block ) ;
+      if( start >= end ) return ;
+      
+      // Vulkan requires ranges to be aligned to, and sized in multiples of, 4 bytes.
+      start &= ~3u ;
+      range.setStageFlags( stage                         ) ;
+      range.setOffset    ( start                         ) ;
+      range.setSize      ( ( ( end + 3 ) & ~3u ) - start ) ;
+      
+      for( auto& existing : this->push_ranges )
+      {
+        if( existing.stageFlags == vk::ShaderStageFlags( stage ) )
+        {
+          existing = range ;
+          return ;
+        }
+      }
+      
+      this->push_ranges.push_back( range ) ;
     }
     
     void NyxShaderData::parse()
     {
+      nyx::TraceScope trace( "NyxShaderData::parse" ) ;
+      
       std::map<std::string, ::vk::DescriptorSetLayoutBinding> binding_map ;
       vk::DescriptorSetLayoutBinding                          binding     ;
       vk::ShaderModuleCreateInfo                              module_info ;
@@ -314,6 +525,9 @@ namespace nyx
         module_info.setCodeSize( iter.spirvSize() * sizeof( unsigned ) ) ;
         module_info.setPCode   ( iter.spirv()                          ) ;
         this->spirv_map[ convert( iter.stage() ) ] = module_info ;
+        
+        if( iter.stage() == nyx::ShaderStage::Compute ) this->reflect( iter.spirv(), iter.spirvSize() ) ;
+        this->reflectPushConstants( convert( iter.stage() ), iter.spirv(), iter.spirvSize() ) ;
       }
       
       index = 0 ;
@@ -515,6 +729,24 @@ namespace nyx
       info.setPCode   ( spirv ) ;
       
       data().spirv_map[ vkg::convert( stage ) ] = info ;
+      
+      if( stage == nyx::ShaderStage::Compute ) data().reflect( spirv, size / sizeof( unsigned ) ) ;
+      data().reflectPushConstants( vkg::convert( stage ), spirv, size / sizeof( unsigned ) ) ;
+    }
+    
+    unsigned NyxShader::workgroupSize( unsigned axis ) const
+    {
+      return axis < 3 ? data().local_size[ axis ] : 1 ;
+    }
+    
+    unsigned NyxShader::numPushConstantRanges() const
+    {
+      return data().push_ranges.size() ;
+    }
+    
+    const vk::PushConstantRange* NyxShader::pushConstantRanges() const
+    {
+      return data().push_ranges.data() ;
     }
     
     unsigned NyxShader::device() const
@@ -555,8 +787,11 @@ namespace nyx
       data().inputs     .clear() ;
       data().descriptors.clear() ;
       data().bindings   .clear() ;
+      data().push_ranges.clear() ;
       data().spirv_map  .clear() ;
       data().infos      .clear() ;
+      
+      std::fill( data().local_size, data().local_size + 3, 1u ) ;
     }
 
     NyxShaderData& NyxShader::data()
@@ -39,6 +39,7 @@ namespace vk
   class VertexInputBindingDescription                 ;
   class PipelineShaderStageCreateInfo                 ;
   class DescriptorSetLayout                           ;
+  class PushConstantRange                             ;
   enum class Format                                   ;
   enum class VertexInputRate                          ;
   enum class DescriptorType                           ;
@@ -201,6 +202,23 @@ namespace nyx
          * @return Const reference to the device used for this object's creation.
          */
         unsigned device() const ;
+        
+        /** Method to retrieve the workgroup size of this shader's compute stage.
+         * @param axis The axis ( 0 = x, 1 = y, 2 = z ) to retrieve the size of.
+         * @return The amount of invocations of one workgroup along the axis, or 1 if this shader has no compute stage.
+         */
+        unsigned workgroupSize( unsigned axis = 0 ) const ;
+        
+        /** Method to retrieve the amount of stages of this shader that declare a push constant block.
+         * @return The amount of push constant ranges of this shader.
+         */
+        unsigned numPushConstantRanges() const ;
+        
+        /** Method to retrieve the push constant ranges of this shader, one per stage that declares a push constant block.
+         * @note Each range spans the first to the last byte of its stage's block, as reflected from the stage's SPIRV.
+         * @return Pointer to the start of the push constant ranges of this shader.
+         */
+        const vk::PushConstantRange* pushConstantRanges() const ;
 
         /** Method to retrieve the descriptor set layout of this vulkan shader.
          * @return The descriptor set layout of this vulkan shader.
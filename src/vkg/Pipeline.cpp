@@ -34,9 +34,23 @@
 #include "RenderPass.h"
 #include "Vulkan.h"
 #include "library/Renderer.h"
+#include "library/Trace.h"
 #include "loaders/NyxFile.h"
 #include <vulkan/vulkan.hpp>
 #include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace nyx
 {
@@ -52,6 +66,8 @@ namespace nyx
       vk::PipelineInputAssemblyStateCreateInfo assembly_info          ; ///< TODO
       vk::PipelineMultisampleStateCreateInfo   multisample_info       ; ///< TODO
       vk::PipelineDepthStencilStateCreateInfo  depth_stencil_info     ;
+      vk::PipelineDynamicStateCreateInfo       dynamic_info           ;
+      std::vector<vk::DynamicState>            dynamic_states         ;
 
       std::vector<vk::PipelineColorBlendAttachmentState> color_blend_attachments ; ///< TODO
       
@@ -60,12 +76,54 @@ namespace nyx
       PipelineConfig() ;
     };
 
+    using Compilation = std::shared_future<void> ;
+    
+    /** Pool of worker threads that pipelines are compiled on.
+     * Workers are started on the first compilation, and drain every queued compilation when the pool is stopped.
+     */
+    struct CompilePool
+    {
+      std::vector<std::thread>               threads ;
+      std::deque<std::packaged_task<void()>> jobs    ;
+      std::mutex                             mutex   ;
+      std::condition_variable                cv      ;
+      bool                                   running ;
+      
+      /** Default constructor.
+       */
+      CompilePool() ;
+      
+      /** Deconstructor. Discards the queued compilations and joins the workers.
+       * @note Vulkan may already be torn down at exit, so queued compilations are only run by an explicit @stop.
+       */
+      ~CompilePool() ;
+      
+      /** Method to finish all queued compilations and join the workers. Workers are started again by the next push.
+       */
+      void stop() ;
+      
+      /** Method to queue a job onto the pool.
+       * @param job The job to run on a worker.
+       * @return The handle to wait on the job with.
+       */
+      Compilation push( std::function<void()> job ) ;
+      
+      /** Method run by each worker thread.
+       */
+      void run() ;
+    };
+    
+    /** The pool shared by every asynchronously compiled pipeline.
+     */
+    static CompilePool compile_pool ;
+    
     /** The structure to contain the underlying pipeline data.
      */
     struct PipelineData
     {
-      using Viewports = std::vector<vk::Viewport> ;
-      using Scissors  = std::vector<vk::Rect2D>   ;
+      using Viewports  = std::vector<vk::Viewport>          ;
+      using Scissors   = std::vector<vk::Rect2D>            ;
+      using PushRanges = std::vector<vk::PushConstantRange> ;
       
       const nyx::vkg::RenderPass* render_pass         ; ///< TODO
       Scissors                    scissors            ;
@@ -75,15 +133,25 @@ namespace nyx
       nyx::vkg::NyxShader*        shader              ; ///< TODO
       vk::Pipeline                pipeline            ; ///< TODO
       vk::PipelineLayout          layout              ; ///< TODO
-      vk::PipelineCache           cache               ; ///< TODO
-      vk::ShaderStageFlags        push_constant_flags ; ///< TODO
-      unsigned                    push_constant_size  ; ///< TODO
+      vk::ShaderStageFlags        push_constant_flags ; ///< The stages of the push constant range, if its size is overridden.
+      unsigned                    push_constant_size  ; ///< The overridden size of the push constant range. 0 to use the reflected range.
+      PushRanges                  push_ranges         ; ///< The push constant ranges of the pipeline layout, one per stage.
       bool                        depth_test          ;
+      bool                        async               ; ///< Whether or not pipelines are compiled on the compile pool.
+      Compilation                 pending             ; ///< The compilation in flight on the compile pool, if any. Only written by the owning thread.
 
       /** Default constructor.
        */
       PipelineData() ;
       
+      /** Helper method to create the vulkan pipeline, either now or on the compile pool.
+       */
+      void schedule() ;
+      
+      /** Helper method to block until any compilation in flight on the compile pool is done.
+       */
+      void wait() const ;
+      
       /** Helper method to create a vulkan pipeline layout.
        */
       void createLayout() ;
@@ -130,36 +198,139 @@ namespace nyx
       
       this->viewport_info.setViewportCount( 1 ) ;
       this->viewport_info.setScissorCount ( 1 ) ;
+      
+      // Viewports & scissors are set by the command buffer, so one pipeline serves every viewport configuration.
+      this->dynamic_states = { ::vk::DynamicState::eViewport, ::vk::DynamicState::eScissor } ;
 
       this->assembly_info.setTopology              ( ::vk::PrimitiveTopology::eTriangleList ) ;
       this->assembly_info.setPrimitiveRestartEnable( false                                  ) ;
     }
 
+    CompilePool::CompilePool()
+    {
+      this->running = true ;
+    }
+    
+    CompilePool::~CompilePool()
+    {
+      {
+        std::lock_guard<std::mutex> lock( this->mutex ) ;
+        this->jobs.clear() ;
+      }
+      
+      this->stop() ;
+    }
+    
+    void CompilePool::stop()
+    {
+      std::vector<std::thread> threads ;
+      
+      {
+        std::lock_guard<std::mutex> lock( this->mutex ) ;
+        this->running = false ;
+        threads.swap( this->threads ) ;
+      }
+      
+      this->cv.notify_all() ;
+      for( auto& thread : threads ) thread.join() ;
+      
+      std::lock_guard<std::mutex> lock( this->mutex ) ;
+      this->running = true ;
+    }
+    
+    Compilation CompilePool::push( std::function<void()> job )
+    {
+      std::packaged_task<void()> task( std::move( job ) ) ;
+      Compilation                handle = task.get_future().share() ;
+      
+      {
+        std::lock_guard<std::mutex> lock( this->mutex ) ;
+        
+        // Leave one core for the thread that is queueing work, as it is usually the render thread.
+        if( this->threads.empty() )
+        {
+          const unsigned count = std::max( 2u, std::thread::hardware_concurrency() ) - 1 ;
+          for( unsigned index = 0; index < count; index++ ) this->threads.emplace_back( &CompilePool::run, this ) ;
+        }
+        
+        this->jobs.push_back( std::move( task ) ) ;
+      }
+      
+      this->cv.notify_one() ;
+      return handle ;
+    }
+    
+    void CompilePool::run()
+    {
+      while( true )
+      {
+        std::packaged_task<void()> task ;
+        {
+          std::unique_lock<std::mutex> lock( this->mutex ) ;
+          this->cv.wait( lock, [this] { return !this->running || !this->jobs.empty() ; } ) ;
+          
+          if( this->jobs.empty() ) return ;
+          
+          task = std::move( this->jobs.front() ) ;
+          this->jobs.pop_front() ;
+        }
+        
+        task() ;
+      }
+    }
+    
     PipelineData::PipelineData()
     {
-      this->push_constant_size  = 256                                                                                                       ;
+      this->push_constant_size  = 0                                                                                                         ;
       this->push_constant_flags = vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute ;
+      this->async               = false                                                                                                     ;
     }
 
+    void PipelineData::schedule()
+    {
+      if( this->async ) this->pending = compile_pool.push( [this] { this->createPipeline() ; } ) ;
+      else              this->createPipeline() ;
+    }
+    
+    void PipelineData::wait() const
+    {
+      // Only read here, as every thread binding this pipeline may be waiting on it at once.
+      if( this->pending.valid() && this->pending.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::ready )
+      {
+        vkg::StallScope stall( "Pipeline::wait" ) ;
+        this->pending.wait() ;
+      }
+    }
+    
     void PipelineData::createLayout()
     {
       vk::PipelineLayoutCreateInfo info        ;
-      vk::PushConstantRange        range       ;
       vk::DescriptorSetLayout      desc_layout ;
+      vk::PushConstantRange        range       ;
       
       desc_layout = this->shader->layout() ;
 
       this->config.color_blend_attachments.resize( this->shader->file().numOutputs() ) ;
       this->config.color_blend_info.setAttachments( this->config.color_blend_attachments ) ;
       
-      range.setOffset    ( 0                         ) ;
-      range.setSize      ( this->push_constant_size  ) ;
-      range.setStageFlags( this->push_constant_flags ) ;
+      this->push_ranges.clear() ;
+      if( this->push_constant_size != 0 )
+      {
+        range.setOffset    ( 0                         ) ;
+        range.setSize      ( this->push_constant_size  ) ;
+        range.setStageFlags( this->push_constant_flags ) ;
+        this->push_ranges.push_back( range ) ;
+      }
+      else
+      {
+        // Each stage keeps it's own reflected range. Pushes are made with the stages of whichever ranges hold their bytes.
+        this->push_ranges.assign( this->shader->pushConstantRanges(), this->shader->pushConstantRanges() + this->shader->numPushConstantRanges() ) ;
+      }
       
-      info.setSetLayoutCount        ( 1                                     ) ;
-      info.setPSetLayouts           ( &desc_layout                          ) ;
-      info.setPushConstantRangeCount( 1                                     ) ;
-      info.setPPushConstantRanges   ( &range                                ) ;
+      info.setSetLayoutCount        ( 1                         ) ;
+      info.setPSetLayouts           ( &desc_layout              ) ;
+      info.setPushConstantRangeCount( this->push_ranges.size()  ) ;
+      info.setPPushConstantRanges   ( this->push_ranges.data()  ) ;
       
       auto result = this->device.device().createPipelineLayout( info, nullptr ) ;
       vkg::Vulkan::add( result.result ) ;
@@ -168,6 +339,8 @@ namespace nyx
     
     void PipelineData::createPipeline()
     {
+      nyx::TraceScope trace( "PipelineData::createPipeline" ) ;
+      
       vk::GraphicsPipelineCreateInfo         graphics_info ;
       vk::ComputePipelineCreateInfo          compute_info  ;
       vk::PipelineVertexInputStateCreateInfo vertex_input  ;
@@ -179,8 +352,7 @@ namespace nyx
 
       if( this->render_pass && this->render_pass->initialized() )
       {
-        this->config.viewport_info.setPViewports( this->viewports.data() ) ;
-        this->config.viewport_info.setPScissors ( this->scissors .data() ) ;
+        this->config.dynamic_info.setDynamicStates( this->config.dynamic_states ) ;
 
         graphics_info.setPStages            ( this->shader->infos()            ) ;
         graphics_info.setStageCount         ( this->shader->numStages()        ) ;
@@ -192,8 +364,9 @@ namespace nyx
         graphics_info.setPMultisampleState  ( &this->config.multisample_info   ) ;
         graphics_info.setPColorBlendState   ( &this->config.color_blend_info   ) ;
         graphics_info.setPDepthStencilState ( &this->config.depth_stencil_info ) ;
+        graphics_info.setPDynamicState      ( &this->config.dynamic_info       ) ;
         graphics_info.setRenderPass         ( this->render_pass->pass()        ) ;
-        auto result = this->device.device().createGraphicsPipeline( this->cache, graphics_info ) ;
+        auto result = this->device.device().createGraphicsPipeline( vkg::Vulkan::pipelineCache( this->device ), graphics_info ) ;
         vkg::Vulkan::add( result.result ) ;
         this->pipeline = result.value ;
       }
@@ -202,7 +375,7 @@ namespace nyx
         compute_info.setLayout( this->layout               ) ;
         compute_info.setStage ( this->shader->infos()[ 0 ] ) ;
         
-        auto result = ( this->device.device().createComputePipeline( this->cache, compute_info ) ) ;
+        auto result = ( this->device.device().createComputePipeline( vkg::Vulkan::pipelineCache( this->device ), compute_info ) ) ;
         vkg::Vulkan::add( result.result ) ;
         this->pipeline = result.value ;
       }
@@ -222,11 +395,15 @@ namespace nyx
 
     Pipeline::~Pipeline()
     {
+      data().wait() ;
       delete this->pipeline_data ;
     }
 
     Pipeline& Pipeline::operator=( const Pipeline& pipeline )
     {
+      pipeline.data().wait() ;
+      data().wait() ;
+      
       *this->pipeline_data = *pipeline.pipeline_data ;
       
       return *this ;
@@ -234,16 +411,19 @@ namespace nyx
 
     Pipeline::operator ::vk::Pipeline&()
     {
+      data().wait() ;
       return data().pipeline ;
     }
 
     Pipeline::operator const ::vk::Pipeline&()
     {
+      data().wait() ;
       return data().pipeline ;
     }
 
     void Pipeline::initialize( unsigned device, const char* nyx_file )
     {
+      data().wait() ;
       Vulkan::initialize() ;
 
       data().shader = new nyx::vkg::NyxShader() ;
@@ -253,11 +433,12 @@ namespace nyx
       
       data().config.color_blend_info.setAttachments( data().config.color_blend_attachments ) ;
       data().createLayout() ;
-      data().createPipeline() ;
+      data().schedule() ;
     }
 
     void Pipeline::initialize( const nyx::vkg::RenderPass& pass, const char* nyx_file )
     {
+      data().wait() ;
       if( !Vulkan::initialized() ) Vulkan::initialize() ;
 
       data().shader = new nyx::vkg::NyxShader() ;
@@ -269,11 +450,12 @@ namespace nyx
       data().shader->initialize( pass.device(), nyx_file ) ;
       
       data().createLayout() ;
-      data().createPipeline() ;
+      data().schedule() ;
     }
     
     void Pipeline::initialize( unsigned device, const unsigned char* nyx_bytes, unsigned size )
     {
+      data().wait() ;
       Vulkan::initialize() ;
       
       data().shader = new nyx::vkg::NyxShader() ;
@@ -282,11 +464,12 @@ namespace nyx
       data().shader->initialize( device, nyx_bytes, size ) ;
       data().config.color_blend_info.setAttachments( data().config.color_blend_attachments ) ;
       data().createLayout() ;
-      data().createPipeline() ;
+      data().schedule() ;
     }
 
     void Pipeline::initialize( const nyx::vkg::RenderPass& pass, const unsigned char* nyx_bytes, unsigned size )
     {
+      data().wait() ;
       if( !Vulkan::initialized() ) Vulkan::initialize() ;
 
       data().render_pass = &pass                           ;
@@ -298,12 +481,98 @@ namespace nyx
       this->data().config.color_blend_attachments.resize( pass.numBindedSubpasses() ) ;
       data().config.color_blend_info.setAttachments( data().config.color_blend_attachments ) ;
       data().createLayout() ;
-      data().createPipeline() ;
+      data().schedule() ;
     }
     
     bool Pipeline::initialized() const
     {
-      return data().pipeline ;
+      // A pipeline still compiling on the pool counts as initialized, as using it blocks until it is done.
+      return data().pending.valid() || data().pipeline ;
+    }
+    
+    void Pipeline::setAsync( bool value )
+    {
+      data().async = value ;
+    }
+    
+    bool Pipeline::ready() const
+    {
+      return !data().pending.valid() || data().pending.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready ;
+    }
+    
+    void Pipeline::wait() const
+    {
+      data().wait() ;
+    }
+    
+    void Pipeline::shutdown()
+    {
+      compile_pool.stop() ;
+    }
+    
+    unsigned Pipeline::prewarm( const char* manifest_path, unsigned device, const nyx::vkg::RenderPass* pass )
+    {
+      nyx::TraceScope trace( "Pipeline::prewarm" ) ;
+      
+      std::vector<Compilation> jobs     ;
+      std::atomic<unsigned>    compiled ;
+      std::ifstream            stream   ;
+      std::string              line     ;
+      
+      compiled = 0 ;
+      stream.open( manifest_path ) ;
+      if( !stream ) return 0 ;
+      
+      Vulkan::initialize() ;
+      while( std::getline( stream, line ) )
+      {
+        std::istringstream tokens( line.substr( 0, line.find( '#' ) ) ) ;
+        std::string        path   ;
+        std::string        type   ;
+        std::string        depth  ;
+        unsigned           width  = 0 ;
+        unsigned           height = 0 ;
+        
+        if( !( tokens >> path ) ) continue ;
+        tokens >> type >> width >> height >> depth ;
+        
+        const bool graphics = type == "graphics" ;
+        if( graphics && !pass ) continue ;
+        
+        jobs.push_back( compile_pool.push( [=, &compiled]
+        {
+          nyx::vkg::NyxShader shader   ;
+          nyx::vkg::Pipeline  pipeline ;
+          nyx::Viewport       viewport ;
+          
+          shader.initialize( device, path.c_str() ) ;
+          if( graphics )
+          {
+            if( width != 0 && height != 0 )
+            {
+              viewport.setWidth ( width  ) ;
+              viewport.setHeight( height ) ;
+              pipeline.addViewport( viewport ) ;
+            }
+            
+            pipeline.setTestDepth( depth == "depth" ) ;
+            pipeline.initialize  ( *pass, shader    ) ;
+          }
+          else
+          {
+            pipeline.initialize( shader ) ;
+          }
+          
+          if( pipeline.pipeline() ) compiled++ ;
+          pipeline.reset() ;
+          shader  .reset() ;
+        } ) ) ;
+      }
+      
+      for( auto& job : jobs ) job.wait() ;
+      
+      Vulkan::savePipelineCache( device ) ;
+      return compiled ;
     }
     
     bool Pipeline::isGraphics() const
@@ -313,13 +582,14 @@ namespace nyx
 
     void Pipeline::initialize( const NyxShader& shader )
     {
+      data().wait() ;
       Vulkan::initialize() ;
 
       data().shader = const_cast<NyxShader*>( &shader ) ;
       data().device = Vulkan::device( shader.device() ) ;
       
       data().createLayout() ;
-      data().createPipeline() ;
+      data().schedule() ;
     }
     
     void Pipeline::addViewport( const nyx::Viewport& viewport )
@@ -340,9 +610,57 @@ namespace nyx
       data().viewports.push_back( view    ) ;
       data().scissors .push_back( scissor ) ;
     }
+    
+    void Pipeline::setViewport( const nyx::Viewport& viewport )
+    {
+      // Only the first viewport is recorded when binding, so a resize must replace it rather than append after it.
+      if( data().viewports.empty() )
+      {
+        this->addViewport( viewport ) ;
+        return ;
+      }
+      
+      data().viewports.resize( 1 ) ;
+      data().scissors .resize( 1 ) ;
+      
+      data().viewports[ 0 ].setWidth   ( viewport.width()    ) ;
+      data().viewports[ 0 ].setHeight  ( viewport.height()   ) ;
+      data().viewports[ 0 ].setMaxDepth( viewport.maxDepth() ) ;
+      data().scissors [ 0 ].setExtent  ( { viewport.width(), viewport.height() } ) ;
+    }
+
+    unsigned Pipeline::numPushConstantRanges() const
+    {
+      return data().push_ranges.size() ;
+    }
+    
+    const vk::PushConstantRange* Pipeline::pushConstantRanges() const
+    {
+      return data().push_ranges.data() ;
+    }
+    
+    unsigned Pipeline::numViewports() const
+    {
+      return data().viewports.size() ;
+    }
+    
+    const vk::Viewport& Pipeline::viewport( unsigned index ) const
+    {
+      static const vk::Viewport dummy ;
+      
+      return index < data().viewports.size() ? data().viewports[ index ] : dummy ;
+    }
+    
+    const vk::Rect2D& Pipeline::scissor( unsigned index ) const
+    {
+      static const vk::Rect2D dummy ;
+      
+      return index < data().scissors.size() ? data().scissors[ index ] : dummy ;
+    }
 
     void Pipeline::initialize( const nyx::vkg::RenderPass& pass, const NyxShader& shader )
     {
+      data().wait() ;
       Vulkan::initialize() ;
 
       data().render_pass = &pass                             ;
@@ -350,21 +668,25 @@ namespace nyx
       data().shader      = const_cast<NyxShader*>( &shader ) ;
       
       data().createLayout() ;
-      data().createPipeline() ;
+      data().schedule() ;
     }
 
     void Pipeline::setPushConstanceByteSize( unsigned size )
     {
+      data().wait() ;
       data().push_constant_size = size ;
     }
     
     void Pipeline::setPushConstantStageFlag( unsigned stage )
     {
+      data().wait() ;
       data().push_constant_flags = static_cast<vk::ShaderStageFlags>( stage ) ;
     }
     
     void Pipeline::reset()
     {
+      data().wait() ;
+      data().pending = Compilation() ;
 //      data().shader.reset() ;
       if( data().pipeline ) data().device.device().destroy( data().pipeline, nullptr ) ;
       if( data().layout   ) data().device.device().destroy( data().layout  , nullptr ) ;
@@ -372,11 +694,14 @@ namespace nyx
 
     const vk::Pipeline& Pipeline::pipeline() const
     {
+      data().wait() ;
       return data().pipeline ;
     }
     
     void Pipeline::setTestDepth( bool val )
     {
+      data().wait() ;
+      
       data().depth_test = val ;
       
       if( val )
@@ -26,8 +26,11 @@
 
 namespace vk
 {
-  class PipelineLayout ;
-  class Pipeline       ;
+  class  PipelineLayout    ;
+  class  Pipeline          ;
+  struct Viewport          ;
+  struct Rect2D            ;
+  struct PushConstantRange ;
 }
 
 namespace nyx
@@ -115,16 +118,59 @@ namespace nyx
          * @return 
          */
         bool initialized() const ;
+        
+        /** Method to set whether this pipeline is compiled on the compile pool instead of the calling thread.
+         * An asynchronous initialize() returns immediately. Anything that needs the compiled pipeline blocks until it is ready.
+         * @param value Whether or not to compile this pipeline asynchronously.
+         */
+        void setAsync( bool value ) ;
+        
+        /** Method to check whether this pipeline is done compiling.
+         * @return Whether or not this pipeline can be used without blocking.
+         */
+        bool ready() const ;
+        
+        /** Method to block until this pipeline is done compiling.
+         */
+        void wait() const ;
+        
+        /** Static method to compile every pipeline listed in a manifest in parallel on the compile pool.
+         * Each non-empty line of the manifest describes one pipeline as: <nyx path> [compute|graphics <width> <height> [depth]].
+         * Text after a '#' is ignored. As viewports are dynamic state, the dimensions of graphics entries are optional. The compiled pipelines are released once done, leaving them in the device's pipeline cache,
+         * which is then saved to disk if a pipeline cache path is set.
+         * @param manifest_path The path to the manifest on disk.
+         * @param device The device to compile the pipelines on.
+         * @param pass The render pass to compile graphics pipelines against. Graphics entries are skipped if null.
+         * @return The amount of pipelines successfully compiled.
+         */
+        static unsigned prewarm( const char* manifest_path, unsigned device, const nyx::vkg::RenderPass* pass = nullptr ) ;
+        
+        /** Static method to finish every compilation queued on the compile pool and join it's workers.
+         * @note Called by Vulkan::reset. Compilations still queued when the program exits without it are discarded.
+         */
+        static void shutdown() ;
 
         /** Method to set the push constant size in bytes for this pipeline.
+         * @note Overrides the range reflected from the shader. A size of 0 goes back to the reflected range.
          * @return The push constant size in bytes.
          */
         void setPushConstanceByteSize( unsigned size ) ;
         
         /** Method to set the push constant pipeline bitflag.
+         * @note Only used along with a size set by setPushConstanceByteSize().
          * @param stage The stages the push constant is accessed from.
          */
         void setPushConstantStageFlag( unsigned stage ) ;
+        
+        /** Method to retrieve the number of push constant ranges of this pipeline's layout.
+         * @return The amount of push constant ranges. One per stage declaring a push constant block, or one if the size is overridden.
+         */
+        unsigned numPushConstantRanges() const ;
+        
+        /** Method to retrieve the push constant ranges of this pipeline's layout, as reflected from the shader.
+         * @return Pointer to the start of this pipeline's push constant ranges.
+         */
+        const vk::PushConstantRange* pushConstantRanges() const ;
 
         /** Method to release all allocation by this object.
          */
@@ -140,6 +186,29 @@ namespace nyx
          */
         void addViewport( const nyx::Viewport& viewport ) ;
         
+        /** Method to set this pipeline's viewport, replacing the first one added.
+         * @param viewport The library viewport to use.
+         */
+        void setViewport( const nyx::Viewport& viewport ) ;
+        
+        /** Method to retrieve the amount of viewports added to this pipeline.
+         * @return The amount of viewports added to this pipeline.
+         */
+        unsigned numViewports() const ;
+        
+        /** Method to retrieve a viewport added to this pipeline.
+         * @note Viewports & scissors are dynamic state, so these are only the defaults set when this pipeline is bound.
+         * @param index The index of the viewport, in [0, numViewports()).
+         * @return Const-reference to the viewport.
+         */
+        const vk::Viewport& viewport( unsigned index = 0 ) const ;
+        
+        /** Method to retrieve the scissor of a viewport added to this pipeline.
+         * @param index The index of the viewport, in [0, numViewports()).
+         * @return Const-reference to the scissor of the viewport.
+         */
+        const vk::Rect2D& scissor( unsigned index = 0 ) const ;
+        
         /** Method to retrieve a const-reference to this object's internal vulkan pipeline.
          * @return The internal vulkan pipeline of this object.
          */
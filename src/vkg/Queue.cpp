@@ -36,15 +36,132 @@
 #include <limits>
 #include <mutex>
 #include <map>
+#include <unordered_map>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <vector>
 
 namespace nyx
 {
   namespace vkg
   {
+    /** The longest a submission thread sleeps before checking for work, in case a wake up was missed.
+     */
+    static constexpr std::chrono::milliseconds SUBMIT_THREAD_SLEEP = std::chrono::milliseconds( 1 ) ;
+    
+    /** Structure to hold a deep copy of a queue submission, so it can be submitted after the caller returns.
+     */
+    struct Submission
+    {
+      using Infos      = std::vector<vk::SubmitInfo>                     ;
+      using Timelines  = std::vector<vk::TimelineSemaphoreSubmitInfoKHR> ;
+      using Buffers    = std::vector<vk::CommandBuffer>                  ;
+      using Semaphores = std::vector<vk::Semaphore>                      ;
+      using Values     = std::vector<unsigned long long>                 ;
+      using Stages     = std::vector<vk::PipelineStageFlags>             ;
+      
+      std::atomic<Submission*> next          ; ///< The next submission in the submission thread's queue.
+      Infos                    infos         ;
+      Timelines                timelines     ;
+      Buffers                  buffers       ;
+      Semaphores               waits         ;
+      Semaphores               signals       ;
+      Values                   wait_values   ;
+      Values                   signal_values ;
+      Stages                   stages        ;
+      vk::Fence                fence         ;
+      
+      /** Default constructor.
+       */
+      Submission() ;
+      
+      /** Constructor. Deep copies the input submit infos.
+       * @note Only timeline semaphore infos are kept from each submit info's pNext chain.
+       * @param infos The submit infos to copy.
+       * @param count The amount of submit infos to copy.
+       * @param fence The fence to signal once every submit info completes.
+       */
+      Submission( const vk::SubmitInfo* infos, unsigned count, const vk::Fence& fence ) ;
+    };
+    
+    /** Structure to manage the submission thread of a vulkan queue.
+     * @note Submissions are pushed onto an intrusive, lock-free multiple-producer single-consumer queue.
+     * @note Errors from the submission thread are kept & reported on the next thread to submit to, or flush, the queue.
+     */
+    struct Submitter
+    {
+      using Errors = std::vector<vk::Result> ;
+      
+      std::atomic<Submission*>        head    ; ///< The most recently pushed submission. Shared by producers.
+      Submission*                     tail    ; ///< The oldest submission not yet popped. Owned by the submission thread.
+      Submission                      stub    ; ///< Placeholder keeping the queue non-empty.
+      std::atomic<bool>               running ;
+      std::atomic<bool>               failed  ; ///< Whether there are errors waiting to be reported.
+      std::atomic<unsigned long long> pushed  ;
+      std::atomic<unsigned long long> popped  ;
+      std::mutex                      handoff ; ///< Held while checking whether the thread is running & pushing to it.
+      std::mutex                      sleep   ;
+      std::condition_variable         wake    ;
+      std::condition_variable         flushed ; ///< Notified whenever a submission is handed to the driver.
+      Errors                          errors  ; ///< The errors of the submission thread, guarded by the sleep mutex.
+      std::thread                     thread  ;
+      vk::Queue                       queue   ;
+      std::mutex*                     mutex   ;
+      
+      /** Default constructor.
+       */
+      Submitter() ;
+      
+      /** Deconstructor. Stops the submission thread once all of it's work is submitted.
+       */
+      ~Submitter() ;
+      
+      /** Method to push a submission onto this object's queue. Safe to call from any thread.
+       * @param submission The submission to push. Owned by this object afterwards.
+       */
+      void push( Submission* submission ) ;
+      
+      /** Method to pop the oldest submission from this object's queue. Must only be called by the submission thread.
+       * @return The oldest submission, or nullptr if there is none ready.
+       */
+      Submission* pop() ;
+      
+      /** Method to submit a popped submission to this object's queue.
+       * @param submission The submission to submit & release.
+       */
+      void submit( Submission* submission ) ;
+      
+      /** Method to start this object's submission thread.
+       */
+      void start() ;
+      
+      /** Method to stop this object's submission thread, after submitting everything pushed before.
+       */
+      void stop() ;
+      
+      /** Method to wait until everything pushed so far has been submitted.
+       */
+      void flush() ;
+      
+      /** Method to report the errors of the submission thread on the calling thread.
+       */
+      void report() ;
+      
+      /** Method run by the submission thread.
+       */
+      void run() ;
+    };
+    
     /** Static mutex map for whenever queues are accessed.
      */
     static std::unordered_map<vk::Queue, std::mutex> mutex_map ;
     
+    /** Static map of the submission thread of each queue.
+     */
+    static std::unordered_map<vk::Queue, Submitter> submitter_map ;
+    
     /** Structure to encompass a Queue's internal data.
      */
     struct QueueData
@@ -53,6 +170,7 @@ namespace nyx
       vk::Queue        queue  ; ///< The underlying vulkan queue.
       unsigned         dev_id ;
       std::mutex      *mutex  ; 
+      Submitter       *thread ; ///< The submission thread shared by every object using this queue.
       vk::Device       device ; ///< The device associated with this queue.
       vk::SubmitInfo   submit ; ///< The submit structure created here for cacheing.
       vk::QueueFlags   mask   ; ///< The ID associated with this queue.
@@ -61,11 +179,316 @@ namespace nyx
       /** Default constructor.
        */
       QueueData() ;
+      
+      /** Method to flush every other queue's submission thread if any of the input batches waits on a binary semaphore.
+       * @note Binary semaphores must have their signal submitted before any wait on them, unlike timeline semaphores.
+       * @param infos The submit infos describing each batch.
+       * @param count The amount of submit infos.
+       */
+      void flushSignals( const vk::SubmitInfo* infos, unsigned count ) ;
+      
+      /** Method to wait until every other queue's submission thread has handed it's work to the driver.
+       */
+      void flushOthers() ;
+      
+      /** Method to submit work to this queue, handing it to the submission thread if there is one running.
+       * @param infos The submit infos describing each batch.
+       * @param count The amount of submit infos.
+       * @param fence The fence to signal once every batch completes.
+       */
+      void dispatch( const vk::SubmitInfo* infos, unsigned count, const vk::Fence& fence ) ;
     };
+    
+    Submission::Submission()
+    {
+      this->next = nullptr ;
+    }
+    
+    Submission::Submission( const vk::SubmitInfo* infos, unsigned count, const vk::Fence& fence )
+    {
+      unsigned num_buffers = 0 ;
+      unsigned num_waits   = 0 ;
+      unsigned num_signals = 0 ;
+      
+      this->next  = nullptr ;
+      this->fence = fence   ;
+      
+      for( unsigned index = 0; index < count; index++ )
+      {
+        num_buffers += infos[ index ].commandBufferCount   ;
+        num_waits   += infos[ index ].waitSemaphoreCount   ;
+        num_signals += infos[ index ].signalSemaphoreCount ;
+      }
+      
+      // Reserved up front, so the pointers taken below stay valid.
+      this->infos        .reserve( count       ) ;
+      this->timelines    .reserve( count       ) ;
+      this->buffers      .reserve( num_buffers ) ;
+      this->waits        .reserve( num_waits   ) ;
+      this->stages       .reserve( num_waits   ) ;
+      this->wait_values  .reserve( num_waits   ) ;
+      this->signals      .reserve( num_signals ) ;
+      this->signal_values.reserve( num_signals ) ;
+      
+      for( unsigned index = 0; index < count; index++ )
+      {
+        const vk::SubmitInfo& src      = infos[ index ]                                              ;
+        const auto*           timeline = static_cast<const vk::TimelineSemaphoreSubmitInfoKHR*>( src.pNext ) ;
+        vk::SubmitInfo        info     = src                                                         ;
+        
+        info.setPNext             ( nullptr                                    ) ;
+        info.setPCommandBuffers   ( this->buffers.data() + this->buffers.size() ) ;
+        info.setPWaitSemaphores   ( this->waits  .data() + this->waits  .size() ) ;
+        info.setPWaitDstStageMask ( this->stages .data() + this->stages .size() ) ;
+        info.setPSignalSemaphores ( this->signals.data() + this->signals.size() ) ;
+        
+        this->buffers.insert( this->buffers.end(), src.pCommandBuffers  , src.pCommandBuffers   + src.commandBufferCount   ) ;
+        this->waits  .insert( this->waits  .end(), src.pWaitSemaphores  , src.pWaitSemaphores   + src.waitSemaphoreCount   ) ;
+        this->stages .insert( this->stages .end(), src.pWaitDstStageMask, src.pWaitDstStageMask + src.waitSemaphoreCount   ) ;
+        this->signals.insert( this->signals.end(), src.pSignalSemaphores, src.pSignalSemaphores + src.signalSemaphoreCount ) ;
+        
+        if( timeline != nullptr && timeline->sType == vk::StructureType::eTimelineSemaphoreSubmitInfoKHR )
+        {
+          vk::TimelineSemaphoreSubmitInfoKHR copy ;
+          
+          copy.setWaitSemaphoreValueCount  ( timeline->waitSemaphoreValueCount                                  ) ;
+          copy.setSignalSemaphoreValueCount( timeline->signalSemaphoreValueCount                                ) ;
+          copy.setPWaitSemaphoreValues     ( this->wait_values  .data() + this->wait_values  .size() ) ;
+          copy.setPSignalSemaphoreValues   ( this->signal_values.data() + this->signal_values.size() ) ;
+          
+          this->wait_values  .insert( this->wait_values  .end(), timeline->pWaitSemaphoreValues  , timeline->pWaitSemaphoreValues   + timeline->waitSemaphoreValueCount   ) ;
+          this->signal_values.insert( this->signal_values.end(), timeline->pSignalSemaphoreValues, timeline->pSignalSemaphoreValues + timeline->signalSemaphoreValueCount ) ;
+          this->timelines.push_back( copy ) ;
+          info.setPNext( &this->timelines.back() ) ;
+        }
+        
+        this->infos.push_back( info ) ;
+      }
+    }
+    
+    Submitter::Submitter()
+    {
+      this->head    = &this->stub ;
+      this->tail    = &this->stub ;
+      this->running = false       ;
+      this->failed  = false       ;
+      this->pushed  = 0           ;
+      this->popped  = 0           ;
+      this->mutex   = nullptr     ;
+    }
+    
+    Submitter::~Submitter()
+    {
+      this->stop() ;
+    }
+    
+    void Submitter::push( Submission* submission )
+    {
+      Submission* prev ;
+      
+      submission->next.store( nullptr, std::memory_order_relaxed ) ;
+      prev = this->head.exchange( submission, std::memory_order_acq_rel ) ;
+      prev->next.store( submission, std::memory_order_release ) ;
+    }
+    
+    Submission* Submitter::pop()
+    {
+      Submission* tail = this->tail                                     ;
+      Submission* next = tail->next.load( std::memory_order_acquire ) ;
+      
+      if( tail == &this->stub )
+      {
+        if( next == nullptr ) return nullptr ;
+        
+        this->tail = next ;
+        tail       = next ;
+        next       = next->next.load( std::memory_order_acquire ) ;
+      }
+      
+      if( next != nullptr )
+      {
+        this->tail = next ;
+        return tail ;
+      }
+      
+      // A producer is between exchanging the head & linking it's submission, so try again later.
+      if( tail != this->head.load( std::memory_order_acquire ) ) return nullptr ;
+      
+      this->push( &this->stub ) ;
+      
+      next = tail->next.load( std::memory_order_acquire ) ;
+      if( next != nullptr )
+      {
+        this->tail = next ;
+        return tail ;
+      }
+      
+      return nullptr ;
+    }
+    
+    void Submitter::submit( Submission* submission )
+    {
+      vk::Result result ;
+      
+      this->mutex->lock() ;
+      result = this->queue.submit( submission->infos.size(), submission->infos.data(), submission->fence ) ;
+      this->mutex->unlock() ;
+      
+      delete submission ;
+      
+      // Error handlers are not thread-safe, so errors are handed back to the threads submitting instead of reported here.
+      {
+        std::lock_guard<std::mutex> lock( this->sleep ) ;
+        
+        if( result != vk::Result::eSuccess )
+        {
+          this->errors.push_back( result ) ;
+          this->failed = true ;
+        }
+        
+        this->popped.fetch_add( 1, std::memory_order_release ) ;
+      }
+      
+      this->flushed.notify_all() ;
+    }
+    
+    void Submitter::start()
+    {
+      std::lock_guard<std::mutex> lock( this->handoff ) ;
+      
+      if( this->running ) return ;
+      
+      if( this->thread.joinable() ) this->thread.join() ;
+      
+      this->running = true ;
+      this->thread  = std::thread( &Submitter::run, this ) ;
+    }
+    
+    void Submitter::stop()
+    {
+      {
+        // Nothing can be pushed once this is unlocked, so the thread submits everything before it exits.
+        std::lock_guard<std::mutex> lock( this->handoff ) ;
+        
+        if( !this->running ) return ;
+        
+        this->running = false ;
+      }
+      
+      this->wake.notify_one() ;
+      if( this->thread.joinable() ) this->thread.join() ;
+      this->report() ;
+    }
+    
+    void Submitter::flush()
+    {
+      const unsigned long long target = this->pushed.load( std::memory_order_acquire ) ;
+      
+      if( this->popped.load( std::memory_order_acquire ) >= target ) return ;
+      
+      std::unique_lock<std::mutex> lock( this->sleep ) ;
+      
+      this->wake.notify_one() ;
+      this->flushed.wait( lock, [this, target]() { return this->popped.load( std::memory_order_acquire ) >= target ; } ) ;
+    }
+    
+    void Submitter::report()
+    {
+      Errors errors ;
+      
+      if( !this->failed.load( std::memory_order_acquire ) ) return ;
+      
+      {
+        std::lock_guard<std::mutex> lock( this->sleep ) ;
+        
+        errors.swap( this->errors ) ;
+        this->failed = false ;
+      }
+      
+      for( auto error : errors ) vkg::Vulkan::add( error ) ;
+    }
+    
+    void Submitter::run()
+    {
+      Submission* submission ;
+      
+      while( this->running || this->popped.load( std::memory_order_acquire ) < this->pushed.load( std::memory_order_acquire ) )
+      {
+        submission = this->pop() ;
+        
+        if( submission != nullptr )
+        {
+          this->submit( submission ) ;
+        }
+        else
+        {
+          std::unique_lock<std::mutex> lock( this->sleep ) ;
+          this->wake.wait_for( lock, SUBMIT_THREAD_SLEEP ) ;
+        }
+      }
+    }
 
     QueueData::QueueData()
     {
       this->family = UINT32_MAX ;
+      this->mutex  = nullptr    ;
+      this->thread = nullptr    ;
+    }
+    
+    void QueueData::flushSignals( const vk::SubmitInfo* infos, unsigned count )
+    {
+      bool binary = false ;
+      
+      for( unsigned index = 0; index < count && !binary; index++ )
+      {
+        const auto* timeline = static_cast<const vk::TimelineSemaphoreSubmitInfoKHR*>( infos[ index ].pNext ) ;
+        
+        if( infos[ index ].waitSemaphoreCount == 0 ) continue ;
+        
+        binary = timeline == nullptr || timeline->sType != vk::StructureType::eTimelineSemaphoreSubmitInfoKHR || timeline->waitSemaphoreValueCount == 0 ;
+      }
+      
+      // The signal may still be queued on another queue's submission thread, so it is handed to the driver first.
+      if( binary ) this->flushOthers() ;
+    }
+    
+    void QueueData::flushOthers()
+    {
+      for( auto& submitter : submitter_map )
+      {
+        if( &submitter.second != this->thread ) submitter.second.flush() ;
+      }
+    }
+    
+    void QueueData::dispatch( const vk::SubmitInfo* infos, unsigned count, const vk::Fence& fence )
+    {
+      this->flushSignals( infos, count ) ;
+      
+      if( this->thread != nullptr )
+      {
+        std::unique_lock<std::mutex> lock( this->thread->handoff ) ;
+        
+        if( this->thread->running )
+        {
+          this->thread->pushed.fetch_add( 1, std::memory_order_release ) ;
+          this->thread->push( new Submission( infos, count, fence ) ) ;
+          lock.unlock() ;
+          
+          this->thread->wake.notify_one() ;
+          this->thread->report() ;
+          return ;
+        }
+        
+        lock.unlock() ;
+        
+        // A stopping thread may still be submitting, and this must not overtake it.
+        this->thread->flush () ;
+        this->thread->report() ;
+      }
+      
+      this->mutex->lock() ;
+      vkg::Vulkan::add( this->queue.submit( count, infos, fence ) ) ;
+      this->mutex->unlock() ;
     }
 
     Queue::Queue()
@@ -132,11 +555,36 @@ namespace nyx
     
     void Queue::wait() const
     {
+      this->flush() ;
+      
+      vkg::StallScope stall( "Queue::wait" ) ;
       data().mutex->lock() ;
       vkg::Vulkan::add( data().queue.waitIdle() ) ; 
       data().mutex->unlock() ;
     }
 
+    void Queue::setThreaded( bool value )
+    {
+      if( data().thread == nullptr ) return ;
+      
+      if( value ) data().thread->start() ;
+      else        data().thread->stop () ;
+    }
+    
+    bool Queue::threaded() const
+    {
+      return data().thread != nullptr && data().thread->running ;
+    }
+    
+    void Queue::flush() const
+    {
+      if( data().thread != nullptr )
+      {
+        data().thread->flush () ;
+        data().thread->report() ;
+      }
+    }
+    
     const vk::Queue& Queue::queue() const
     {
       return data().queue ;
@@ -165,9 +613,7 @@ namespace nyx
 
       if( cmd_buff.level() == nyx::vkg::CommandBuffer::Level::Primary )
       {
-        data().mutex->lock() ;
-        vkg::Vulkan::add( data().queue.submit( 1, &data().submit, fence ) ) ;
-        data().mutex->unlock() ;
+        data().dispatch( &data().submit, 1, fence ) ;
       }
       
       cmd_buff.advance() ;
@@ -175,24 +621,43 @@ namespace nyx
     
     void Queue::submit( const nyx::vkg::CommandBuffer& cmd_buff, const nyx::vkg::Synchronization& sync )
     {
-      static const std::vector<::vk::PipelineStageFlags> flags( 100, ::vk::PipelineStageFlagBits::eAllCommands ) ;
+      const std::vector<::vk::PipelineStageFlags> flags( sync.numWaitSems(), ::vk::PipelineStageFlagBits::eAllCommands ) ;
 
+      const auto                         cmd      = cmd_buff.buffer() ;
+      vk::TimelineSemaphoreSubmitInfoKHR timeline ;
+      
       data().submit = vk::SubmitInfo() ;
       
-      data().submit.setCommandBufferCount  ( cmd_buff.size()    ) ;
-      data().submit.setPCommandBuffers     ( cmd_buff.pointer() ) ;
+      data().submit.setCommandBufferCount  ( 1                  ) ;
+      data().submit.setPCommandBuffers     ( &cmd               ) ;
       data().submit.setPSignalSemaphores   ( sync.signals()     ) ;
       data().submit.setSignalSemaphoreCount( sync.numSignals()  ) ;
       data().submit.setWaitSemaphoreCount  ( sync.numWaitSems() ) ;
       data().submit.setPWaitSemaphores     ( sync.waits()       ) ;
       data().submit.setPWaitDstStageMask   ( flags.data()       ) ;
+      
+      if( sync.timeline() )
+      {
+        timeline.setSignalSemaphoreValueCount( sync.numSignals()   ) ;
+        timeline.setPSignalSemaphoreValues   ( sync.signalValues() ) ;
+        timeline.setWaitSemaphoreValueCount  ( sync.numWaitSems()  ) ;
+        timeline.setPWaitSemaphoreValues     ( sync.waitValues()   ) ;
+        data().submit.setPNext( &timeline ) ;
+      }
 
       if( cmd_buff.level() == nyx::vkg::CommandBuffer::Level::Primary )
       {
-        data().mutex->lock() ;
-        vkg::Vulkan::add( data().queue.submit( 1, &data().submit, sync.signalFence() ) ) ;
-        data().mutex->unlock() ;
+        const vk::Fence fence = sync.signalFence() ? sync.signalFence() : cmd_buff.fence() ;
+        
+        data().dispatch( &data().submit, 1, fence ) ;
       }
+      
+      cmd_buff.advance() ;
+    }
+    
+    void Queue::submit( const vk::SubmitInfo* infos, unsigned count, const vk::Fence& fence )
+    {
+      data().dispatch( infos, count, fence ) ;
     }
     
     unsigned Queue::submit( const nyx::vkg::Swapchain& swapchain, unsigned img_index )
@@ -205,6 +670,9 @@ namespace nyx
       info.setWaitSemaphoreCount( 0                      ) ;
       info.setPWaitSemaphores   ( 0                      ) ;
       
+      // Presents must follow the submissions that render their image, so they are never handed to the submission thread.
+      this->flush() ;
+      
       data().mutex->lock() ;
       auto result = data().queue.presentKHR( &info ) ;
       data().mutex->unlock() ;
@@ -222,6 +690,11 @@ namespace nyx
       info.setWaitSemaphoreCount( sync.numWaitSems()     ) ;
       info.setPWaitSemaphores   ( sync.waits()           ) ;
       
+      // Presents must follow the submissions that render their image, so they are never handed to the submission thread.
+      // Present waits are always binary, so their signals must be handed to the driver first.
+      this->flush() ;
+      if( sync.numWaitSems() > 0 ) data().flushOthers() ;
+      
       data().mutex->lock() ;
       auto result = data().queue.presentKHR( &info ) ;
       data().mutex->unlock() ;
@@ -239,17 +712,21 @@ namespace nyx
       data().submit.setPCommandBuffers     ( &cmd_buff ) ;
 
 
-      data().mutex->lock() ;
-      vkg::Vulkan::add( data().queue.submit( 1, &data().submit, dummy ) ) ;
+      data().dispatch( &data().submit, 1, dummy ) ;
+      this->flush() ;
 
-      vkg::Vulkan::add( data().queue.waitIdle() ) ;
       // No synchronization given, must wait.
+      vkg::StallScope stall( "Queue::submit" ) ;
+      data().mutex->lock() ;
+      vkg::Vulkan::add( data().queue.waitIdle() ) ;
       data().mutex->unlock() ;
     }
     
     void Queue::submit( const vk::CommandBuffer& cmd_buff, const nyx::vkg::Synchronization& sync )
     {
-      static constexpr vk::PipelineStageFlags flags = vk::PipelineStageFlagBits::eAllCommands ;
+      const std::vector<::vk::PipelineStageFlags> flags( sync.numWaitSems(), ::vk::PipelineStageFlagBits::eAllCommands ) ;
+      
+      vk::TimelineSemaphoreSubmitInfoKHR timeline ;
       
       data().submit = vk::SubmitInfo() ;
       data().submit.setCommandBufferCount  ( 1                  ) ;
@@ -258,11 +735,18 @@ namespace nyx
       data().submit.setSignalSemaphoreCount( sync.numSignals()  ) ;
       data().submit.setWaitSemaphoreCount  ( sync.numWaitSems() ) ;
       data().submit.setPWaitSemaphores     ( sync.waits()       ) ;
-      data().submit.setPWaitDstStageMask   ( &flags             ) ;
+      data().submit.setPWaitDstStageMask   ( flags.data()       ) ;
+      
+      if( sync.timeline() )
+      {
+        timeline.setSignalSemaphoreValueCount( sync.numSignals()   ) ;
+        timeline.setPSignalSemaphoreValues   ( sync.signalValues() ) ;
+        timeline.setWaitSemaphoreValueCount  ( sync.numWaitSems()  ) ;
+        timeline.setPWaitSemaphoreValues     ( sync.waitValues()   ) ;
+        data().submit.setPNext( &timeline ) ;
+      }
 
-      data().mutex->lock() ;
-      vkg::Vulkan::add( data().queue.submit( 1, &data().submit, sync.signalFence() ) ) ;
-      data().mutex->unlock() ;
+      data().dispatch( &data().submit, 1, sync.signalFence() ) ;
     }
 
     void Queue::initialize( const nyx::vkg::Device& device, const vk::Queue& queue, unsigned queue_family, unsigned mask )
@@ -275,6 +759,10 @@ namespace nyx
       data().family = queue_family                                     ;
       data().mask   = static_cast<vk::QueueFlags>( mask )              ;
       data().mutex  = &mutex_map[ queue ]                              ;
+      data().thread = &submitter_map[ queue ]                          ;
+      
+      data().thread->queue = queue        ;
+      data().thread->mutex = data().mutex ;
       
       auto result =  data().device.createFence( fence_info, nullptr ) ;
       vkg::Vulkan::add( result.result ) ;
@@ -31,6 +31,7 @@ namespace vk
   class SubmitInfo    ;
   class Queue         ;
   class CommandBuffer ;
+  class Fence         ;
 }
 namespace nyx
 {
@@ -107,6 +108,25 @@ namespace nyx
         /** Method to wait for all operations on this queue to complete.
          */
         void wait() const ;
+        
+        /** Method to set whether submissions to this queue are handed off to a dedicated submission thread.
+         * @note Applies to every object sharing this vulkan queue. Submits then return as soon as they are queued, and the driver is called from the submission thread in the order they were made.
+         * @note Submits racing with this call are either queued before the thread stops, or made directly after it has submitted everything queued.
+         * @note Errors from the submission thread are reported through the error handler on the next thread to submit to, or flush, this queue.
+         * @note Submits waiting on binary semaphores first flush every other queue's submission thread, since their signal must be submitted first.
+         * @param value Whether or not this queue should use a submission thread.
+         */
+        void setThreaded( bool value ) ;
+        
+        /** Method to retrieve whether submissions to this queue are handed off to a dedicated submission thread.
+         * @return Whether or not this queue uses a submission thread.
+         */
+        bool threaded() const ;
+        
+        /** Method to wait on the host until every submission queued for this queue's submission thread has been handed to the driver.
+         * @note Does nothing if this queue has no submission thread.
+         */
+        void flush() const ;
 
         /** Method to retrive the library device used for this object's queue creation.
          * @return The library device used for this object's creation.
@@ -126,8 +146,9 @@ namespace nyx
         
         /** Method to submit a command to a queue.
          * @note This object handles concurrent CPU-side access to vulkan queues.
+         * @note Like the unsynchronized submit, only the current command buffer is submitted, signaling it's fence unless the sync has one.
          * @param cmd_buff The command buffer to submit.
-         * @param sync The library synchronization object to synchronize this submition.
+         * @param sync The library synchronization object to synchronize this submition. Timeline values are submitted with it's semaphores.
          */
         void submit( const nyx::vkg::CommandBuffer& cmd_buff, const nyx::vkg::Synchronization& sync ) ;
 
@@ -144,6 +165,14 @@ namespace nyx
          */
         void submit( const vk::CommandBuffer& cmd_buff, const nyx::vkg::Synchronization& sync ) ;
         
+        /** Method to submit several batches of work to a queue in a single call.
+         * @note This object handles concurrent CPU-side access to vulkan queues. The queue is only locked once for every batch.
+         * @param infos The submit infos describing each batch.
+         * @param count The amount of batches to submit. May be 0 to only signal the fence once prior work completes.
+         * @param fence The fence to signal once every batch completes.
+         */
+        void submit( const vk::SubmitInfo* infos, unsigned count, const vk::Fence& fence ) ;
+        
         /** Method to submit a swapchain present operation to this queue.
          * @param swapchain The swapchain to submit the present operation for.
          * @param img_index The image index acquired by the swapchain.
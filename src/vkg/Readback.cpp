@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * File:   Readback.cpp
+ * Author: Jordan Hendl
+ *
+ * Created on April 4, 2021, 10:15 AM
+ */
+
+#define VULKAN_HPP_NO_EXCEPTIONS
+#define VULKAN_HPP_ASSERT_ON_RESULT
+#define VULKAN_HPP_NOEXCEPT
+#define VULKAN_HPP_NOEXCEPT_WHEN_NO_EXCEPTIONS
+#define VULKAN_HPP_DISPATCH_LOADER_DYNAMIC 1
+
+#include "Readback.h"
+#include "Vulkan.h"
+#include <vulkan/vulkan.hpp>
+#include <atomic>
+#include <mutex>
+#include <cstring>
+#include <vector>
+
+namespace nyx
+{
+  namespace vkg
+  {
+    /** The time, in nanoseconds, to wait on a fence before checking if the readback was finished elsewhere.
+     */
+    static constexpr unsigned long long WAIT_SLICE = 1000000 ;
+
+    struct ReadbackData
+    {
+      /** A single range of staging memory to copy to the host.
+       */
+      struct Range
+      {
+        const unsigned char* staging ;
+        unsigned char*       host    ;
+        unsigned long long   size    ;
+      };
+      
+      std::atomic<unsigned> refs      ;
+      std::mutex            mutex     ;
+      vk::Device            device    ;
+      vk::Fence             fence     ;
+      std::vector<Range>    ranges    ;
+      bool                  submitted ;
+      bool                  complete  ;
+      
+      /** Default constructor.
+       */
+      ReadbackData() ;
+      
+      /** Method to copy the staging memory to the host, if not already done.
+       * @note Must be called with this object's mutex locked.
+       */
+      void copy() ;
+    };
+    
+    ReadbackData::ReadbackData()
+    {
+      this->refs      = 1     ;
+      this->submitted = false ;
+      this->complete  = false ;
+    }
+    
+    void ReadbackData::copy()
+    {
+      if( !this->complete )
+      {
+        for( const auto& range : this->ranges )
+        {
+          if( range.staging && range.host ) std::memcpy( range.host, range.staging, range.size ) ;
+        }
+        
+        this->complete = true ;
+      }
+    }
+
+    Readback::Readback()
+    {
+      this->readback_data = nullptr ;
+    }
+    
+    Readback::Readback( const Readback& readback )
+    {
+      this->readback_data = nullptr ;
+      *this = readback ;
+    }
+
+    Readback::~Readback()
+    {
+      if( this->readback_data && --this->readback_data->refs == 0 )
+      {
+        delete this->readback_data ;
+      }
+    }
+    
+    Readback& Readback::operator=( const Readback& readback )
+    {
+      if( this->readback_data == readback.readback_data ) return *this ;
+      
+      if( this->readback_data && --this->readback_data->refs == 0 )
+      {
+        delete this->readback_data ;
+      }
+      
+      this->readback_data = readback.readback_data ;
+      if( this->readback_data ) this->readback_data->refs++ ;
+      
+      return *this ;
+    }
+
+    bool Readback::initialized() const
+    {
+      return this->readback_data != nullptr ;
+    }
+
+    bool Readback::submitted() const
+    {
+      if( !this->readback_data ) return false ;
+      
+      std::lock_guard<std::mutex> lock( this->readback_data->mutex ) ;
+      return this->readback_data->submitted ;
+    }
+    
+    bool Readback::ready() const
+    {
+      if( !this->readback_data ) return false ;
+      
+      std::lock_guard<std::mutex> lock( this->readback_data->mutex ) ;
+      
+      if( !data().complete && data().submitted && data().device.getFenceStatus( data().fence ) == vk::Result::eSuccess )
+      {
+        this->readback_data->copy() ;
+      }
+      
+      return data().complete ;
+    }
+    
+    void Readback::wait() const
+    {
+      vk::Device device ;
+      vk::Fence  fence  ;
+      vk::Result result ;
+      
+      if( !this->readback_data ) return ;
+      
+      vkg::StallScope stall( "Readback::wait" ) ;
+      while( true )
+      {
+        this->readback_data->mutex.lock() ;
+        if( data().complete || !data().submitted )
+        {
+          this->readback_data->mutex.unlock() ;
+          return ;
+        }
+        
+        device = data().device ;
+        fence  = data().fence  ;
+        this->readback_data->mutex.unlock() ;
+        
+        // Wait in slices, as the chain may reuse & reset the fence once it finishes this readback itself.
+        result = device.waitForFences( 1, &fence, true, WAIT_SLICE ) ;
+        
+        if( result == vk::Result::eSuccess )
+        {
+          this->finish() ;
+          return ;
+        }
+        else if( result != vk::Result::eTimeout )
+        {
+          Vulkan::add( result ) ;
+          return ;
+        }
+      }
+    }
+    
+    void Readback::initialize( const void* staging, void* host, unsigned long long size )
+    {
+      if( this->readback_data && --this->readback_data->refs == 0 )
+      {
+        delete this->readback_data ;
+      }
+      
+      this->readback_data = new ReadbackData() ;
+      
+      this->append( staging, host, size ) ;
+    }
+    
+    void Readback::append( const void* staging, void* host, unsigned long long size )
+    {
+      if( !this->readback_data ) return ;
+      
+      std::lock_guard<std::mutex> lock( this->readback_data->mutex ) ;
+      data().ranges.push_back( { static_cast<const unsigned char*>( staging ), static_cast<unsigned char*>( host ), size } ) ;
+    }
+
+    void Readback::submit( const vk::Device& device, const vk::Fence& fence )
+    {
+      if( !this->readback_data ) return ;
+      
+      std::lock_guard<std::mutex> lock( this->readback_data->mutex ) ;
+      data().device    = device ;
+      data().fence     = fence  ;
+      data().submitted = true   ;
+    }
+
+    void Readback::finish() const
+    {
+      if( !this->readback_data ) return ;
+      
+      std::lock_guard<std::mutex> lock( this->readback_data->mutex ) ;
+      this->readback_data->copy() ;
+    }
+    
+    void Readback::cancel() const
+    {
+      if( !this->readback_data ) return ;
+      
+      std::lock_guard<std::mutex> lock( this->readback_data->mutex ) ;
+      this->readback_data->complete = true ;
+    }
+    
+    ReadbackData& Readback::data()
+    {
+      return *this->readback_data ;
+    }
+    
+    const ReadbackData& Readback::data() const
+    {
+      return *this->readback_data ;
+    }
+  }
+}
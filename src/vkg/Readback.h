@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * File:   Readback.h
+ * Author: Jordan Hendl
+ *
+ * Created on April 4, 2021, 10:15 AM
+ */
+
+#pragma once
+
+namespace vk
+{
+  class Device ;
+  class Fence  ;
+}
+
+namespace nyx
+{
+  namespace vkg
+  {
+    class Chain ;
+    
+    /** Class to track an asynchronous copy of GPU data back to host memory.
+     * The host copy is done only once the submission the copy was recorded in has completed on the GPU.
+     * Copies of this object refer to the same readback.
+     */
+    class Readback
+    {
+      public:
+        
+        /** Default constructor.
+         */
+        Readback() ;
+        
+        /** Copy constructor. Shares the input's readback.
+         * @param readback The readback to share.
+         */
+        Readback( const Readback& readback ) ;
+        
+        /** Default deconstructor.
+         */
+        ~Readback() ;
+        
+        /** Assignment operator. Shares the input's readback.
+         * @param readback The readback to share.
+         * @return Reference to this object after assignment.
+         */
+        Readback& operator=( const Readback& readback ) ;
+        
+        /** Method to check whether or not this object is tracking a readback.
+         * @return Whether or not this object is tracking a readback.
+         */
+        bool initialized() const ;
+        
+        /** Method to check whether or not this object's readback has been submitted to the GPU.
+         * @return Whether or not the chain this readback was recorded to has been submitted.
+         */
+        bool submitted() const ;
+        
+        /** Method to check, without blocking, whether the data has arrived in host memory.
+         * @note If the GPU work has completed, this call performs the host copy.
+         * @return Whether or not the data is available in the host pointer.
+         */
+        bool ready() const ;
+        
+        /** Method to block until the data has arrived in host memory.
+         * @note Only waits on the submission this readback was recorded in, not the whole device.
+         *       Returns immediately if the chain has not been submitted yet.
+         */
+        void wait() const ;
+
+      private:
+        friend class  Chain     ;
+        friend struct ChainData ;
+        
+        /** Method to initialize this object with the memory to copy between.
+         * @param staging The mapped staging memory the GPU writes to.
+         * @param host The host memory to copy to.
+         * @param size The size in bytes to copy.
+         */
+        void initialize( const void* staging, void* host, unsigned long long size ) ;
+        
+        /** Method to add another range to copy once this object's submission completes.
+         * @param staging The mapped staging memory the GPU writes to.
+         * @param host The host memory to copy to.
+         * @param size The size in bytes to copy.
+         */
+        void append( const void* staging, void* host, unsigned long long size ) ;
+        
+        /** Method to tie this object to the submission of it's recorded copy.
+         * @param device The device the copy was submitted on.
+         * @param fence The fence signaled when the submission completes.
+         */
+        void submit( const vk::Device& device, const vk::Fence& fence ) ;
+        
+        /** Method to perform the host copy, once the GPU work is known to have completed.
+         */
+        void finish() const ;
+        
+        /** Method to mark this object as complete without copying, if it's GPU work will never run.
+         */
+        void cancel() const ;
+
+        struct ReadbackData* readback_data ;
+        
+        ReadbackData& data() ;
+        
+        const ReadbackData& data() const ;
+    };
+  }
+}
@@ -26,24 +26,50 @@
 #include "Vulkan.h"
 #include "library/Renderer.h"
 #include <library/Image.h>
+#include "CommandBuffer.h"
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <mutex>
 
 namespace nyx
 {
   namespace vkg
   {
+    /** The amount of descriptor sets each renderer's pool starts with. Covers one Chain with the most command buffers in flight.
+     */
+    static constexpr unsigned DESCRIPTOR_VERSIONS = 8 ;
+
     struct RendererData
     {
+      /** Structure to describe the last resource bound to a name.
+       */
+      struct Binding
+      {
+        std::vector<vkg::Buffer> buffers ;
+        std::vector<vkg::Image>  images  ;
+        unsigned long long       version ;
+      };
+      
+      using Bindings    = std::map<std::string, Binding>                ;
+      using Descriptors = std::map<VkCommandBuffer, vkg::Descriptor>    ;
+      using Versions    = std::map<VkCommandBuffer, unsigned long long> ;
 
-      const vkg::RenderPass* pass            ;
-      vkg::NyxShader         shader          ;
-      vkg::Pipeline          pipeline        ;
-      vkg::DescriptorPool    pool            ;
-      vkg::Descriptor        descriptor      ;
-      unsigned               device          ;
-      unsigned               width           ;
-      unsigned               height          ;
-      unsigned               sample_count    ;
-      unsigned long long     window_id       ;
+      const vkg::RenderPass*      pass            ;
+      vkg::NyxShader              shader          ;
+      vkg::Pipeline               pipeline        ;
+      mutable vkg::DescriptorPool pool            ;
+      mutable Descriptors         descriptors     ;
+      mutable Versions            versions        ;
+      Bindings                    bindings        ;
+      unsigned long long          version         ;
+      mutable std::mutex          mutex           ;
+      unsigned                    device          ;
+      unsigned                    width           ;
+      unsigned                    height          ;
+      unsigned                    sample_count    ;
+      unsigned long long          window_id       ;
       
       RendererData() ;
       
@@ -59,19 +85,74 @@ namespace nyx
 
     RendererData::RendererData()
     {
+      this->pass            = nullptr ;
       this->sample_count    = 1   ;
       this->window_id         = 0x0 ;
+      this->version           = 0   ;
+    }
+    
+    void RendererImpl::makeDescriptors()
+    {
+      data().descriptors.clear() ;
+      data().versions   .clear() ;
+      data().bindings   .clear() ;
+      data().version = 0 ;
     }
 
+    /** Mutex guarding the registry of live renderers.
+     */
+    static std::mutex registry_mutex ;
+    
+    /** Function to retrieve every live renderer's data, so descriptors can be dropped when the command buffers they were made for are freed.
+     * @note Never destroyed, as renderers may be static objects themselves.
+     * @return Reference to the registry of live renderers.
+     */
+    static std::set<RendererData*>& registry()
+    {
+      static auto* renderers = new std::set<RendererData*>() ;
+      
+      return *renderers ;
+    }
+    
     RendererImpl::RendererImpl()
     {
       this->renderer_data = new RendererData() ;
+      
+      std::lock_guard<std::mutex> lock( registry_mutex ) ;
+      registry().insert( this->renderer_data ) ;
     }
 
     RendererImpl::~RendererImpl()
     {
+      {
+        std::lock_guard<std::mutex> lock( registry_mutex ) ;
+        registry().erase( this->renderer_data ) ;
+      }
+      
       delete this->renderer_data ;
     }
+    
+    void RendererImpl::release( const vkg::CommandBuffer& cmd )
+    {
+      std::lock_guard<std::mutex> lock( registry_mutex ) ;
+      
+      for( auto* data : registry() )
+      {
+        std::lock_guard<std::mutex> data_lock( data->mutex ) ;
+        
+        for( unsigned index = 0; index < cmd.size(); index++ )
+        {
+          const VkCommandBuffer key  = static_cast<VkCommandBuffer>( cmd.pointer()[ index ] ) ;
+          auto                  iter = data->descriptors.find( key )                            ;
+          
+          if( iter == data->descriptors.end() ) continue ;
+          
+          iter->second.reset() ;
+          data->descriptors.erase( iter ) ;
+          data->versions   .erase( key  ) ;
+        }
+      }
+    }
 
     void RendererImpl::initialize( unsigned device, const vkg::RenderPass& pass, const char* nyx_file_path )
     {
@@ -79,11 +160,11 @@ namespace nyx
       data().device = device ;
       data().pass   = &pass  ;
 
-      data().shader  .initialize( device, nyx_file_path ) ;
-      data().pipeline.initialize( pass  , data().shader ) ;
-      data().pool    .initialize( data().shader, 1      ) ;
+      data().shader  .initialize( device, nyx_file_path              ) ;
+      data().pipeline.initialize( pass  , data().shader              ) ;
+      data().pool    .initialize( data().shader, DESCRIPTOR_VERSIONS ) ;
       
-      data().descriptor = data().pool.make() ;
+      this->makeDescriptors() ;
     }
 
     void RendererImpl::initialize( unsigned device, const vkg::RenderPass& pass, const unsigned char* nyx_file_bytes, unsigned size )
@@ -91,36 +172,216 @@ namespace nyx
       data().device = device ;
       data().pass   = &pass  ;
 
-      data().shader  .initialize( device, nyx_file_bytes, size ) ;
-      data().pipeline.initialize( pass  , data().shader        ) ;
-      data().pool    .initialize( data().pipeline.shader(), 1  ) ;
+      data().shader  .initialize( device, nyx_file_bytes, size                  ) ;
+      data().pipeline.initialize( pass  , data().shader                         ) ;
+      data().pool    .initialize( data().pipeline.shader(), DESCRIPTOR_VERSIONS ) ;
+      
+      this->makeDescriptors() ;
+    }
+
+    void RendererImpl::initialize( unsigned device, const char* nyx_file_path )
+    {
+      data().device = device  ;
+      data().pass   = nullptr ;
+
+      data().shader  .initialize( device, nyx_file_path              ) ;
+      data().pipeline.initialize( data().shader                      ) ;
+      data().pool    .initialize( data().shader, DESCRIPTOR_VERSIONS ) ;
       
-      data().descriptor = data().pool.make() ;
+      this->makeDescriptors() ;
+    }
+
+    void RendererImpl::initialize( unsigned device, const unsigned char* nyx_file_bytes, unsigned size )
+    {
+      data().device = device  ;
+      data().pass   = nullptr ;
+
+      data().shader  .initialize( device, nyx_file_bytes, size       ) ;
+      data().pipeline.initialize( data().shader                      ) ;
+      data().pool    .initialize( data().shader, DESCRIPTOR_VERSIONS ) ;
+      
+      this->makeDescriptors() ;
     }
 
     void RendererImpl::bind( const char* name, const nyx::vkg::Buffer& buffer )
     {
-      Vulkan::deviceSynchronize( data().device ) ;
+      std::lock_guard<std::mutex> lock( data().mutex ) ;
+      auto& binding = data().bindings[ name ] ;
       
-      data().descriptor.set( name, buffer ) ;
+      // Only record the bind. Each descriptor picks it up once it's command buffer is no longer in flight.
+      binding.buffers.assign( 1, buffer ) ;
+      binding.images .clear() ;
+      binding.version = ++data().version ;
     }
     
     void RendererImpl::bind( const char* name, const nyx::vkg::Image& image )
     {
-      Vulkan::deviceSynchronize( data().device ) ;
+      std::lock_guard<std::mutex> lock( data().mutex ) ;
+      auto& binding = data().bindings[ name ] ;
       
-      data().descriptor.set( name, image ) ;
+      binding.images .assign( 1, image ) ;
+      binding.buffers.clear() ;
+      binding.version = ++data().version ;
     }
     
-    void RendererImpl::addViewport( const nyx::Viewport& viewport )
+    void RendererImpl::bind( const char* name, const nyx::vkg::Image* const* images, unsigned count )
+    {
+      std::lock_guard<std::mutex> lock( data().mutex ) ;
+      auto& binding = data().bindings[ name ] ;
+      
+      binding.buffers.clear() ;
+      binding.images .clear() ;
+      for( unsigned index = 0; index < count; index++ ) binding.images.push_back( *images[ index ] ) ;
+      binding.version = ++data().version ;
+    }
+    
+    const vkg::Descriptor& RendererImpl::descriptor( const vkg::CommandBuffer& cmd ) const
+    {
+      static const vkg::Descriptor dummy ;
+      const VkCommandBuffer          key = static_cast<VkCommandBuffer>( cmd.buffer() ) ;
+      std::vector<const vkg::Image*> images ;
+      
+      std::lock_guard<std::mutex> lock( data().mutex ) ;
+      
+      if( !data().pipeline.initialized() ) return dummy ;
+      
+      // Every command buffer, of every chain recording with this object, gets a set of it's own.
+      // That way a set is only ever written while the one command buffer that uses it is not in flight.
+      auto iter = data().descriptors.find( key ) ;
+      if( iter == data().descriptors.end() )
+      {
+        iter = data().descriptors.emplace( key, data().pool.make() ).first ;
+        data().versions[ key ] = 0 ;
+      }
+      
+      auto& version = data().versions[ key ] ;
+      if( version != data().version )
+      {
+        vkg::Descriptor& descriptor = iter->second ;
+        
+        for( const auto& binding : data().bindings )
+        {
+          if( binding.second.version <= version ) continue ;
+          
+          if( !binding.second.buffers.empty() )
+          {
+            descriptor.set( binding.first.c_str(), binding.second.buffers[ 0 ] ) ;
+          }
+          else if( binding.second.images.size() == 1 )
+          {
+            descriptor.set( binding.first.c_str(), binding.second.images[ 0 ] ) ;
+          }
+          else
+          {
+            images.clear() ;
+            for( const auto& image : binding.second.images ) images.push_back( &image ) ;
+            descriptor.set( binding.first.c_str(), images.data(), images.size() ) ;
+          }
+        }
+        
+        version = data().version ;
+      }
+      
+      return iter->second ;
+    }
+    
+    unsigned RendererImpl::numBuffers() const
+    {
+      unsigned count = 0 ;
+      
+      std::lock_guard<std::mutex> lock( data().mutex ) ;
+      for( const auto& binding : data().bindings ) if( !binding.second.buffers.empty() ) count++ ;
+      
+      return count ;
+    }
+    
+    const vkg::Buffer& RendererImpl::buffer( unsigned index ) const
+    {
+      static const vkg::Buffer dummy ;
+      
+      std::lock_guard<std::mutex> lock( data().mutex ) ;
+      for( const auto& binding : data().bindings )
+      {
+        if( binding.second.buffers.empty() ) continue ;
+        if( index-- == 0 ) return binding.second.buffers[ 0 ] ;
+      }
+      
+      return dummy ;
+    }
+    
+    bool RendererImpl::writes( unsigned index ) const
+    {
+      std::lock_guard<std::mutex> lock( data().mutex ) ;
+      for( const auto& binding : data().bindings )
+      {
+        if( binding.second.buffers.empty() ) continue ;
+        if( index-- == 0 ) return data().pool.writable( binding.first.c_str() ) ;
+      }
+      
+      return false ;
+    }
+    
+    unsigned RendererImpl::numImages() const
+    {
+      unsigned count = 0 ;
+      
+      std::lock_guard<std::mutex> lock( data().mutex ) ;
+      for( const auto& binding : data().bindings ) count += binding.second.images.size() ;
+      
+      return count ;
+    }
+    
+    const vkg::Image& RendererImpl::boundImage( unsigned index ) const
     {
-      data().pipeline.addViewport( viewport ) ;
+      static const vkg::Image dummy ;
       
-      if( data().pipeline.initialized() )
+      std::lock_guard<std::mutex> lock( data().mutex ) ;
+      for( const auto& binding : data().bindings )
       {
-        data().pipeline.reset() ;
-        data().pipeline.initialize( *data().pass, data().shader ) ;
+        if( index < binding.second.images.size() ) return binding.second.images[ index ] ;
+        index -= binding.second.images.size() ;
       }
+      
+      return dummy ;
+    }
+    
+    bool RendererImpl::writesImage( unsigned index ) const
+    {
+      std::lock_guard<std::mutex> lock( data().mutex ) ;
+      for( const auto& binding : data().bindings )
+      {
+        if( index < binding.second.images.size() ) return data().pool.writable( binding.first.c_str() ) ;
+        index -= binding.second.images.size() ;
+      }
+      
+      return false ;
+    }
+    
+    const vkg::Pipeline& RendererImpl::pipeline() const
+    {
+      return data().pipeline ;
+    }
+    
+    unsigned RendererImpl::workgroupSize( unsigned axis ) const
+    {
+      return data().shader.workgroupSize( axis ) ;
+    }
+    
+    void RendererImpl::addViewport( const nyx::Viewport& viewport )
+    {
+      // Viewports are dynamic state, so the pipeline picks this up the next time it is bound without being rebuilt.
+      // Only the first viewport is used when binding, so this replaces it rather than appending one that's never seen.
+      data().pipeline.setViewport( viewport ) ;
+    }
+    
+    void RendererImpl::setAsync( bool value )
+    {
+      data().pipeline.setAsync( value ) ;
+    }
+    
+    bool RendererImpl::ready() const
+    {
+      return data().pipeline.ready() ;
     }
     
     unsigned RendererImpl::device() const
@@ -152,8 +413,12 @@ namespace nyx
       Vulkan::device( data().device ).wait() ;
 
       data().pipeline .reset() ;
-      data().descriptor.reset() ;
-//      data().pool     .reset() ;
+      for( auto& descriptor : data().descriptors ) descriptor.second.reset() ;
+      
+      data().descriptors.clear() ;
+      data().versions   .clear() ;
+      data().bindings   .clear() ;
+      data().pool       .reset() ;
     }
 
     RendererData& RendererImpl::data()
@@ -181,9 +446,9 @@ namespace nyx
       return impl.data().pipeline.initialized() ;
     }
     
-    const vkg::Descriptor& Renderer::descriptor() const
+    const vkg::Descriptor& Renderer::descriptor( const vkg::CommandBuffer& cmd ) const
     {
-      return impl.data().descriptor ;
+      return impl.descriptor( cmd ) ;
     }
 
     const vkg::Pipeline& Renderer::pipeline() const
@@ -195,6 +460,16 @@ namespace nyx
     {
       this->impl.addViewport( viewport ) ;
     }
+    
+    void Renderer::setAsync( bool value )
+    {
+      this->impl.setAsync( value ) ;
+    }
+    
+    bool Renderer::ready() const
+    {
+      return this->impl.ready() ;
+    }
 
     void Renderer::bind( const char* name, const vkg::Image& image )
     {
@@ -203,9 +478,7 @@ namespace nyx
     
     void Renderer::bind( const char* name, const vkg::Image* const* images, unsigned count )
     {
-      Vulkan::deviceSynchronize( impl.data().device ) ;
-      
-      impl.data().descriptor.set( name, images, count ) ;
+      this->impl.bind( name, images, count ) ;
     }
     
     void Renderer::setTestDepth( bool val )
@@ -58,14 +58,15 @@ namespace nyx
 
   namespace vkg
   {
-    class Vulkan     ;
-    class Buffer     ;
-    class Image      ;
-    class Renderer   ;
-    class Pipeline   ;
-    class Chain      ;
-    class RenderPass ;
-    class Descriptor ;
+    class Vulkan        ;
+    class Buffer        ;
+    class Image         ;
+    class Renderer      ;
+    class Pipeline      ;
+    class Chain         ;
+    class RenderPass    ;
+    class Descriptor    ;
+    class CommandBuffer ;
     
     /* Forward declared implmentation.
      */
@@ -74,7 +75,9 @@ namespace nyx
     class RendererImpl
     {
       private:
-        friend class Renderer ;
+        friend class Renderer      ;
+        friend class Computer      ;
+        friend class CommandBuffer ;
         
         template<typename Format, typename ... Formats>
         friend void addFormat( RendererImpl& impl, Format format, Formats ... formats ) ;
@@ -89,11 +92,27 @@ namespace nyx
         /** Default deconstructor.
          */
         ~RendererImpl() ;
+        
+        /** Static method to drop the descriptors every renderer keeps for a command buffer's handles, giving their sets back to the pools.
+         * @note Called as the command buffer's handles are freed, so a later handle with the same value doesn't inherit a stale set.
+         * @param cmd The command buffer whose handles are being freed.
+         */
+        static void release( const vkg::CommandBuffer& cmd ) ;
 
-        /** Method to add a viewport to this renderer.
-         * @param viewport The viewport to add in the output of this renderer.
+        /** Method to set the viewport of this renderer, replacing any set before so that a resize takes effect.
+         * @param viewport The viewport to use in the output of this renderer.
          */
         void addViewport( const nyx::Viewport& viewport ) ;
+        
+        /** Method to set whether this object's pipeline is compiled on the compile pool instead of the calling thread.
+         * @param value Whether or not to compile this object's pipeline asynchronously.
+         */
+        void setAsync( bool value ) ;
+        
+        /** Method to check whether this object's pipeline is done compiling.
+         * @return Whether or not this object can be drawn with without blocking.
+         */
+        bool ready() const ;
 
         /** Method to initialize this object.
          * @param device The device to use for all GPU operations.
@@ -108,6 +127,19 @@ namespace nyx
          */
         void initialize( unsigned device, const vkg::RenderPass& pass, const unsigned char* nyx_file_bytes, unsigned size ) ;
   
+        /** Method to initialize this object as a compute pipeline.
+         * @param device The device to use for all GPU operations.
+         * @param nyx_file_path The path to the .nyx file on the filesystem to use.
+         */
+        void initialize( unsigned device, const char* nyx_file_path ) ;
+  
+        /** Method to initialize this object as a compute pipeline.
+         * @param device The device to use for all GPU operations.
+         * @param nyx_file_bytes The bytes of the .nyx file to use for this object.
+         * @param size The size of the bytes array.
+         */
+        void initialize( unsigned device, const unsigned char* nyx_file_bytes, unsigned size ) ;
+  
         /** Method to bind an array to one of this object's values on the GPU.
          * @param name The name associated with the value in the inputted pipeline.
          * @param buffer The vkg buffer to bind.
@@ -122,6 +154,69 @@ namespace nyx
          */
         void bind( const char* name, const nyx::vkg::Image& image ) ;
         
+        /** Method to bind an array of images to one of this object's values on the GPU.
+         * @param name The name associated with the value in the inputted pipeline.
+         * @param images The vkg images to bind.
+         * @param count The amount of images to bind.
+         */
+        void bind( const char* name, const nyx::vkg::Image* const* images, unsigned count ) ;
+        
+        /** Method to retrieve the descriptor to use for the specified command buffer, bringing it up to date with this object's binds.
+         * @note Must only be called while the command buffer is recording, so it's previous submission has completed.
+         * @param cmd The command buffer whose active buffer the descriptor is used in.
+         * @return Const reference to the descriptor.
+         */
+        const vkg::Descriptor& descriptor( const vkg::CommandBuffer& cmd ) const ;
+        
+        /** Method to (re)create the per-command buffer descriptors of this object out of it's pool.
+         */
+        void makeDescriptors() ;
+        
+        /** Method to retrieve the amount of buffers currently bound to this object.
+         * @return The amount of buffers currently bound to this object.
+         */
+        unsigned numBuffers() const ;
+        
+        /** Method to retrieve a buffer currently bound to this object.
+         * @param index The index of bound buffer to retrieve. See @numBuffers for the amount.
+         * @return Const reference to the bound buffer.
+         */
+        const vkg::Buffer& buffer( unsigned index ) const ;
+        
+        /** Method to check whether this object's shader may write to a buffer currently bound to this object.
+         * @param index The index of bound buffer to check. See @numBuffers for the amount.
+         * @return Whether the buffer is bound to a writable shader variable.
+         */
+        bool writes( unsigned index ) const ;
+        
+        /** Method to retrieve the amount of images currently bound to this object, counting every image of an array.
+         * @return The amount of images currently bound to this object.
+         */
+        unsigned numImages() const ;
+        
+        /** Method to retrieve an image currently bound to this object.
+         * @param index The index of bound image to retrieve. See @numImages for the amount.
+         * @return Const reference to the bound image.
+         */
+        const vkg::Image& boundImage( unsigned index ) const ;
+        
+        /** Method to check whether this object's shader may write to an image currently bound to this object.
+         * @param index The index of bound image to check. See @numImages for the amount.
+         * @return Whether the image is bound to a writable shader variable.
+         */
+        bool writesImage( unsigned index ) const ;
+        
+        /** Method to retrieve the pipeline of this object.
+         * @return Const reference to this object's pipeline.
+         */
+        const vkg::Pipeline& pipeline() const ;
+        
+        /** Method to retrieve the local workgroup size of this object's shader.
+         * @param axis The axis ( 0 = x, 1 = y, 2 = z ) of the workgroup to retrieve.
+         * @return The amount of invocations per workgroup along the axis.
+         */
+        unsigned workgroupSize( unsigned axis ) const ;
+        
         /** Method to retrieve the number of framebuffers generated by this renderer.
          * @return The number of framebuffers generated by this renderer.
          */
@@ -228,11 +323,21 @@ namespace nyx
         void initialize( unsigned device, const vkg::RenderPass& pass, const unsigned char* nyx_file_bytes, unsigned size ) ;
   
         bool initialized() const ;
-        /** Method to add a viewport to this renderer.
-         * @param viewport The viewport to add in the output of this renderer.
+        /** Method to set the viewport of this renderer, replacing any set before so that a resize takes effect.
+         * @param viewport The viewport to use in the output of this renderer.
          */
         void addViewport( const nyx::Viewport& viewport ) ;
         
+        /** Method to set whether this renderer's pipeline is compiled on the compile pool instead of the calling thread.
+         * @param value Whether or not to compile this renderer's pipeline asynchronously.
+         */
+        void setAsync( bool value ) ;
+        
+        /** Method to check whether this renderer's pipeline is done compiling.
+         * @return Whether or not this renderer can be drawn with without blocking.
+         */
+        bool ready() const ;
+        
         /** Method to bind an array to one of this object's values on the GPU.
          * @param name The name associated with the value in the inputted pipeline.
          * @param array The GPU array to bind to the pipeline variable.
@@ -259,7 +364,11 @@ namespace nyx
         
         void setTestDepth( bool val ) ;
         void reset() ;
-        const vkg::Descriptor& descriptor() const ;
+        /** Method to retrieve the descriptor to use for the specified command buffer.
+         * @param cmd The command buffer whose active buffer the descriptor is used in.
+         * @return Const reference to the descriptor.
+         */
+        const vkg::Descriptor& descriptor( const vkg::CommandBuffer& cmd ) const ;
         const vkg::Pipeline& pipeline() const ;
   
         /** The underlying implementation of this object.
@@ -263,8 +263,11 @@ namespace nyx
       const unsigned index = data().current_frame   ;
       if( data().fences[ index ] ) 
       {
-        vkg::Vulkan::add( device.waitForFences( 1, &data().fences[ index ], VK_TRUE, UINT64_MAX ) ) ;
-        vkg::Vulkan::add( device.resetFences( 1, &data().fences[ index ]                        ) ) ;
+        {
+          vkg::StallScope stall( "Swapchain::acquire" ) ;
+          vkg::Vulkan::add( device.waitForFences( 1, &data().fences[ index ], VK_TRUE, UINT64_MAX ) ) ;
+        }
+        vkg::Vulkan::add( device.resetFences( 1, &data().fences[ index ] ) ) ;
       }
       
       data().syncs[ index ].resetFence() ;
@@ -46,13 +46,18 @@ namespace nyx
     {
       typedef std::vector<vk::Semaphore> SemList   ; ///< TODO
       typedef std::vector<vk::Fence    > FenceList ; ///< TODO
+      typedef std::vector<unsigned long long> ValueList ; ///< The list of values of timeline semaphores.
       
       vkg::Device        device            ; ///< TODO
       vk::Fence          signal_fence      ; ///< TODO
       SemList            signal_sems       ; ///< TODO
       FenceList          wait_fences       ; ///< TODO
       SemList            wait_sems         ; ///< TODO
+      ValueList          signal_values     ; ///< The values signaled by each signal semaphore.
+      ValueList          wait_values       ; ///< The values waited on for each wait semaphore.
       bool               should_make_fence ;
+      bool               should_make_timeline ;
+      bool               timeline          ;
 
       /** Default constructor.
        */
@@ -61,7 +66,9 @@ namespace nyx
     
     SynchronizationData::SynchronizationData()
     {
-      this->should_make_fence = true ;
+      this->should_make_fence    = true  ;
+      this->should_make_timeline = false ;
+      this->timeline             = false ;
     }
 
     Synchronization::Synchronization()
@@ -103,16 +110,36 @@ namespace nyx
       data().should_make_fence = value ;
     }
     
+    void Synchronization::setTimeline( bool value )
+    {
+      data().should_make_timeline = value ;
+    }
+    
+    bool Synchronization::timeline() const
+    {
+      return data().timeline ;
+    }
+    
     void Synchronization::initialize( unsigned device, unsigned num_sems )
     {
-      vk::SemaphoreCreateInfo sem_info   ;
-      vk::FenceCreateInfo     fence_info ;
+      vk::SemaphoreCreateInfo        sem_info   ;
+      vk::SemaphoreTypeCreateInfoKHR type_info  ;
+      vk::FenceCreateInfo            fence_info ;
       
       Vulkan::initialize() ;
       
       data().device   = Vulkan::device( device ) ;
+      data().timeline = data().should_make_timeline && data().device.hasExtension( VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME ) ;
       
-      data().signal_sems.resize( num_sems   ) ;
+      data().signal_sems  .resize( num_sems    ) ;
+      data().signal_values.assign( num_sems, 0 ) ;
+      
+      if( data().timeline )
+      {
+        type_info.setSemaphoreType( vk::SemaphoreType::eTimeline ) ;
+        type_info.setInitialValue ( 0                            ) ;
+        sem_info .setPNext        ( &type_info                   ) ;
+      }
       
       fence_info.setFlags( vk::FenceCreateFlagBits::eSignaled ) ;
       
@@ -147,6 +174,39 @@ namespace nyx
       }
       
       if( sync.data().signal_fence ) data().wait_fences.push_back( sync.data().signal_fence ) ;
+      
+      data().wait_values.resize( data().wait_sems.size(), sync.value() ) ;
+    }
+    
+    void Synchronization::waitOn( const nyx::vkg::Synchronization& sync, unsigned long long value )
+    {
+      for( auto &sem : sync.data().signal_sems )
+      {
+        data().wait_sems  .push_back( sem   ) ;
+        data().wait_values.push_back( value ) ;
+      }
+    }
+    
+    unsigned long long Synchronization::advance()
+    {
+      for( auto& value : data().signal_values ) value++ ;
+      
+      return this->value() ;
+    }
+    
+    unsigned long long Synchronization::value() const
+    {
+      return data().signal_values.empty() ? 0 : data().signal_values[ 0 ] ;
+    }
+    
+    unsigned long long Synchronization::completed() const
+    {
+      if( !data().timeline || data().signal_sems.empty() ) return 0 ;
+      
+      auto result = data().device.device().getSemaphoreCounterValueKHR( data().signal_sems[ 0 ] ) ;
+      vkg::Vulkan::add( result.result ) ;
+      
+      return result.value ;
     }
 
     unsigned Synchronization::numFences() const
@@ -201,6 +261,16 @@ namespace nyx
       return data().wait_sems.data() ;
     }
 
+    const unsigned long long* Synchronization::signalValues() const
+    {
+      return data().signal_values.data() ;
+    }
+    
+    const unsigned long long* Synchronization::waitValues() const
+    {
+      return data().wait_values.data() ;
+    }
+
     const vk::Fence* Synchronization::waitFences() const
     {
       return data().wait_fences.data() ;
@@ -213,15 +283,22 @@ namespace nyx
     
     void Synchronization::swap()
     {
-      SynchronizationData::SemList tmp ;
+      SynchronizationData::SemList   tmp        ;
+      SynchronizationData::ValueList tmp_values ;
       
-      tmp                = data().wait_sems   ;
-      data().wait_sems   = data().signal_sems ;
-      data().signal_sems = tmp                ;
+      tmp                  = data().wait_sems     ;
+      tmp_values           = data().wait_values   ;
+      data().wait_sems     = data().signal_sems   ;
+      data().wait_values   = data().signal_values ;
+      data().signal_sems   = tmp                  ;
+      data().signal_values = tmp_values           ;
     }
     void Synchronization::waitOnFences()
     {
-      vkg::Vulkan::add( data().device.device().waitForFences( 1, &data().signal_fence, true, UINT64_MAX ) ) ;
+      {
+        vkg::StallScope stall( "Synchronization::waitOnFences" ) ;
+        vkg::Vulkan::add( data().device.device().waitForFences( 1, &data().signal_fence, true, UINT64_MAX ) ) ;
+      }
       vkg::Vulkan::add( data().device.device().resetFences  ( 1, &data().signal_fence                   ) ) ;
     }
     
@@ -229,6 +306,7 @@ namespace nyx
     {
       data().wait_fences.clear() ;
       data().wait_sems  .clear() ;
+      data().wait_values.clear() ;
     }
     
     void Synchronization::reset()
@@ -239,6 +317,12 @@ namespace nyx
       }
 
       data().device.device().destroy( data().signal_fence ) ;
+      
+      data().signal_sems  .clear() ;
+      data().signal_values.clear() ;
+      data().signal_fence = nullptr ;
+      data().timeline     = false   ;
+      this->clear() ;
     }
 
     SynchronizationData& Synchronization::data()
@@ -84,6 +84,17 @@ namespace nyx
          * @param value Whether or not this object should make a fence.
          */
         void setMakeFence( bool value ) ;
+        
+        /** Method to set whether or not this object's signal semaphores should be timeline semaphores when initialized.
+         * @note Falls back to binary semaphores on devices without VK_KHR_timeline_semaphore. See @timeline.
+         * @param value Whether or not this object should make timeline semaphores.
+         */
+        void setTimeline( bool value ) ;
+        
+        /** Method to check whether this object's signal semaphores are timeline semaphores.
+         * @return Whether or not this object's signal semaphores are timeline semaphores.
+         */
+        bool timeline() const ;
 
         /** Method to reset the fence of this object.
          */
@@ -94,6 +105,27 @@ namespace nyx
          */
         void waitOn( const nyx::vkg::Synchronization& sync ) ;
         
+        /** Method to add the input timeline synchronization object to be waited on by this one, until it reaches a value.
+         * @param sync The timeline synchronization object to wait on for this current object's operation.
+         * @param value The value of the input's timeline to wait for.
+         */
+        void waitOn( const nyx::vkg::Synchronization& sync, unsigned long long value ) ;
+        
+        /** Method to advance the value this object's timeline semaphores signal on their next submission.
+         * @return The value that is signaled on the next submission.
+         */
+        unsigned long long advance() ;
+        
+        /** Method to retrieve the value this object's timeline semaphores signal on their latest submission.
+         * @return The latest value this object's timeline was advanced to.
+         */
+        unsigned long long value() const ;
+        
+        /** Method to retrieve the value this object's timeline semaphore has reached on the device.
+         * @return The value the timeline semaphore was last signaled with. Always 0 for binary semaphores.
+         */
+        unsigned long long completed() const ;
+        
         /** Method to retrieve the number of fences created by this object.
          * @return The number of fences created by this object.
          */
@@ -143,6 +175,16 @@ namespace nyx
          */
         const vk::Semaphore* waits() const ;
         
+        /** Method to retrieve const pointer to the start of the values each of this object's signal semaphores signal.
+         * @return Const-pointer to the start of this object's signal values.
+         */
+        const unsigned long long* signalValues() const ;
+        
+        /** Method to retrieve const pointer to the start of the values each of this object's wait semaphores are waited on for.
+         * @return Const-pointer to the start of this object's wait values.
+         */
+        const unsigned long long* waitValues() const ;
+        
         /** Method to retrieve const pointer to the start of this object's wait fences.
          * @return Const-pointer to the start of this object's wait fences.
          */
@@ -30,13 +30,20 @@
 #include <library/Renderer.h>
 #include "library/RenderPass.h"
 #include "library/Chain.h"
+#include "library/Batch.h"
+#include "library/Trace.h"
 #include <loaders/NgtFile.h>
 #include <loaders/NyxFile.h>
 #include <binary/sheep.h>
 #include <binary/draw.h>
 #include <binary/buffer_reference.h>
 #include <binary/color_depth.h>
+#include <binary/compute.h>
 #include <vector>
+#include <thread>
+#include <fstream>
+#include <cstdio>
+#include <filesystem>
 #include <algorithm>
 #include <assert.h>
 #include <iostream>
@@ -171,6 +178,29 @@ athena::Result test_memory_offset()
   return true ;
 }
 
+athena::Result test_memory_suballocation()
+{
+  nyx::Memory<Impl>     memory1 ;
+  nyx::Memory<Impl>     memory2 ;
+  nyx::vkg::MemoryStats before  ;
+  nyx::vkg::MemoryStats after   ;
+  
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  before = Impl::memoryStats( device ) ;
+  memory1.initialize( device, sizeof( unsigned ) * 200, false ) ;
+  memory2.initialize( device, sizeof( unsigned ) * 200, false ) ;
+  after = Impl::memoryStats( device ) ;
+  
+  if( after.allocations != before.allocations + 2 ) return false ;
+  if( memory1.memory().offset() == memory2.memory().offset() ) return false ;
+  
+  memory1.deallocate() ;
+  memory2.deallocate() ;
+  
+  if( Impl::memoryStats( device ).allocations != before.allocations ) return false ;
+  return true ;
+}
+
 athena::Result test_memory_device()
 {
   nyx::Memory<Impl> memory; 
@@ -209,6 +239,51 @@ athena::Result test_memory_sync_to_host_copy()
   return true ;
 }
 
+athena::Result test_memory_mapped_noncoherent()
+{
+  nyx::Memory<Impl>     memory1 ;
+  nyx::Memory<Impl>     memory2 ;
+  std::vector<unsigned> values  ;
+  const unsigned*       result  ;
+  void*                 mapped  ;
+  
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  
+  // Cached memory is the type most likely to be non-coherent. Both land next to each other in the same block.
+  memory1.initialize( device, sizeof( unsigned ) * 200, true, nyx::MemoryFlags::HostVisible | nyx::MemoryFlags::HostCached ) ;
+  memory2.initialize( device, sizeof( unsigned ) * 200, true, nyx::MemoryFlags::HostVisible | nyx::MemoryFlags::HostCached ) ;
+  
+  mapped = memory1.memory().mapped() ;
+  if( !mapped || !memory2.memory().mapped() ) return false ;
+  
+  values.resize( 200 ) ;
+  for( unsigned index = 0; index < 200; index++ ) values[ index ] = index ;
+  
+  memory1.copyToDevice( values.data(), sizeof( unsigned ) * 200 ) ;
+  memory2.copyToDevice( values.data(), sizeof( unsigned ) * 200 ) ;
+  
+  // Overwrite a range that doesn't start or end on a non-coherent atom.
+  std::fill( values.begin() + 3, values.begin() + 13, 7777u ) ;
+  memory1.copyToDevice( values.data(), sizeof( unsigned ) * 10, sizeof( unsigned ) * 3, sizeof( unsigned ) * 3 ) ;
+  
+  memory1.syncToHost() ;
+  memory2.syncToHost() ;
+  
+  result = static_cast<const unsigned*>( memory1.hostData() ) ;
+  if( !std::equal( values.begin(), values.end(), result ) ) return false ;
+  
+  // The expanded flush of the first allocation must not have disturbed its neighbour.
+  result = static_cast<const unsigned*>( memory2.hostData() ) ;
+  for( unsigned index = 0; index < 200; index++ ) if( result[ index ] != index ) return false ;
+  
+  // The mapping is persistent, so it's the same pointer for the life of the allocation.
+  if( memory1.memory().mapped() != mapped ) return false ;
+  
+  memory1.deallocate() ;
+  memory2.deallocate() ;
+  return true ;
+}
+
 athena::Result test_array_size()
 {
   Impl::Array<float> array ;
@@ -263,6 +338,83 @@ athena::Result test_array_host_copy()
   return true ;
 }
 
+athena::Result test_array_readback()
+{
+  std::vector<unsigned> test_array        ;
+  std::vector<unsigned> test_array_result ;
+  
+  Impl::Array<unsigned> buffer   ;
+  Impl::Readback        readback ;
+  
+  nyx::Chain<Impl> chain ;
+  test_array       .resize( 500 ) ;
+  test_array_result.resize( 500 ) ;
+  
+  std::fill( test_array       .begin(), test_array       .end(), 1337 ) ;
+  std::fill( test_array_result.begin(), test_array_result.end(), 0    ) ;
+  
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  
+  buffer.initialize( device, 500                        ) ;
+  chain .initialize( device, nyx::ChainType::Compute    ) ;
+  
+  chain.copy( test_array.data(), buffer ) ;
+  readback = chain.readback( buffer, test_array_result.data() ) ;
+  
+  if( readback.submitted() ) return false ;
+  
+  chain   .submit() ;
+  readback.wait  () ;
+  
+  if( !readback.ready() ) return false ;
+  
+  for( unsigned index = 0; index < 500; index++ )
+  {
+    if( test_array_result[ index ] != 1337 )
+    {
+      return false ;
+    }
+  }
+  
+  buffer.reset() ;
+  chain .reset() ;
+  return true ;
+}
+
+athena::Result test_array_large_copy()
+{
+  // Larger than a single staging chunk, so both the upload and the readback are split.
+  const unsigned count = 3 * 1024 * 1024 ;
+  
+  std::vector<unsigned> test_array        ;
+  std::vector<unsigned> test_array_result ;
+  
+  Impl::Array<unsigned> buffer   ;
+  Impl::Readback        readback ;
+  nyx::Chain<Impl>      chain    ;
+  
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  
+  test_array       .resize( count ) ;
+  test_array_result.resize( count ) ;
+  for( unsigned index = 0; index < count; index++ ) test_array[ index ] = index ;
+  
+  buffer.initialize( device, count                   ) ;
+  chain .initialize( device, nyx::ChainType::Compute ) ;
+  
+  chain.copy( test_array.data(), buffer ) ;
+  readback = chain.readback( buffer, test_array_result.data() ) ;
+  
+  chain   .submit() ;
+  readback.wait  () ;
+  
+  if( !readback.ready() || test_array_result != test_array ) return false ;
+  
+  buffer.reset() ;
+  chain .reset() ;
+  return true ;
+}
+
 athena::Result test_array_prealloc_init()
 {
   Impl::Array<unsigned> array_1 ;
@@ -281,6 +433,565 @@ athena::Result test_array_prealloc_init()
   return true ;
 }
 
+athena::Result test_chain_record_once()
+{
+  std::vector<unsigned> test_array        ;
+  std::vector<unsigned> test_array_result ;
+  
+  Impl::Array<unsigned> src ;
+  Impl::Array<unsigned> dst ;
+  
+  nyx::Chain<Impl> chain    ;
+  nyx::Chain<Impl> readback ;
+  test_array       .resize( 500 ) ;
+  test_array_result.resize( 500 ) ;
+  
+  std::fill( test_array       .begin(), test_array       .end(), 1337 ) ;
+  std::fill( test_array_result.begin(), test_array_result.end(), 0    ) ;
+  
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  
+  src     .initialize( device, 500                     ) ;
+  dst     .initialize( device, 500                     ) ;
+  chain   .initialize( device, nyx::ChainType::Compute ) ;
+  readback.initialize( device, nyx::ChainType::Compute ) ;
+  chain   .setMode   ( nyx::ChainMode::Once            ) ;
+  
+  chain.copy( test_array.data(), src ) ;
+  chain.copy( src, dst               ) ;
+  chain.end() ;
+  
+  for( unsigned index = 0; index < 5; index++ ) chain.submit() ;
+  chain.synchronize() ;
+  
+  readback.copy( dst, test_array_result.data() ) ;
+  readback.submit     () ;
+  readback.synchronize() ;
+  
+  for( unsigned index = 0; index < 500; index++ )
+  {
+    if( test_array_result[ index ] != 1337 )
+    {
+      return false ;
+    }
+  }
+  
+  src     .reset() ;
+  dst     .reset() ;
+  chain   .reset() ;
+  readback.reset() ;
+  return true ;
+}
+
+athena::Result test_chain_parallel_record()
+{
+  constexpr unsigned NUM_THREADS = 4 ;
+  
+  std::vector<unsigned>              test_array         ;
+  std::vector<std::vector<unsigned>> test_array_results ;
+  std::vector<std::thread>           threads            ;
+  
+  nyx::Chain<Impl>      chain                 ;
+  nyx::Chain<Impl>      children[ NUM_THREADS ] ;
+  Impl::Array<unsigned> buffers [ NUM_THREADS ] ;
+  
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  
+  test_array        .resize( 500, 1337 ) ;
+  test_array_results.resize( NUM_THREADS, std::vector<unsigned>( 500, 0 ) ) ;
+  
+  chain.initialize( device, nyx::ChainType::Compute ) ;
+  for( auto& buffer : buffers ) buffer.initialize( device, 500 ) ;
+  
+  for( unsigned index = 0; index < NUM_THREADS; index++ )
+  {
+    threads.emplace_back( [&, index]()
+    {
+      children[ index ].initialize( chain ) ;
+      children[ index ].copy( test_array.data(), buffers[ index ] ) ;
+      children[ index ].end() ;
+    } ) ;
+  }
+  
+  for( auto& thread : threads ) thread.join() ;
+  for( auto& child  : children ) chain.execute( child ) ;
+  
+  chain.submit     () ;
+  chain.synchronize() ;
+  
+  for( unsigned index = 0; index < NUM_THREADS; index++ ) chain.copy( buffers[ index ], test_array_results[ index ].data() ) ;
+  chain.submit     () ;
+  chain.synchronize() ;
+  
+  for( const auto& result : test_array_results )
+  {
+    for( unsigned index = 0; index < 500; index++ )
+    {
+      if( result[ index ] != 1337 )
+      {
+        return false ;
+      }
+    }
+  }
+  
+  for( auto& buffer : buffers ) buffer.reset() ;
+  chain.reset() ;
+  return true ;
+}
+
+athena::Result test_chain_dependent_copies()
+{
+  std::vector<unsigned> test_array        ;
+  std::vector<unsigned> test_array_result ;
+  
+  Impl::Array<unsigned> first  ;
+  Impl::Array<unsigned> second ;
+  Impl::Array<unsigned> third  ;
+  
+  nyx::Chain<Impl> chain ;
+  
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  
+  test_array       .resize( 500, 1337 ) ;
+  test_array_result.resize( 500, 0    ) ;
+  
+  first .initialize( device, 500                     ) ;
+  second.initialize( device, 500                     ) ;
+  third .initialize( device, 500                     ) ;
+  chain .initialize( device, nyx::ChainType::Compute ) ;
+  
+  // Every copy reads what the one before it wrote, all in one recording.
+  chain.copy( test_array.data(), first           ) ;
+  chain.copy( first , second                     ) ;
+  chain.copy( second, third                      ) ;
+  chain.copy( third , test_array_result.data()   ) ;
+  chain.submit     () ;
+  chain.synchronize() ;
+  
+  for( unsigned index = 0; index < 500; index++ )
+  {
+    if( test_array_result[ index ] != 1337 )
+    {
+      return false ;
+    }
+  }
+  
+  first .reset() ;
+  second.reset() ;
+  third .reset() ;
+  chain .reset() ;
+  return true ;
+}
+
+athena::Result test_chain_transfer_ownership()
+{
+  std::vector<unsigned> test_array       ;
+  std::vector<unsigned> graphics_result  ;
+  std::vector<unsigned> compute_result   ;
+  
+  Impl::Array<unsigned> upload   ;
+  Impl::Array<unsigned> graphics ;
+  Impl::Array<unsigned> compute  ;
+  
+  nyx::Chain<Impl> transfer_chain ;
+  nyx::Chain<Impl> compute_upload ;
+  nyx::Chain<Impl> graphics_chain ;
+  nyx::Chain<Impl> compute_chain  ;
+  
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  
+  test_array     .resize( 500, 1337 ) ;
+  graphics_result.resize( 500, 0    ) ;
+  compute_result .resize( 500, 0    ) ;
+  
+  upload  .initialize( device, 500 ) ;
+  graphics.initialize( device, 500 ) ;
+  compute .initialize( device, 500 ) ;
+  
+  compute_upload.setTarget( nyx::ChainType::Compute ) ;
+  
+  transfer_chain.initialize( device, nyx::ChainType::Transfer ) ;
+  compute_upload.initialize( device, nyx::ChainType::Transfer ) ;
+  graphics_chain.initialize( device, nyx::ChainType::Graphics ) ;
+  compute_chain .initialize( device, nyx::ChainType::Compute  ) ;
+  
+  // The users of the upload only wait on the transfer queue on the device, never on the host.
+  transfer_chain.copy( test_array.data(), upload ) ;
+  transfer_chain.submit() ;
+  
+  graphics_chain.copy( upload, graphics                 ) ;
+  graphics_chain.copy( graphics, graphics_result.data() ) ;
+  graphics_chain.submit     () ;
+  graphics_chain.synchronize() ;
+  
+  compute_upload.copy( test_array.data(), upload ) ;
+  compute_upload.submit() ;
+  
+  compute_chain.copy( upload, compute                 ) ;
+  compute_chain.copy( compute, compute_result.data() ) ;
+  compute_chain.submit     () ;
+  compute_chain.synchronize() ;
+  
+  if( graphics_result != test_array || compute_result != test_array ) return false ;
+  
+  transfer_chain.synchronize() ;
+  compute_upload.synchronize() ;
+  
+  upload        .reset() ;
+  graphics      .reset() ;
+  compute       .reset() ;
+  transfer_chain.reset() ;
+  compute_upload.reset() ;
+  graphics_chain.reset() ;
+  compute_chain .reset() ;
+  return true ;
+}
+
+athena::Result test_chain_wait_on()
+{
+  std::vector<unsigned> test_array        ;
+  std::vector<unsigned> test_array_result ;
+  
+  Impl::Array<unsigned> first    ;
+  Impl::Array<unsigned> second   ;
+  Impl::Readback        readback ;
+  
+  nyx::Chain<Impl> upload ;
+  nyx::Chain<Impl> chain  ;
+  
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  
+  test_array       .resize( 500, 1337 ) ;
+  test_array_result.resize( 500, 0    ) ;
+  
+  first .initialize( device, 500                      ) ;
+  second.initialize( device, 500                      ) ;
+  upload.initialize( device, nyx::ChainType::Compute  ) ;
+  chain .initialize( device, nyx::ChainType::Graphics ) ;
+  
+  upload.copy( test_array.data(), first ) ;
+  upload.submit() ;
+  
+  // The second chain waits for the upload on the device, not the host.
+  chain.waitOn( upload ) ;
+  chain.copy( first, second ) ;
+  readback = chain.readback( second, test_array_result.data() ) ;
+  chain.submit() ;
+  readback.wait() ;
+  
+  if( upload.signalValue() != 1 || chain.signalValue() != 1 ) return false ;
+  
+  for( unsigned index = 0; index < 500; index++ )
+  {
+    if( test_array_result[ index ] != 1337 )
+    {
+      return false ;
+    }
+  }
+  
+  first .reset() ;
+  second.reset() ;
+  upload.reset() ;
+  chain .reset() ;
+  return true ;
+}
+
+athena::Result test_chain_is_complete()
+{
+  std::vector<unsigned> test_array ;
+  
+  Impl::Array<unsigned> buffer ;
+  nyx::Chain<Impl>      chain  ;
+  nyx::Chain<Impl>      other  ;
+  
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  
+  test_array.resize( 500, 1337 ) ;
+  
+  buffer.initialize( device, 500                     ) ;
+  chain .initialize( device, nyx::ChainType::Compute ) ;
+  other .initialize( device, nyx::ChainType::Compute ) ;
+  
+  // A chain that never submitted anything has nothing to wait on.
+  if( !other.isComplete() ) return false ;
+  
+  chain.copy( test_array.data(), buffer ) ;
+  chain.submit() ;
+  
+  other.synchronize() ;
+  chain.synchronize() ;
+  if( !chain.isComplete() ) return false ;
+  
+  buffer.reset() ;
+  chain .reset() ;
+  other .reset() ;
+  return true ;
+}
+
+athena::Result test_chain_frames_in_flight()
+{
+  // Large enough that each copy is still running on the device when the chain comes back around to it's buffer.
+  const unsigned count = 16 * 1024 * 1024 ;
+  
+  Impl::Array<unsigned> source ;
+  Impl::Array<unsigned> buffer ;
+  nyx::Chain<Impl>      chain  ;
+  
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  
+  chain .setFramesInFlight( 2 ) ;
+  source.initialize( device, count                   ) ;
+  buffer.initialize( device, count                   ) ;
+  chain .initialize( device, nyx::ChainType::Compute ) ;
+  
+  if( chain.framesInFlight() != 2 ) return false ;
+  
+  // Submitting more often than there are frames in flight forces the chain to wait on it's oldest frame.
+  for( unsigned index = 0; index < 4; index++ )
+  {
+    chain.copy( source, buffer ) ;
+    chain.submit() ;
+  }
+  
+  chain.synchronize() ;
+  if( chain.waitTime() <= 0.0f ) return false ;
+  
+  source.reset() ;
+  buffer.reset() ;
+  chain .reset() ;
+  return true ;
+}
+
+athena::Result test_chain_batch()
+{
+  std::vector<unsigned> test_array    ;
+  std::vector<unsigned> first_result  ;
+  std::vector<unsigned> second_result ;
+  
+  Impl::Array<unsigned> first           ;
+  Impl::Array<unsigned> second          ;
+  Impl::Readback        first_readback  ;
+  Impl::Readback        second_readback ;
+  nyx::Batch<Impl>      batch           ;
+  
+  nyx::Chain<Impl> first_chain  ;
+  nyx::Chain<Impl> second_chain ;
+  
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  
+  test_array   .resize( 500, 1337 ) ;
+  first_result .resize( 500, 0    ) ;
+  second_result.resize( 500, 0    ) ;
+  
+  first       .initialize( device, 500                     ) ;
+  second      .initialize( device, 500                     ) ;
+  first_chain .initialize( device, nyx::ChainType::Compute ) ;
+  second_chain.initialize( device, nyx::ChainType::Compute ) ;
+  
+  first_chain .copy( test_array.data(), first  ) ;
+  second_chain.copy( test_array.data(), second ) ;
+  first_readback  = first_chain .readback( first , first_result .data() ) ;
+  second_readback = second_chain.readback( second, second_result.data() ) ;
+  
+  // Adding a chain twice still submits it once.
+  batch.add( first_chain  ) ;
+  batch.add( second_chain ) ;
+  batch.add( second_chain ) ;
+  if( batch.size() != 2 ) return false ;
+  
+  batch.submit() ;
+  if( batch.size() != 0 ) return false ;
+  
+  first_readback .wait() ;
+  second_readback.wait() ;
+  
+  for( unsigned index = 0; index < 500; index++ )
+  {
+    if( first_result[ index ] != 1337 || second_result[ index ] != 1337 )
+    {
+      return false ;
+    }
+  }
+  
+  first_chain .synchronize() ;
+  second_chain.synchronize() ;
+  if( !first_chain.isComplete() || !second_chain.isComplete() ) return false ;
+  
+  batch       .reset() ;
+  first       .reset() ;
+  second      .reset() ;
+  first_chain .reset() ;
+  second_chain.reset() ;
+  return true ;
+}
+
+athena::Result test_queue_threaded()
+{
+  std::vector<unsigned> test_array        ;
+  std::vector<unsigned> test_array_result ;
+  
+  Impl::Array<unsigned> buffer   ;
+  Impl::Readback        readback ;
+  Impl::Queue           queues[] = { Impl::graphicsQueue( device ), Impl::computeQueue( device ), Impl::transferQueue( device ) } ;
+  nyx::Chain<Impl>      chain    ;
+  
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  
+  test_array       .resize( 500, 1337 ) ;
+  test_array_result.resize( 500, 0    ) ;
+  
+  for( auto& queue : queues ) queue.setThreaded( true ) ;
+  
+  buffer.initialize( device, 500                     ) ;
+  chain .initialize( device, nyx::ChainType::Compute ) ;
+  
+  // Submits only queue the work, so many can be made without the driver blocking this thread.
+  for( unsigned index = 0; index < 8; index++ )
+  {
+    chain.copy( test_array.data(), buffer ) ;
+    chain.submit() ;
+  }
+  
+  readback = chain.readback( buffer, test_array_result.data() ) ;
+  chain.submit() ;
+  readback.wait() ;
+  
+  for( auto& queue : queues ) queue.setThreaded( false ) ;
+  
+  for( unsigned index = 0; index < 500; index++ )
+  {
+    if( test_array_result[ index ] != 1337 )
+    {
+      return false ;
+    }
+  }
+  
+  buffer.reset() ;
+  chain .reset() ;
+  return true ;
+}
+
+athena::Result test_chain_timers()
+{
+  // Large enough that the copy spans many timestamp ticks on any device.
+  const unsigned count = 4 * 1024 * 1024 ;
+  
+  Impl::Array<unsigned> source ;
+  Impl::Array<unsigned> buffer ;
+  nyx::Chain<Impl>      chain  ;
+  
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  
+  source.initialize( device, count                   ) ;
+  buffer.initialize( device, count                   ) ;
+  chain .initialize( device, nyx::ChainType::Compute ) ;
+  
+  chain.beginTimer( "frame" ) ;
+  chain.beginTimer( "copy"  ) ;
+  chain.copy( source, buffer ) ;
+  chain.endTimer() ;
+  chain.endTimer() ;
+  chain.submit() ;
+  chain.synchronize() ;
+  
+  // Queues without valid timestamp bits leave every timer at zero.
+  if( chain.timer( "frame" ) == 0.0f ) return athena::Result::Skip ;
+  
+  if( chain.timer( "copy" ) <= 0.0f || chain.timer( "frame" ) < chain.timer( "copy" ) ) return false ;
+  if( chain.timer( "missing" ) != 0.0f                                                 ) return false ;
+  
+  source.reset() ;
+  buffer.reset() ;
+  chain .reset() ;
+  return true ;
+}
+
+athena::Result test_trace_dump()
+{
+  std::vector<unsigned> test_array ;
+  bool                  dumped     ;
+  
+  Impl::Array<unsigned> buffer ;
+  nyx::Chain<Impl>      chain  ;
+  
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  
+  test_array.resize( 500, 1337 ) ;
+  
+  buffer.initialize( device, 500                     ) ;
+  chain .initialize( device, nyx::ChainType::Compute ) ;
+  
+  nyx::Trace::clear() ;
+  nyx::Trace::setEnabled( true ) ;
+  chain.copy( test_array.data(), buffer ) ;
+  chain.submit() ;
+  nyx::Trace::setEnabled( false ) ;
+  
+  dumped = nyx::Trace::dump( "nyx_trace.json" ) ;
+  std::remove( "nyx_trace.json" ) ;
+  
+  if( nyx::Trace::size() == 0 || !dumped ) return false ;
+  
+  chain.synchronize() ;
+  buffer.reset() ;
+  chain .reset() ;
+  return true ;
+}
+
+/** Error handler to count the stalls reported to it.
+ */
+class StallCounter : public Impl::ErrorHandler
+{
+  public:
+    unsigned stalls = 0 ;
+    
+    void handleError( Impl::Error error ) override
+    {
+      if( error == Impl::Error::Stall ) this->stalls++ ;
+    }
+};
+
+athena::Result test_stall_stats()
+{
+  std::vector<unsigned> test_array ;
+  
+  Impl::Array<unsigned> buffer    ;
+  nyx::Chain<Impl>      chain     ;
+  StallCounter          counter   ;
+  const float           threshold = Impl::stallThreshold() ;
+  
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  
+  test_array.resize( 500, 1337 ) ;
+  
+  buffer.initialize( device, 500                     ) ;
+  chain .initialize( device, nyx::ChainType::Compute ) ;
+  
+  // Every blocking wait takes longer than a nanosecond, so each one is reported as a stall.
+  Impl::resetStallStats() ;
+  Impl::setErrorHandler  ( &counter  ) ;
+  Impl::setStallThreshold( 0.000001f ) ;
+  Impl::setStallTag      ( "test"    ) ;
+  chain.copy( test_array.data(), buffer ) ;
+  chain.submit() ;
+  chain.synchronize() ;
+  Impl::setStallTag      ( nullptr                                     ) ;
+  Impl::setStallThreshold( threshold                                   ) ;
+  Impl::setErrorHandler  ( static_cast<Impl::ErrorHandler*>( nullptr ) ) ;
+  
+  const auto stats = Impl::stallStats( "test:CommandBuffer::synchronize" ) ;
+  
+  if( stats.count == 0 || stats.stalls == 0 || stats.longest <= 0.0f || counter.stalls == 0 ) return false ;
+  if( Impl::numStallSites() == 0 || Impl::stallSite( Impl::numStallSites() ) != nullptr     ) return false ;
+  
+  Impl::resetStallStats() ;
+  if( Impl::numStallSites() != 0 ) return false ;
+  
+  buffer.reset() ;
+  chain .reset() ;
+  return true ;
+}
+
 athena::Result test_image_initialization()
 {
   Impl::Image image ;
@@ -421,12 +1132,288 @@ athena::Result test_renderer_draw()
     chain.draw( renderer, vertices ) ;
   }
   
+  // Every draw after the first uses the same renderer & vertices, so their binds are redundant.
+  const Impl::Chain& impl = chain ;
+  if( impl.bindStats().pipelines < 19 || impl.bindStats().vertex_buffers < 19 ) return false ;
+  
+  chain.submit     () ;
+  chain.synchronize() ;
+  renderer.reset() ;
+  return true ;
+}
+
+athena::Result test_renderer_dynamic_viewport()
+{
+  nyx::Renderer<Impl> renderer ;
+  Impl::Array<float>  vertices ;
+  Impl::Image         image    ;
+  nyx::Viewport       viewport ;
+  nyx::Viewport       half     ;
+  nyx::Chain<Impl>    chain    ;
+  
+  viewport.setWidth ( 1280 ) ;
+  viewport.setHeight( 1024 ) ;
+  half    .setXPos  ( 640  ) ;
+  half    .setWidth ( 640  ) ;
+  half    .setHeight( 1024 ) ;
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  chain.initialize( device, nyx::ChainType::Graphics               ) ;
+  image.initialize( nyx::ImageFormat::RGBA8, device, 1280, 1024, 1 ) ;
+  
+  chain.transition( image, nyx::ImageLayout::ShaderRead ) ;
+  chain.submit     () ;
+  chain.synchronize() ;
+  
+  chain.reset() ;
+  chain   .initialize( render_pass, WINDOW_ID                                            ) ;
+  vertices.initialize( device, 9, false, nyx::ArrayFlags::Vertex                         ) ;
+  renderer.initialize( device, render_pass, nyx::bytes::draw, sizeof( nyx::bytes::draw ) ) ;
+  renderer.addViewport( viewport ) ;
+  renderer.bind( "framebuffer", image ) ;
+  
+  // Every viewport change is dynamic state, so the one pipeline is only bound once.
+  chain.draw( renderer, vertices ) ;
+  chain.setViewport( half ) ;
+  chain.draw( renderer, vertices ) ;
+  chain.setScissor( 640, 0, 320, 512 ) ;
+  chain.draw( renderer, vertices ) ;
+  
+  const Impl::Chain& impl = chain ;
+  if( impl.bindStats().pipelines < 2 ) return false ;
+  
+  chain.submit     () ;
+  chain.synchronize() ;
+  renderer.reset() ;
+  return true ;
+}
+
+athena::Result test_renderer_rebind_frames()
+{
+  nyx::Renderer<Impl> renderer ;
+  Impl::Array<float>  vertices ;
+  Impl::Image         first    ;
+  Impl::Image         second   ;
+  nyx::Viewport       viewport ;
+  nyx::Chain<Impl>    chain_1  ;
+  nyx::Chain<Impl>    chain_2  ;
+  
+  viewport.setWidth ( 1280 ) ;
+  viewport.setHeight( 1024 ) ;
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  chain_1.initialize( device, nyx::ChainType::Graphics               ) ;
+  first  .initialize( nyx::ImageFormat::RGBA8, device, 1280, 1024, 1 ) ;
+  second .initialize( nyx::ImageFormat::RGBA8, device, 1280, 1024, 1 ) ;
+  
+  chain_1.transition( first , nyx::ImageLayout::ShaderRead ) ;
+  chain_1.transition( second, nyx::ImageLayout::ShaderRead ) ;
+  chain_1.submit     () ;
+  chain_1.synchronize() ;
+  
+  chain_1.reset() ;
+  chain_1 .initialize ( render_pass, WINDOW_ID                                            ) ;
+  chain_2 .initialize ( render_pass, nyx::ChainType::Graphics                             ) ;
+  vertices.initialize ( device, 9, false, nyx::ArrayFlags::Vertex                         ) ;
+  renderer.initialize ( device, render_pass, nyx::bytes::draw, sizeof( nyx::bytes::draw ) ) ;
+  renderer.addViewport( viewport                                                          ) ;
+  
+  // Rebind every frame, from two chains sharing the renderer, while the frames before it are still in flight.
+  // Each command buffer of each chain writes a descriptor set of it's own, so no set in use is ever updated.
+  for( unsigned frame = 0; frame < 3 * chain_1.framesInFlight(); frame++ )
+  {
+    renderer.bind( "framebuffer", frame % 2 == 0 ? first : second ) ;
+    chain_1.draw  ( renderer, vertices ) ;
+    chain_1.submit() ;
+    
+    renderer.bind( "framebuffer", frame % 2 == 0 ? second : first ) ;
+    chain_2.draw  ( renderer, vertices ) ;
+    chain_2.submit() ;
+  }
+  
+  chain_1.synchronize() ;
+  chain_2.synchronize() ;
+  
+  renderer.reset() ;
+  first   .reset() ;
+  second  .reset() ;
+  chain_2 .reset() ;
+  return true ;
+}
+
+athena::Result test_renderer_draw_indirect()
+{
+  nyx::Renderer<Impl>                       renderer  ;
+  Impl::Array<float>                        vertices  ;
+  Impl::Array<nyx::DrawIndirectArguments>   arguments ;
+  Impl::Image                               image     ;
+  nyx::Viewport                             viewport  ;
+  nyx::Chain<Impl>                          chain     ;
+  std::vector<nyx::DrawIndirectArguments>   draws     ;
+  
+  viewport.setWidth ( 1280 ) ;
+  viewport.setHeight( 1024 ) ;
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  
+  draws.resize( 64, { 3, 1, 0, 0 } ) ;
+  chain    .initialize ( device, nyx::ChainType::Graphics                                                      ) ;
+  image    .initialize ( nyx::ImageFormat::RGBA8, device, 1280, 1024, 1                                        ) ;
+  vertices .initialize ( device, 9, false, nyx::ArrayFlags::Vertex                                             ) ;
+  arguments.initialize ( device, draws.size(), false, nyx::ArrayFlags::Indirect | nyx::ArrayFlags::TransferDst ) ;
+  renderer .addViewport( viewport                                                                              ) ;
+  
+  chain.transition( image, nyx::ImageLayout::ShaderRead ) ;
+  chain.copy( draws.data(), arguments ) ;
+  chain.submit     () ;
+  chain.synchronize() ;
+
+  chain.reset() ;
+  chain.initialize( render_pass, WINDOW_ID ) ;
+  renderer.initialize( device, render_pass, nyx::bytes::draw, sizeof( nyx::bytes::draw ) ) ;
+  renderer.bind( "framebuffer", image ) ;
+  
+  // Every draw is issued by this one call.
+  chain.drawIndirect( renderer, vertices, arguments ) ;
+  
   chain.submit     () ;
   chain.synchronize() ;
   renderer.reset() ;
   return true ;
 }
 
+athena::Result test_renderer_pipeline_cache()
+{
+  nyx::Renderer<Impl> renderer ;
+  nyx::Viewport       viewport ;
+  bool                saved    ;
+  
+  viewport.setWidth ( 1280 ) ;
+  viewport.setHeight( 1024 ) ;
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  
+  // Saved into it's own directory, so the cache file can be removed without knowing it's name.
+  std::filesystem::create_directory( "nyx_pipeline_cache" ) ;
+  Impl::setPipelineCachePath( "nyx_pipeline_cache" ) ;
+  renderer.addViewport( viewport ) ;
+  renderer.initialize( device, render_pass, nyx::bytes::draw, sizeof( nyx::bytes::draw ) ) ;
+  
+  // Saving twice merges the second save with the file written by the first.
+  saved = Impl::savePipelineCache( device ) && Impl::savePipelineCache( device ) ;
+  
+  Impl::setPipelineCachePath( "" ) ;
+  std::filesystem::remove_all( "nyx_pipeline_cache" ) ;
+  
+  if( !saved || Impl::savePipelineCache( device ) ) return false ;
+  
+  renderer.reset() ;
+  return true ;
+}
+
+athena::Result test_renderer_async_compile()
+{
+  nyx::Renderer<Impl> renderer ;
+  nyx::Viewport       viewport ;
+  
+  viewport.setWidth ( 1280 ) ;
+  viewport.setHeight( 1024 ) ;
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  
+  renderer.setAsync   ( true     ) ;
+  renderer.addViewport( viewport ) ;
+  renderer.initialize( device, render_pass, nyx::bytes::draw, sizeof( nyx::bytes::draw ) ) ;
+  
+  if( !renderer.initialized() ) return false ;
+  while( !renderer.ready() ) std::this_thread::yield() ;
+  
+  renderer.reset() ;
+  return true ;
+}
+
+athena::Result test_pipeline_prewarm()
+{
+  std::ofstream shader   ;
+  std::ofstream manifest ;
+  
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  
+  shader  .open( "prewarm_draw.nyx", std::ios::binary ) ;
+  manifest.open( "prewarm.manifest"                   ) ;
+  
+  shader.write( reinterpret_cast<const char*>( nyx::bytes::draw ), sizeof( nyx::bytes::draw ) ) ;
+  shader.close() ;
+  
+  manifest << "# shader          type      width height\n"        ;
+  manifest << "prewarm_draw.nyx  graphics  1280  1024\n"          ;
+  manifest << "prewarm_draw.nyx  graphics  640   480    depth\n" ;
+  manifest << "prewarm_draw.nyx  graphics\n"                      ;
+  manifest.close() ;
+  
+  const Impl::RenderPass& pass = render_pass ;
+  
+  // Viewports are dynamic state, so the last entry compiles without dimensions.
+  const bool compiled = Impl::Pipeline::prewarm( "prewarm.manifest", device, &pass   ) == 3 &&
+                        Impl::Pipeline::prewarm( "prewarm.manifest", device, nullptr ) == 0 &&
+                        Impl::Pipeline::prewarm( "missing.manifest", device, &pass   ) == 0 ;
+  
+  std::remove( "prewarm_draw.nyx" ) ;
+  std::remove( "prewarm.manifest" ) ;
+  
+  return compiled ;
+}
+
+athena::Result test_descriptor_pool_growth()
+{
+  Impl::Shader                  shader      ;
+  Impl::DescriptorPool          pool        ;
+  Impl::Descriptor              copy        ;
+  std::vector<Impl::Descriptor> descriptors ;
+  
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  
+  shader.initialize( device, nyx::bytes::buffer_reference, sizeof( nyx::bytes::buffer_reference ) ) ;
+  pool  .initialize( shader, 1                                                                       ) ;
+  
+  // Pools of 1, 2 and 4 sets are chained to fit 4 descriptors.
+  for( unsigned index = 0; index < 4; index++ ) descriptors.push_back( pool.make() ) ;
+  for( const auto& descriptor : descriptors ) if( !descriptor.initialized() ) return false ;
+  if( pool.numPools() != 3 ) return false ;
+  
+  // A released set is handed back out before any pool is touched.
+  descriptors.back().reset() ;
+  descriptors.back() = pool.make() ;
+  if( !descriptors.back().initialized() || pool.numPools() != 3 ) return false ;
+  
+  // Resetting the pool frees every set, so the whole chain is reused without growing.
+  pool.reset() ;
+  descriptors.clear() ;
+  for( unsigned index = 0; index < 7; index++ ) descriptors.push_back( pool.make() ) ;
+  for( const auto& descriptor : descriptors ) if( !descriptor.initialized() ) return false ;
+  if( pool.numPools() != 3 ) return false ;
+  
+  // A copy resetting leaves the set to the descriptor still sharing it, so the chain is full & has to grow.
+  copy = descriptors.front() ;
+  copy.reset() ;
+  descriptors.push_back( pool.make() ) ;
+  if( !descriptors.front().initialized() || pool.numPools() != 4 ) return false ;
+  
+  return true ;
+}
+
+athena::Result test_push_constant_reflection()
+{
+  Impl::Shader reflected ;
+  Impl::Shader plain     ;
+  
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  
+  reflected.initialize( device, nyx::bytes::buffer_reference, sizeof( nyx::bytes::buffer_reference ) ) ;
+  plain    .initialize( device, nyx::bytes::draw            , sizeof( nyx::bytes::draw             ) ) ;
+  
+  // Only the buffer reference vertex stage declares a push constant block.
+  if( reflected.numPushConstantRanges() != 1 ) return false ;
+  if( plain    .numPushConstantRanges() != 0 ) return false ;
+  
+  return true ;
+}
+
 athena::Result test_buffer_reference_iterator()
 {
   struct vec4
@@ -507,6 +1494,62 @@ athena::Result test_rendering_with_subpasses()
   return true ;
 }
 
+athena::Result test_computer_dispatch()
+{
+  const unsigned count  = 1024 ;
+  const unsigned factor = 3    ;
+  
+  std::vector<unsigned> values    ;
+  std::vector<unsigned> result    ;
+  std::vector<unsigned> groups    ;
+  
+  nyx::Computer<Impl>   computer  ;
+  Impl::Array<unsigned> params    ;
+  Impl::Array<unsigned> data      ;
+  Impl::Array<unsigned> arguments ;
+  Impl::Readback        readback  ;
+  nyx::Chain<Impl>      chain     ;
+  
+  if( !Impl::initialized() ) return athena::Result::Skip ;
+  
+  values.resize( count    ) ;
+  result.resize( count, 0 ) ;
+  groups = { count / 64, 1, 1 } ;
+  for( unsigned index = 0; index < count; index++ ) values[ index ] = index ;
+  
+  params   .initialize( device, 1    , false, nyx::ArrayFlags::UniformBuffer        ) ;
+  data     .initialize( device, count, false, nyx::ArrayFlags::StorageBuffer        ) ;
+  arguments.initialize( device, 3    , false, nyx::ArrayFlags::Indirect             ) ;
+  chain    .initialize( device, nyx::ChainType::Compute                             ) ;
+  computer .initialize( device, nyx::bytes::compute, sizeof( nyx::bytes::compute ) ) ;
+  
+  computer.bind( "params", params ) ;
+  computer.bind( "values", data   ) ;
+  
+  // The kernel multiplies every value by the factor, once dispatched directly & once with the workgroup counts read from the GPU.
+  chain.copy( &factor      , params    ) ;
+  chain.copy( values.data(), data      ) ;
+  chain.copy( groups.data(), arguments ) ;
+  chain.dispatch        ( computer, count     ) ;
+  chain.dispatchIndirect( computer, arguments ) ;
+  readback = chain.readback( data, result.data() ) ;
+  
+  chain   .submit() ;
+  readback.wait  () ;
+  
+  for( unsigned index = 0; index < count; index++ )
+  {
+    if( result[ index ] != index * factor * factor ) return false ;
+  }
+  
+  computer .reset() ;
+  params   .reset() ;
+  data     .reset() ;
+  arguments.reset() ;
+  chain    .reset() ;
+  return true ;
+}
+
 int main()
 {
   manager.initialize( "Nyx VULKAN Library" ) ;
@@ -519,11 +1562,27 @@ int main()
   manager.add( "06) Memory::size"                  , &test_memory_size               ) ;
   manager.add( "07) Memory::offset"                , &test_memory_offset             ) ;
   manager.add( "08) Memory::device"                , &test_memory_device             ) ;
+  manager.add( "08) Memory::suballocation"         , &test_memory_suballocation      ) ;
   manager.add( "09) Memory::syncToHost"            , &test_memory_sync_to_host_copy  ) ;
+  manager.add( "09) Memory mapped non-coherent"    , &test_memory_mapped_noncoherent ) ;
   manager.add( "10) Array::initialize"             , &test_array_initialize          ) ;
   manager.add( "11) Array::initialize Preallocated", &test_array_prealloc_init       ) ;
   manager.add( "12) Array::size"                   , &test_array_size                ) ;
   manager.add( "13) Array::copy"                   , &test_array_host_copy           ) ;
+  manager.add( "13) Array::readback"               , &test_array_readback            ) ;
+  manager.add( "13) Array large copy"              , &test_array_large_copy          ) ;
+  manager.add( "13) Chain record once"             , &test_chain_record_once         ) ;
+  manager.add( "13) Chain parallel record"         , &test_chain_parallel_record     ) ;
+  manager.add( "13) Chain dependent copies"        , &test_chain_dependent_copies    ) ;
+  manager.add( "13) Chain transfer ownership"      , &test_chain_transfer_ownership  ) ;
+  manager.add( "13) Chain wait on"                 , &test_chain_wait_on             ) ;
+  manager.add( "13) Chain is complete"             , &test_chain_is_complete         ) ;
+  manager.add( "13) Chain frames in flight"        , &test_chain_frames_in_flight    ) ;
+  manager.add( "13) Chain batch submit"            , &test_chain_batch               ) ;
+  manager.add( "13) Queue threaded submit"         , &test_queue_threaded            ) ;
+  manager.add( "13) Chain timers"                  , &test_chain_timers              ) ;
+  manager.add( "13) Trace dump"                    , &test_trace_dump                ) ;
+  manager.add( "13) Stall stats"                   , &test_stall_stats               ) ;
   manager.add( "14) Image::initialize"             , &test_image_initialization      ) ;
   manager.add( "15) Image::size"                   , &test_image_size                ) ;
   manager.add( "17) Image::resize"                 , &test_image_resize              ) ;
@@ -531,8 +1590,20 @@ int main()
   manager.add( "19) RenderPass::initialize"            , &test_render_pass_creation      ) ;
   manager.add( "20) Renderer::initialize"              , &test_renderer_init             ) ;
   manager.add( "21) Renderer::draw"                    , &test_renderer_draw             ) ;
+  manager.add( "21) Renderer::draw indirect"           , &test_renderer_draw_indirect    ) ;
+  manager.add( "21) Renderer dynamic viewport"         , &test_renderer_dynamic_viewport ) ;
+  manager.add( "21) Renderer rebind every frame"       , &test_renderer_rebind_frames    ) ;
+  manager.add( "21) Renderer pipeline cache"           , &test_renderer_pipeline_cache   ) ;
+  manager.add( "21) Renderer async compile"            , &test_renderer_async_compile    ) ;
+  manager.add( "21) Pipeline prewarm"                  , &test_pipeline_prewarm          ) ;
   manager.add( "22) Renderer::draw with array iterator", &test_buffer_reference_iterator ) ;
+  manager.add( "22) Push constant reflection"          , &test_push_constant_reflection  ) ;
+  manager.add( "22) Descriptor pool growth"            , &test_descriptor_pool_growth    ) ;
   manager.add( "23) Renderer::draw with subpasses"     , &test_rendering_with_subpasses  ) ;
+  manager.add( "24) Computer::dispatch"                , &test_computer_dispatch         ) ;
+  
+  const int result = manager.test( athena::Output::Verbose ) ;
   
-  return manager.test( athena::Output::Verbose ) ;
+  Impl::reset() ;
+  return result ;
 }
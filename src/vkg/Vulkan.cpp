@@ -29,12 +29,18 @@
 #include <library/Renderer.h>
 #include <library/Memory.h>
 #include <library/RenderPass.h>
+#include <library/Trace.h>
 #include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <stdint.h>
 #include <vector>
 #include <string>
 #include <map>
+#include <mutex>
 #include <vulkan/vulkan.hpp>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_vulkan.h>
@@ -85,6 +91,26 @@ extern bool SDL2_INITIALIZED ;
      * @param error The error to handle.
      */
     static void defaultHandler( nyx::vkg::Vulkan::Error error ) ;
+    
+    /** Static function to retrieve the memory allocator of a device, initializing it if needed.
+     * @param gpu The id of the device to retrieve the allocator of.
+     * @param device The device associated with the id.
+     * @return Reference to the device's memory allocator.
+     */
+    static vkg::Allocator& allocator( unsigned gpu, const vkg::Device& device ) ;
+    
+    /** Static function to build the path of a device's pipeline cache file.
+     * @param props The properties of the device.
+     * @return The path of the device's pipeline cache file. Empty if no cache path is set.
+     */
+    static std::string cachePath( const vk::PhysicalDeviceProperties& props ) ;
+    
+    /** Static function to read a pipeline cache file, discarding it if it was not written by the input device.
+     * @param path The path of the cache file.
+     * @param props The properties of the device.
+     * @return The contents of the cache file. Empty if the file does not exist or was written by another device or driver.
+     */
+    static std::vector<char> readCache( const std::string& path, const vk::PhysicalDeviceProperties& props ) ;
 
     /** The structure to contain all of the global vkg library data.
      */
@@ -92,7 +118,10 @@ extern bool SDL2_INITIALIZED ;
     {
       typedef void ( *Callback )( Vulkan::Error ) ;
       
-      using WindowMap = std::map<unsigned, nyx::Window<Vulkan>*> ;
+      using WindowMap    = std::map<unsigned, nyx::Window<Vulkan>*> ;
+      using AllocatorMap = std::map<unsigned, vkg::Allocator>       ;
+      using StallMap     = std::map<std::string, vkg::StallStats>   ;
+      using CacheMap     = std::map<unsigned, vk::PipelineCache>    ;
       
       Callback                 error_cb          ;
       WindowMap                windows           ;
@@ -101,6 +130,14 @@ extern bool SDL2_INITIALIZED ;
       std::vector<vkg::Device> devices           ;
       std::vector<std::string> validation_layers ;
       std::vector<std::string> device_ext        ;
+      AllocatorMap             allocators        ;
+      std::mutex               allocator_mutex   ;
+      StallMap                 stalls            ;
+      std::mutex               stall_mutex       ;
+      float                    stall_threshold   ;
+      CacheMap                 caches            ;
+      std::string              cache_path        ;
+      std::mutex               cache_mutex       ;
       
       /** Default constructor.
        */
@@ -118,6 +155,10 @@ extern bool SDL2_INITIALIZED ;
      */
     static VulkanData data ;
     
+    /** The tag prefixing the blocking waits of each thread.
+     */
+    static thread_local const char* stall_tag = nullptr ;
+    
     const char* colorFromSeverity( Vulkan::Severity severity )
     {
       switch ( severity )
@@ -152,15 +193,89 @@ extern bool SDL2_INITIALIZED ;
       if( severity == Vulkan::Severity::Fatal ) exit( -1 ) ;
     }
 
+    vkg::Allocator& allocator( unsigned gpu, const vkg::Device& device )
+    {
+      std::lock_guard<std::mutex> lock( data.allocator_mutex ) ;
+      vkg::Allocator& alloc = data.allocators[ gpu ] ;
+      
+      if( !alloc.initialized() ) alloc.initialize( device ) ;
+      
+      return alloc ;
+    }
+
+    std::string cachePath( const vk::PhysicalDeviceProperties& props )
+    {
+      std::string path = data.cache_path ;
+      
+      if( path.empty() ) return path ;
+      if( path.back() != '/' && path.back() != '\\' ) path += '/' ;
+      
+      return path + "nyx_pipeline_" + std::to_string( props.vendorID ) + "_" + std::to_string( props.deviceID ) + ".cache" ;
+    }
+    
+    std::vector<char> readCache( const std::string& path, const vk::PhysicalDeviceProperties& props )
+    {
+      const size_t      header_size = 4 * sizeof( uint32_t ) + VK_UUID_SIZE ;
+      std::vector<char> bytes       ;
+      uint32_t          header[ 4 ] ;
+      
+      if( path.empty() ) return bytes ;
+      
+      std::ifstream stream( path, std::ios::binary | std::ios::ate ) ;
+      if( !stream ) return bytes ;
+      
+      bytes.resize( static_cast<size_t>( stream.tellg() ) ) ;
+      stream.seekg( 0 ) ;
+      stream.read( bytes.data(), bytes.size() ) ;
+      
+      // Header layout is VkPipelineCacheHeaderVersionOne: size, version, vendor id, device id, then the cache UUID.
+      if( !stream || bytes.size() < header_size ) return std::vector<char>() ;
+      std::memcpy( header, bytes.data(), sizeof( header ) ) ;
+      
+      if( header[ 0 ] < header_size || header[ 0 ] > bytes.size()               ) return std::vector<char>() ;
+      if( header[ 1 ] != VK_PIPELINE_CACHE_HEADER_VERSION_ONE                   ) return std::vector<char>() ;
+      if( header[ 2 ] != props.vendorID || header[ 3 ] != props.deviceID        ) return std::vector<char>() ;
+      if( std::memcmp( bytes.data() + sizeof( header ), props.pipelineCacheUUID.data(), VK_UUID_SIZE ) != 0 ) return std::vector<char>() ;
+      
+      return bytes ;
+    }
+
     VulkanData::VulkanData()
     {
-      this->error_cb = &vkg::defaultHandler ;
-      this->handler  = nullptr ;
+      this->error_cb        = &vkg::defaultHandler ;
+      this->handler         = nullptr ;
+      this->stall_threshold = 0.0f ;
+    }
+    
+    StallStats::StallStats()
+    {
+      this->count   = 0    ;
+      this->stalls  = 0    ;
+      this->total   = 0.0  ;
+      this->longest = 0.0f ;
+    }
+    
+    StallScope::StallScope( const char* site )
+    {
+      this->site  = site ;
+      this->start = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count() ;
+    }
+    
+    StallScope::~StallScope()
+    {
+      const unsigned long long end = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count() ;
+      
+      Vulkan::recordStall( this->site, static_cast<float>( end - this->start ) / 1000000.0f ) ;
     }
 
     Memory::Memory()
     {
-      this->val = 0x0 ;
+      this->val           = 0x0     ;
+      this->block         = nullptr ;
+      this->host_ptr      = nullptr ;
+      this->host_coherent = false   ;
+      this->mem_offset    = 0       ;
+      this->mem_size      = 0       ;
     }
 
     Memory::~Memory()
@@ -176,7 +291,12 @@ extern bool SDL2_INITIALIZED ;
     Memory& Memory::operator=( vk::DeviceMemory& val )
     {
       static_assert( sizeof( vk::DeviceMemory ) == sizeof( void* ), "Vulkan Device Memory cannot be wrapped up." ) ;
-      this->val = reinterpret_cast<void*>( static_cast<VkDeviceMemory>( val ) ) ;
+      this->val           = reinterpret_cast<void*>( static_cast<VkDeviceMemory>( val ) ) ;
+      this->block         = nullptr                                                   ;
+      this->host_ptr      = nullptr                                                   ;
+      this->host_coherent = false                                                     ;
+      this->mem_offset    = 0                                                         ;
+      this->mem_size      = 0                                                         ;
       
       return *this ;
     }
@@ -184,7 +304,12 @@ extern bool SDL2_INITIALIZED ;
     Memory& Memory::operator=( void* val )
     {
       static_assert( sizeof( vk::DeviceMemory ) == sizeof( void* ), "Vulkan Device Memory cannot be wrapped up." ) ;
-      this->val = val ;
+      this->val           = val     ;
+      this->block         = nullptr ;
+      this->host_ptr      = nullptr ;
+      this->host_coherent = false   ;
+      this->mem_offset    = 0       ;
+      this->mem_size      = 0       ;
       
       return *this ;
     }
@@ -203,6 +328,26 @@ extern bool SDL2_INITIALIZED ;
     {
       return static_cast<vk::DeviceMemory>( reinterpret_cast<VkDeviceMemory>( this->val ) ) ;
     }
+    
+    unsigned long long Memory::offset() const
+    {
+      return this->mem_offset ;
+    }
+
+    unsigned long long Memory::size() const
+    {
+      return this->mem_size ;
+    }
+    
+    void* Memory::mapped() const
+    {
+      return this->host_ptr ;
+    }
+
+    bool Memory::coherent() const
+    {
+      return this->host_coherent ;
+    }
 
     Surface::Surface()
     {
@@ -317,6 +462,9 @@ extern bool SDL2_INITIALIZED ;
         case Error::MemoryMapFailed      : return "Memory Map Failure: A Host-GPU memory mapping has failed."                              ;
         case Error::ValidationFailed     : return "Validation Layer Failed."                                                               ;
         case Error::NativeWindowInUse    : return "A Native window is already in use."                                                     ;
+        case Error::ExtensionNotPresent  : return "ExtensionNotPresent: A requested extension is not supported by this device."           ;
+        case Error::Stall                : return "Stall: A blocking wait took longer than the stall threshold."                           ;
+        case Error::InvalidPushConstant  : return "InvalidPushConstant: A push constant is not fully inside the pipeline's push constant ranges." ;
         default : return "Unknown Error" ;
       }
     }
@@ -328,6 +476,9 @@ extern bool SDL2_INITIALIZED ;
         case Error::DeviceNotFound       : return Severity::Warning ;
         case Error::FeatureNotPresent    : return Severity::Warning ;
         case Error::SuboptimalKHR        : return Severity::Warning ;
+        case Error::ExtensionNotPresent  : return Severity::Warning ;
+        case Error::Stall                : return Severity::Warning ;
+        case Error::InvalidPushConstant  : return Severity::Warning ;
         case Error::NativeWindowInUse    : return Severity::Fatal   ;
         case Error::ValidationFailed     : return Severity::Fatal   ;
         case Error::DeviceLost           : return Severity::Fatal   ;
@@ -385,6 +536,75 @@ extern bool SDL2_INITIALIZED ;
       data.error_cb = error_handler ;
     }
     
+    void Vulkan::setStallThreshold( float milliseconds )
+    {
+      std::lock_guard<std::mutex> lock( data.stall_mutex ) ;
+      data.stall_threshold = milliseconds > 0.0f ? milliseconds : 0.0f ;
+    }
+    
+    float Vulkan::stallThreshold()
+    {
+      std::lock_guard<std::mutex> lock( data.stall_mutex ) ;
+      return data.stall_threshold ;
+    }
+    
+    void Vulkan::setStallTag( const char* tag )
+    {
+      vkg::stall_tag = tag ;
+    }
+    
+    vkg::StallStats Vulkan::stallStats( const char* site )
+    {
+      std::lock_guard<std::mutex> lock( data.stall_mutex ) ;
+      auto iter = data.stalls.find( site ) ;
+      
+      return iter != data.stalls.end() ? iter->second : vkg::StallStats() ;
+    }
+    
+    unsigned Vulkan::numStallSites()
+    {
+      std::lock_guard<std::mutex> lock( data.stall_mutex ) ;
+      return static_cast<unsigned>( data.stalls.size() ) ;
+    }
+    
+    const char* Vulkan::stallSite( unsigned index )
+    {
+      std::lock_guard<std::mutex> lock( data.stall_mutex ) ;
+      if( index >= data.stalls.size() ) return nullptr ;
+      
+      auto iter = data.stalls.begin() ;
+      std::advance( iter, index ) ;
+      return iter->first.c_str() ;
+    }
+    
+    void Vulkan::resetStallStats()
+    {
+      std::lock_guard<std::mutex> lock( data.stall_mutex ) ;
+      data.stalls.clear() ;
+    }
+    
+    void Vulkan::recordStall( const char* site, float milliseconds )
+    {
+      bool stalled = false ;
+      
+      if( site == nullptr ) return ;
+      {
+        std::lock_guard<std::mutex> lock( data.stall_mutex ) ;
+        std::string key = vkg::stall_tag ? std::string( vkg::stall_tag ) + ":" + site : std::string( site ) ;
+        auto& stats     = data.stalls[ key ] ;
+        
+        stalled = data.stall_threshold > 0.0f && milliseconds > data.stall_threshold ;
+        
+        stats.count++ ;
+        stats.total  += milliseconds ;
+        stats.longest = std::max( stats.longest, milliseconds ) ;
+        if( stalled ) stats.stalls++ ;
+      }
+      
+      // Reported outside of the lock so handlers are free to query the statistics.
+      if( stalled ) Vulkan::add( Vulkan::Error::Stall ) ;
+    }
+    
     const vkg::Device& Vulkan::device( unsigned id )
     {
       static vkg::Device dummy ;
@@ -633,6 +853,8 @@ extern bool SDL2_INITIALIZED ;
     {
       if( !Vulkan::initialized() )
       {
+        nyx::TraceScope trace( "Vulkan::initialize" ) ;
+        
         for( const auto& str : data.validation_layers )
         {
           data.instance.addValidationLayer( str.c_str() ) ;
@@ -660,25 +882,50 @@ extern bool SDL2_INITIALIZED ;
       data.device_ext       .clear() ;
       data.validation_layers.clear() ;
     }
+    
+    void Vulkan::reset()
+    {
+      // Compilations use the pipeline caches, so they are finished first.
+      vkg::Pipeline::shutdown() ;
+      
+      for( auto& device : data.devices )
+      {
+        if( device.initialized() ) device.wait() ;
+      }
+      
+      {
+        std::lock_guard<std::mutex> lock( data.cache_mutex ) ;
+        
+        for( auto& cache : data.caches )
+        {
+          const vkg::Device& device = Vulkan::device( cache.first ) ;
+          
+          if( device.initialized() ) device.device().destroy( cache.second ) ;
+        }
+        
+        data.caches.clear() ;
+      }
+      
+      std::lock_guard<std::mutex> lock( data.allocator_mutex ) ;
+      
+      for( auto& allocator : data.allocators ) allocator.second.reset() ;
+      data.allocators.clear() ;
+    }
       
     void Vulkan::copyToDevice( const void* src, Vulkan::Memory& dst, unsigned gpu, unsigned amt, unsigned src_offset, unsigned dst_offset )
     {
       Vulkan::initialize() ;
-      const auto device = Vulkan::device( gpu ).device() ;
 
-      ::vk::DeviceSize     offset ;
-      ::vk::DeviceSize     amount ;
-      ::vk::MemoryMapFlags flag   ;
-      void*                mem    ;
+      src = static_cast<const void*>( reinterpret_cast<const unsigned char*>( src ) + src_offset ) ;
       
-      offset = dst_offset ;
-      amount = amt        ;
-
-      src    = static_cast<const void*>( reinterpret_cast<const unsigned char*>( src ) + src_offset ) ;
+      // Coherent memory is persistently mapped, so the upload is just a copy.
+      if( dst.mapped() && dst.coherent() )
+      {
+        std::memcpy( static_cast<unsigned char*>( dst.mapped() ) + dst_offset, src, static_cast<size_t>( amt ) ) ;
+        return ;
+      }
 
-      Vulkan::add( device.mapMemory  ( dst, offset, amount, flag, &mem    ) ) ;
-                   std::memcpy       ( mem, src, static_cast<size_t>( amt ) ) ;
-                   device.unmapMemory( dst                                  ) ;
+      vkg::allocator( gpu, Vulkan::device( gpu ) ).write( dst, src, dst_offset, amt ) ;
     }
     
     bool Vulkan::hasDevice( unsigned id )
@@ -699,6 +946,110 @@ extern bool SDL2_INITIALIZED ;
       return Vulkan::device( gpu ).computeQueue() ;
     }
     
+    vkg::Queue Vulkan::transferQueue( unsigned gpu )
+    {
+      Vulkan::initialize() ;
+      return Vulkan::device( gpu ).transferQueue() ;
+    }
+
+    vkg::MemoryStats Vulkan::memoryStats( unsigned gpu )
+    {
+      Vulkan::initialize() ;
+      return vkg::allocator( gpu, Vulkan::device( gpu ) ).stats() ;
+    }
+    
+    void Vulkan::setMemoryBlockSize( unsigned long long size, unsigned gpu )
+    {
+      Vulkan::initialize() ;
+      vkg::allocator( gpu, Vulkan::device( gpu ) ).setBlockSize( size ) ;
+    }
+
+    void Vulkan::setPipelineCachePath( const char* path )
+    {
+      std::lock_guard<std::mutex> lock( data.cache_mutex ) ;
+      data.cache_path = path ? path : "" ;
+    }
+    
+    const vk::PipelineCache& Vulkan::pipelineCache( unsigned gpu )
+    {
+      vk::PipelineCacheCreateInfo info  ;
+      std::vector<char>           bytes ;
+      
+      std::lock_guard<std::mutex> lock( data.cache_mutex ) ;
+      auto iter = data.caches.find( gpu ) ;
+      if( iter != data.caches.end() ) return iter->second ;
+      
+      const vkg::Device& device = Vulkan::device( gpu ) ;
+      const auto         props  = device.physicalDevice().getProperties() ;
+      
+      bytes = vkg::readCache( vkg::cachePath( props ), props ) ;
+      info.setInitialDataSize( bytes.size() ) ;
+      info.setPInitialData   ( bytes.data() ) ;
+      
+      auto result = device.device().createPipelineCache( info ) ;
+      vkg::Vulkan::add( result.result ) ;
+      
+      return data.caches[ gpu ] = result.value ;
+    }
+    
+    bool Vulkan::savePipelineCache( unsigned gpu )
+    {
+      vk::PipelineCacheCreateInfo info  ;
+      std::vector<char>           bytes ;
+      std::string                 path  ;
+      std::string                 tmp   ;
+      
+      std::lock_guard<std::mutex> lock( data.cache_mutex ) ;
+      auto iter = data.caches.find( gpu ) ;
+      if( iter == data.caches.end() || data.cache_path.empty() ) return false ;
+      
+      const vkg::Device& device = Vulkan::device( gpu ) ;
+      const auto         props  = device.physicalDevice().getProperties() ;
+      
+      path  = vkg::cachePath( props ) ;
+      bytes = vkg::readCache( path, props ) ;
+      info.setInitialDataSize( bytes.size() ) ;
+      info.setPInitialData   ( bytes.data() ) ;
+      
+      // Merge into a scratch cache seeded from disk. This keeps what other processes saved, and leaves the shared cache free for pipelines being created on other threads.
+      auto merged = device.device().createPipelineCache( info ) ;
+      vkg::Vulkan::add( merged.result ) ;
+      if( merged.result != vk::Result::eSuccess ) return false ;
+      
+      vkg::Vulkan::add( device.device().mergePipelineCaches( merged.value, 1, &iter->second ) ) ;
+      auto output = device.device().getPipelineCacheData( merged.value ) ;
+      vkg::Vulkan::add( output.result ) ;
+      device.device().destroy( merged.value ) ;
+      if( output.result != vk::Result::eSuccess ) return false ;
+      
+      // Written to a uniquely named file then renamed over the cache, so no reader ever sees a partially written cache.
+      const auto unique = std::chrono::steady_clock::now().time_since_epoch().count() ^ reinterpret_cast<uintptr_t>( &data ) ;
+      tmp = path + "." + std::to_string( unique ) + ".tmp" ;
+      {
+        std::ofstream stream( tmp, std::ios::binary ) ;
+        stream.write( reinterpret_cast<const char*>( output.value.data() ), output.value.size() ) ;
+        if( !stream )
+        {
+          stream.close() ;
+          std::remove( tmp.c_str() ) ;
+          return false ;
+        }
+      }
+      
+      if( std::rename( tmp.c_str(), path.c_str() ) != 0 )
+      {
+        // Some platforms refuse to rename over an existing file.
+        std::remove( path.c_str() ) ;
+        if( std::rename( tmp.c_str(), path.c_str() ) != 0 )
+        {
+          std::remove( tmp.c_str() ) ;
+          return false ;
+        }
+      }
+      
+      return true ;
+    }
+    
     vkg::Queue Vulkan::presentQueue( unsigned window_id, unsigned gpu )
     {
       static vkg::Queue dummy ;
@@ -717,20 +1068,16 @@ extern bool SDL2_INITIALIZED ;
     void Vulkan::copyToHost( const Vulkan::Memory& src, Vulkan::Data dst, unsigned gpu, unsigned amt, unsigned src_offset, unsigned dst_offset )
     {
       Vulkan::initialize() ;
-      const auto device = Vulkan::device( gpu ).device() ;
-      ::vk::DeviceSize     offset ;
-      ::vk::DeviceSize     amount ;
-      ::vk::MemoryMapFlags flag   ;
-      void*                mem    ;
-      
-      offset = src_offset ;
-      amount = amt        ;
 
-      dst    = static_cast<void*>( reinterpret_cast<unsigned char*>( dst ) + dst_offset ) ;
+      dst = static_cast<void*>( reinterpret_cast<unsigned char*>( dst ) + dst_offset ) ;
       
-      Vulkan::add( device.mapMemory  ( src, offset, amount, flag, &mem      ) ) ;
-                   std::memcpy       ( dst, mem, static_cast<size_t>( amt )   ) ;
-                   device.unmapMemory( src                                    ) ;
+      if( src.mapped() && src.coherent() )
+      {
+        std::memcpy( dst, static_cast<const unsigned char*>( src.mapped() ) + src_offset, static_cast<size_t>( amt ) ) ;
+        return ;
+      }
+
+      vkg::allocator( gpu, Vulkan::device( gpu ) ).read( src, dst, src_offset, amt ) ;
     }
     
     void Vulkan::free( Vulkan::Memory& mem, unsigned gpu )
@@ -741,40 +1088,26 @@ extern bool SDL2_INITIALIZED ;
         const auto device = Vulkan::device( gpu ).device() ;
         if( device )
         {
-          device.free ( mem ) ;
+          vkg::allocator( gpu, Vulkan::device( gpu ) ).free( mem ) ;
         }
       }
     }
     
-    Vulkan::Memory Vulkan::createMemory( unsigned gpu, unsigned size, nyx::MemoryFlags flags, unsigned filter )
+    Vulkan::Memory Vulkan::createMemory( unsigned gpu, unsigned size, nyx::MemoryFlags flags, unsigned filter, unsigned alignment )
     {
-      const auto                      device   = Vulkan::device( gpu ).device()                                                              ;
       const auto                      p_device = Vulkan::device( gpu ).physicalDevice()                                                      ;
       const ::vk::MemoryPropertyFlags flag     = static_cast<vk::MemoryPropertyFlags>( static_cast<VkMemoryPropertyFlags>( flags.value() ) ) ;
-      Vulkan::Memory              mem       ;
-      vk::MemoryAllocateInfo      info      ;
-      vk::MemoryAllocateFlagsInfo flag_info ;
 
       Vulkan::initialize() ;
       
-      flag_info.setFlags( vk::MemoryAllocateFlagBits::eDeviceAddress ) ;
-      
-      info.setAllocationSize ( size                              ) ;
-      info.setMemoryTypeIndex( memType( filter, flag, p_device ) ) ;
-      info.setPNext( &flag_info ) ;
-      
-      auto result = device.allocateMemory( info, nullptr ) ;
-      
-      Vulkan::add( result.result ) ;
-
-      return result.value ;
+      return vkg::allocator( gpu, Vulkan::device( gpu ) ).allocate( size, memType( filter, flag, p_device ), alignment ) ;
     }
     
-    Vulkan::Memory Vulkan::createMemory( unsigned gpu, unsigned size, unsigned filter )
+    Vulkan::Memory Vulkan::createMemory( unsigned gpu, unsigned size, unsigned filter, unsigned alignment )
     {
       nyx::MemoryFlags flags ;
       
-      return this->createMemory( gpu, size, flags, filter ) ;
+      return this->createMemory( gpu, size, flags, filter, alignment ) ;
     }
     
     void Vulkan::handleWindowEvents( unsigned id )
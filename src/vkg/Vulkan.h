@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "Allocator.h"
 #include "Device.h"
 #include "Instance.h"
 #include "Buffer.h"
@@ -30,7 +31,9 @@
 #include "Swapchain.h"
 #include "Descriptor.h"
 #include "Renderer.h"
+#include "Computer.h"
 #include "Chain.h"
+#include "Batch.h"
 
 typedef unsigned VkFlags              ;
 typedef VkFlags  VkImageUsageFlags    ;
@@ -48,6 +51,7 @@ namespace vk
        class DeviceMemory                                  ;
        class Instance                                      ;
        class AttachmentDescription                         ;
+       class PipelineCache                                 ;
   enum class ImageLayout                                   ;
   enum class MemoryPropertyFlagBits : VkFlags              ;
   enum class ImageUsageFlagBits     : VkImageUsageFlags    ;
@@ -171,13 +175,52 @@ namespace nyx
          */
         operator vk::DeviceMemory() const ;
         
-      private:
+        /** Method to retrieve the offset of this object's allocation into its vulkan device memory handle.
+         * @return The offset in bytes of this object's allocation into its device memory handle.
+         */
+        unsigned long long offset() const ;
+        
+        /** Method to retrieve the size of this object's allocation.
+         * @return The size in bytes of this object's allocation.
+         */
+        unsigned long long size() const ;
         
-        /** The underlying handle for this object's data.
+        /** Method to retrieve the persistent host mapping of this object's allocation.
+         * @note Writes through this pointer to non-coherent memory must be flushed to be visible to the device.
+         * @return The host pointer to the start of this object's allocation, or nullptr if it is not host visible.
          */
-        void* val ;
+        void* mapped() const ;
+        
+        /** Method to retrieve whether this object's allocation is host coherent.
+         * @return Whether or not host writes to this object are visible to the device without a flush.
+         */
+        bool coherent() const ;
+
+      private:
+        friend class vkg::Allocator ;
+        
+        void*              val           ; ///< The underlying handle for this object's data.
+        void*              block         ; ///< The heap block this object was carved out of. Null if allocated directly.
+        void*              host_ptr      ; ///< The persistent host mapping of this object's allocation, if host visible.
+        bool               host_coherent ; ///< Whether or not this object's allocation is host coherent.
+        unsigned long long mem_offset    ; ///< The offset of this object's allocation into the device memory handle.
+        unsigned long long mem_size      ; ///< The size of this object's allocation.
     };
     
+    /** Structure describing the aggregated blocking waits of a single call site.
+     */
+    struct StallStats
+    {
+      unsigned long long count   ; ///< The amount of waits recorded at this site.
+      unsigned long long stalls  ; ///< The amount of waits that took longer than the stall threshold.
+      double             total   ; ///< The total time, in milliseconds, spent waiting at this site.
+      float              longest ; ///< The longest single wait, in milliseconds, at this site.
+
+      /** Default constructor.
+       */
+      StallStats() ;
+    };
+
     class Surface
     {
       public:
@@ -211,12 +254,15 @@ namespace nyx
         using Memory          = nyx::vkg::Memory             ; ///< The Framework-specific handle for Device Memory.
         using Pipeline        = nyx::vkg::Pipeline           ; ///< The object to manage pipeline creation & handling.
         using Queue           = nyx::vkg::Queue              ; ///< The object to manage vulkan queues.
+        using Readback        = nyx::vkg::Readback           ; ///< The object to track asynchronous copies of GPU data to the host.
         using Shader          = nyx::vkg::NyxShader          ; ///< The object to manage an individual vulkan shader.
         using Swapchain       = nyx::vkg::Swapchain          ; ///< The object to manage a window's framebuffers.
         using Synchronization = nyx::vkg::Synchronization    ; ///< The object used to manage synchronization in this library.
         using Renderer        = nyx::vkg::Renderer           ;
         using Image           = nyx::Image<nyx::vkg::Vulkan> ;
         using Chain           = nyx::vkg::Chain              ;
+        using Computer        = nyx::vkg::Computer           ;
+        using Batch           = nyx::vkg::Batch              ;
 
         template<typename Type>
         using Array  = nyx::Array <nyx::vkg::Vulkan, Type> ;
@@ -308,6 +354,8 @@ namespace nyx
               MemoryMapFailed,       ///< TODO
               ValidationFailed,      ///< TODO
               InvalidDevice,         ///< TODO
+              Stall,                 ///< A blocking wait took longer than the configured stall threshold.
+              InvalidPushConstant,   ///< A push constant was misaligned or not fully inside the bound pipeline's push constant ranges.
             };
 
             /** Default constructor.
@@ -421,12 +469,53 @@ namespace nyx
          * @return A Queue capable of doing graphics.
          */
         static vkg::Queue computeQueue( unsigned gpu = 0 ) ;
+        
+        /** Static method to retrieve a transfer queue from this library.
+         * @note Prefers a queue family dedicated to transfers, falling back to a compute queue.
+         * @param gpu The gpu to generate the queue on.
+         * @return A Queue capable of doing transfers.
+         */
+        static vkg::Queue transferQueue( unsigned gpu = 0 ) ;
 
         /** Static method to retrieve a graphics queue from this library.
          * @param gpu The gpu to generate the queue on.
          * @return A Queue capable of doing graphics.
          */
         static vkg::Queue presentQueue( unsigned window_id, unsigned gpu = 0 ) ;
+        
+        /** Static method to retrieve the statistics of a device's memory heap.
+         * @param gpu The device to retrieve the memory statistics of.
+         * @return The statistics of the device's memory heap.
+         */
+        static vkg::MemoryStats memoryStats( unsigned gpu = 0 ) ;
+        
+        /** Static method to set the size of the blocks device memory is sub-allocated from.
+         * @note Only affects blocks allocated after this call.
+         * @param size The size in bytes of each block.
+         * @param gpu The device to set the block size of.
+         */
+        static void setMemoryBlockSize( unsigned long long size, unsigned gpu = 0 ) ;
+        
+        /** Static method to set the directory pipeline caches are loaded from and saved to.
+         * Each device is cached in its own file, named after its vendor and device id.
+         * @note Only affects caches created after this call. An empty path keeps caches in memory only.
+         * @param path The directory to store pipeline caches in.
+         */
+        static void setPipelineCachePath( const char* path ) ;
+        
+        /** Static method to retrieve the pipeline cache shared by every pipeline of a device.
+         * The cache is created on first use, seeded from disk if a valid cache file for this device exists.
+         * @param gpu The device to retrieve the pipeline cache of.
+         * @return The pipeline cache of the device.
+         */
+        static const vk::PipelineCache& pipelineCache( unsigned gpu = 0 ) ;
+        
+        /** Static method to write a device's pipeline cache to disk.
+         * The cache is merged with the file currently on disk first, so caches saved by other threads or processes are kept.
+         * @param gpu The device to save the pipeline cache of.
+         * @return Whether or not the cache was written.
+         */
+        static bool savePipelineCache( unsigned gpu = 0 ) ;
 
         /** Static method to allow a custom error handler to be set for this library.
          * @param error_handler The error handler to be used by this library.
@@ -437,6 +526,50 @@ namespace nyx
          * @param handler The error handler to be used by this library.
          */
         static void setErrorHandler( Vulkan::ErrorHandler* handler ) ;
+        
+        /** Static method to set how long a blocking wait can take before it is reported as a stall.
+         * Stalls are reported through the error handler as Error::Stall.
+         * @param milliseconds The threshold in milliseconds. A value of 0 disables reporting.
+         */
+        static void setStallThreshold( float milliseconds ) ;
+        
+        /** Static method to retrieve how long a blocking wait can take before it is reported as a stall.
+         * @return The stall threshold in milliseconds. 0 if reporting is disabled.
+         */
+        static float stallThreshold() ;
+        
+        /** Static method to tag the blocking waits made from the calling thread.
+         * Tagged waits are recorded under "tag:site" instead of "site".
+         * @param tag The tag to prefix waits with. Must outlive the waits it tags. Null clears the tag.
+         */
+        static void setStallTag( const char* tag ) ;
+        
+        /** Static method to retrieve the wait statistics of a call site.
+         * @param site The site to retrieve the statistics of.
+         * @return The statistics of the site. Empty if no waits were recorded there.
+         */
+        static vkg::StallStats stallStats( const char* site ) ;
+        
+        /** Static method to retrieve the amount of call sites that have recorded waits.
+         * @return The amount of call sites that have recorded waits.
+         */
+        static unsigned numStallSites() ;
+        
+        /** Static method to retrieve the name of a call site that has recorded waits.
+         * @param index The index of the site, in [0, numStallSites()).
+         * @return The name of the site, valid until resetStallStats(). Null if the index is out of range.
+         */
+        static const char* stallSite( unsigned index ) ;
+        
+        /** Static method to clear all recorded wait statistics.
+         */
+        static void resetStallStats() ;
+        
+        /** Static method to record a blocking wait.
+         * @param site The call site the wait was made from.
+         * @param milliseconds The time spent waiting in milliseconds.
+         */
+        static void recordStall( const char* site, float milliseconds ) ;
 
         /** Static method to check if this library is initialized of not.
          * @return Whether or not this library is initialized.
@@ -447,6 +580,11 @@ namespace nyx
          */
         static void initialize() ;
         
+        /** Static method to finish pending pipeline compilations & release the objects this library keeps for each device, like pipeline caches & device memory.
+         * @note Waits for every device to idle. Must be called before the devices are destroyed, and every memory allocated before it is invalid afterwards.
+         */
+        static void reset() ;
+        
         /** Method to retrieve the platform-specific instance extension names for the surface of this system.
          * @return String names of the platform-specific extensions needed by this system for a vulkan surface.
          */
@@ -663,23 +801,49 @@ namespace nyx
         /** Method to create & allocate memory on the GPU.
          * @param size The size of the memory to allocate.
          * @param gpu The GPU to allocate data on.
+         * @param alignment The alignment in bytes the memory must start at.
          * @return Allocated memory on the GPU.
          */
-        Memory createMemory( unsigned gpu, unsigned size, unsigned filter = 0xFFFFFFF ) ;
+        Memory createMemory( unsigned gpu, unsigned size, unsigned filter = 0xFFFFFFF, unsigned alignment = 1 ) ;
         
         /** Method to create & allocate memory on the GPU.
          * @param size The size of the memory to allocate.
          * @param gpu The GPU to allocate data on.
          * @param mem_flags The memory property flags to use for creation of this memory object.
+         * @param alignment The alignment in bytes the memory must start at.
          * @return Allocated memory on the GPU.
          */
-        Memory createMemory( unsigned gpu, unsigned size, nyx::MemoryFlags mem_flags, unsigned filter = 0xFFFFFFF ) ;
+        Memory createMemory( unsigned gpu, unsigned size, nyx::MemoryFlags mem_flags, unsigned filter = 0xFFFFFFF, unsigned alignment = 1 ) ;
         
         /** Static method to retrieve the instance of this library.
          * @return The instance associated with this library.
          */
         static const vkg::Instance& instance() ; 
     };
+    
+    /** Scoped timer for a blocking wait.
+     * Records the time between construction and destruction against its call site.
+     */
+    class StallScope
+    {
+      public:
+        
+        /** Constructor. Starts timing the wait.
+         * @param site The call site of the wait. Must be a string literal or otherwise outlive this object.
+         */
+        explicit StallScope( const char* site ) ;
+        
+        /** Deconstructor. Records the wait.
+         */
+        ~StallScope() ;
+        
+      private:
+        StallScope( const StallScope& ) = delete ;
+        StallScope& operator=( const StallScope& ) = delete ;
+        
+        const char*        site  ; ///< The call site of the wait.
+        unsigned long long start ; ///< The time the wait started, in nanoseconds.
+    };
   }
 }
 